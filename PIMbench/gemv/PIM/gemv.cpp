@@ -19,6 +19,7 @@ typedef struct Params
   uint64_t row, column;
   char *configFile;
   bool shouldVerify;
+  bool useZeroCopy;
 } Params;
 
 void usage()
@@ -30,6 +31,7 @@ void usage()
           "\n    -d    matrix column (default=64 elements)"
           "\n    -c    dramsim config file"
           "\n    -v    t = verifies PIM output with host output. (default=false)"
+          "\n    -z    register matrix columns as zero-copy host buffers instead of copying them (default=false)"
           "\n");
 }
 
@@ -40,9 +42,10 @@ struct Params getInputParams(int argc, char **argv)
   p.column = 64;
   p.configFile = nullptr;
   p.shouldVerify = false;
+  p.useZeroCopy = false;
 
   int opt;
-  while ((opt = getopt(argc, argv, "h:r:d:c:i:v:")) >= 0)
+  while ((opt = getopt(argc, argv, "h:r:d:c:i:v:z")) >= 0)
   {
     switch (opt)
     {
@@ -62,6 +65,9 @@ struct Params getInputParams(int argc, char **argv)
     case 'v':
       p.shouldVerify = (*optarg == 't') ? true : false;
       break;
+    case 'z':
+      p.useZeroCopy = true;
+      break;
     default:
       fprintf(stderr, "\nUnrecognized option!\n");
       usage();
@@ -71,7 +77,7 @@ struct Params getInputParams(int argc, char **argv)
   return p;
 }
 
-void gemv(uint64_t row, uint64_t col, std::vector<int> &srcVector, std::vector<std::vector<int>> &srcMatrix, std::vector<int> &dst)
+void gemv(uint64_t row, uint64_t col, std::vector<int> &srcVector, std::vector<std::vector<int>> &srcMatrix, std::vector<int> &dst, bool useZeroCopy)
 {
   PimObjId srcObj1 = pimAlloc(PIM_ALLOC_AUTO, row, PIM_INT32);
   if (srcObj1 == -1)
@@ -96,7 +102,15 @@ void gemv(uint64_t row, uint64_t col, std::vector<int> &srcVector, std::vector<s
 
   for (uint64_t i = 0; i < col; ++i)
   {
-    status = pimCopyHostToDevice((void *)srcMatrix[i].data(), srcObj1);
+    if (useZeroCopy)
+    {
+      // zero-copy: use the matrix column as backing store of srcObj1
+      status = pimRegisterHostBuffer(srcObj1, (void *)srcMatrix[i].data());
+    }
+    else
+    {
+      status = pimCopyHostToDevice((void *)srcMatrix[i].data(), srcObj1);
+    }
     if (status != PIM_OK)
     {
       std::cout << "Abort" << std::endl;
@@ -146,7 +160,7 @@ int main(int argc, char *argv[])
     std::cout << "Abort" << std::endl;
     return 1;
   }
-  gemv(params.row, params.column, srcVector, srcMatrix, resultVector);
+  gemv(params.row, params.column, srcVector, srcMatrix, resultVector, params.useZeroCopy);
 
   if (params.shouldVerify)
   {
@@ -93,6 +93,29 @@ pimFree(PimObjId obj)
   return ok ? PIM_OK : PIM_ERROR;
 }
 
+//! @brief  Allocate a PIM resource that uses a host buffer as zero-copy backing store
+PimObjId
+pimAllocFromHostBuffer(PimAllocEnum allocType, uint64_t numElements, PimDataType dataType, void* hostBuffer)
+{
+  return pimSim::get()->pimAllocFromHostBuffer(allocType, numElements, dataType, hostBuffer);
+}
+
+//! @brief  Register a host buffer as zero-copy backing store of a PIM resource
+PimStatus
+pimRegisterHostBuffer(PimObjId obj, void* hostBuffer)
+{
+  bool ok = pimSim::get()->pimRegisterHostBuffer(obj, hostBuffer);
+  return ok ? PIM_OK : PIM_ERROR;
+}
+
+//! @brief  Notify that the host wrote the registered host buffer of a PIM resource
+PimStatus
+pimMarkHostBufferModified(PimObjId obj)
+{
+  bool ok = pimSim::get()->pimMarkHostBufferModified(obj);
+  return ok ? PIM_OK : PIM_ERROR;
+}
+
 //! @brief  Create an obj referencing to a range of an existing obj
 PimObjId
 pimCreateRangedRef(PimObjId refId, uint64_t idxBegin, uint64_t idxEnd)
@@ -123,6 +146,38 @@ pimCopyDeviceToHost(PimObjId src, void* dest, uint64_t idxBegin, uint64_t idxEnd
   return ok ? PIM_OK : PIM_ERROR;
 }
 
+//! @brief  Copy data from a strided layout in main memory to PIM device for a range of elements within the PIM object
+PimStatus
+pimCopyHostToDevice2D(void* src, PimObjId dest, uint64_t numElementsPerRow, uint64_t rowPitch, uint64_t elemStride, uint64_t idxBegin, uint64_t idxEnd)
+{
+  bool ok = pimSim::get()->pimCopyMainToDevice2D(src, dest, numElementsPerRow, rowPitch, elemStride, idxBegin, idxEnd);
+  return ok ? PIM_OK : PIM_ERROR;
+}
+
+//! @brief  Copy data from PIM device to a strided layout in main memory for a range of elements within the PIM object
+PimStatus
+pimCopyDeviceToHost2D(PimObjId src, void* dest, uint64_t numElementsPerRow, uint64_t rowPitch, uint64_t elemStride, uint64_t idxBegin, uint64_t idxEnd)
+{
+  bool ok = pimSim::get()->pimCopyDeviceToMain2D(src, dest, numElementsPerRow, rowPitch, elemStride, idxBegin, idxEnd);
+  return ok ? PIM_OK : PIM_ERROR;
+}
+
+//! @brief  Copy data from main memory to PIM device for a batch of ranges as one command
+PimStatus
+pimCopyHostToDeviceBatch(const PimCopyDesc* descs, uint64_t numDescs)
+{
+  bool ok = pimSim::get()->pimCopyMainToDeviceBatch(descs, numDescs);
+  return ok ? PIM_OK : PIM_ERROR;
+}
+
+//! @brief  Copy data from PIM device to main memory for a batch of ranges as one command
+PimStatus
+pimCopyDeviceToHostBatch(const PimCopyDesc* descs, uint64_t numDescs)
+{
+  bool ok = pimSim::get()->pimCopyDeviceToMainBatch(descs, numDescs);
+  return ok ? PIM_OK : PIM_ERROR;
+}
+
 //! @brief  Copy data from main memory to PIM device with type for a range of elements within the PIM object
 PimStatus
 pimCopyHostToDeviceWithType(PimCopyEnum copyType, void* src, PimObjId dest, uint64_t idxBegin, uint64_t idxEnd)
@@ -528,3 +583,49 @@ pimFuse(PimProg prog)
   bool ok = pimSim::get()->pimFuse(prog);
   return ok ? PIM_OK : PIM_ERROR;
 }
+
+//! @brief  Create an asynchronous command stream
+PimStreamId
+pimStreamCreate()
+{
+  return pimSim::get()->pimStreamCreate();
+}
+
+//! @brief  Destroy an asynchronous command stream after its pending commands complete
+PimStatus
+pimStreamDestroy(PimStreamId stream)
+{
+  bool ok = pimSim::get()->pimStreamDestroy(stream);
+  return ok ? PIM_OK : PIM_ERROR;
+}
+
+//! @brief  Set the stream that PIM commands of the calling host thread are enqueued to, or -1 for synchronous execution
+PimStatus
+pimSetStream(PimStreamId stream)
+{
+  bool ok = pimSim::get()->pimSetStream(stream);
+  return ok ? PIM_OK : PIM_ERROR;
+}
+
+//! @brief  Wait for all commands enqueued to a stream
+PimStatus
+pimStreamSync(PimStreamId stream)
+{
+  bool ok = pimSim::get()->pimStreamSync(stream);
+  return ok ? PIM_OK : PIM_ERROR;
+}
+
+//! @brief  Record an event at the current end of a stream
+PimEventId
+pimEventRecord(PimStreamId stream)
+{
+  return pimSim::get()->pimEventRecord(stream);
+}
+
+//! @brief  Wait for commands enqueued to a stream before an event was recorded
+PimStatus
+pimEventWait(PimEventId event)
+{
+  bool ok = pimSim::get()->pimEventWait(event);
+  return ok ? PIM_OK : PIM_ERROR;
+}
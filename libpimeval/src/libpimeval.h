@@ -75,6 +75,7 @@ enum PimDataType {
   PIM_FP16,
   PIM_BF16,
   PIM_FP8,
+  PIM_DATA_TYPE_MAX,  // number of data types, not a data type
 };
 
 //! @brief  PIM device properties
@@ -93,6 +94,16 @@ struct PimDeviceProperties {
 
 typedef int PimCoreId;
 typedef int PimObjId;
+typedef int PimStreamId;
+typedef int PimEventId;
+
+//! @brief  A host-device transfer of a batch. The full range of the PIM object is used if idxEnd is 0
+struct PimCopyDesc {
+  void* hostPtr = nullptr;
+  PimObjId obj = -1;
+  uint64_t idxBegin = 0;
+  uint64_t idxEnd = 0;
+};
 
 // PIMeval simulation
 // CPU runtime between start/end timer will be measured for modeling DRAM refresh
@@ -129,6 +140,19 @@ PimObjId pimAllocAssociated(PimObjId assocId, PimDataType dataType);
 PimObjId pimAllocBuffer(uint32_t numElements, PimDataType dataType);
 PimStatus pimFree(PimObjId obj);
 
+// Zero-copy host buffers
+// Note: A registered host buffer becomes the backing store of all elements of a PIM object, and it must stay
+// valid until the PIM object is freed or re-registered. PIM computation writes the host buffer directly.
+// Registration is modeled as a host-to-device copy of all elements without moving bytes. Copying between a
+// PIM object and its own host buffer is also modeled without moving bytes. The host buffer must be aligned to
+// the host element size of the data type, e.g., 4 bytes for PIM_INT32. A misaligned buffer is rejected.
+// After the host writes a registered host buffer, call pimMarkHostBufferModified before the next PIM API that
+// reads the object. Otherwise non-functional simulation keeps using stale data in simulated memory. It is
+// modeled as a host-to-device copy of all elements without moving bytes, same as registration.
+PimObjId pimAllocFromHostBuffer(PimAllocEnum allocType, uint64_t numElements, PimDataType dataType, void* hostBuffer);
+PimStatus pimRegisterHostBuffer(PimObjId obj, void* hostBuffer);
+PimStatus pimMarkHostBufferModified(PimObjId obj);
+
 // Data transfer
 // Note: idxBegin and idxEnd specify the range of indexes to be processed by the PIM.
 // The size of the host-side vector should match the size of this range on the PIM side.
@@ -138,6 +162,19 @@ PimStatus pimCopyHostToDevice(void* src, PimObjId dest, uint64_t idxBegin = 0, u
 PimStatus pimCopyDeviceToHost(PimObjId src, void* dest, uint64_t idxBegin = 0, uint64_t idxEnd = 0);
 PimStatus pimCopyDeviceToDevice(PimObjId src, PimObjId dest, uint64_t idxBegin = 0, uint64_t idxEnd = 0);
 PimStatus pimCopyObjectToObject(PimObjId src, PimObjId dest);
+// Strided data transfer
+// Note: Element k of the PIM range is at host byte offset (k / numElementsPerRow) * rowPitch + (k % numElementsPerRow) * elemStride,
+// so that a row-major host matrix can be copied without repacking. An elemStride of 0 means dense elements in a row.
+// Example: Copy column j of a row-major int matrix M[numRows][numCols] with (&M[0][j], obj, 1, numCols * sizeof(int)).
+// A strided transfer is modeled the same as a dense transfer of the same number of elements.
+PimStatus pimCopyHostToDevice2D(void* src, PimObjId dest, uint64_t numElementsPerRow, uint64_t rowPitch, uint64_t elemStride = 0, uint64_t idxBegin = 0, uint64_t idxEnd = 0);
+PimStatus pimCopyDeviceToHost2D(PimObjId src, void* dest, uint64_t numElementsPerRow, uint64_t rowPitch, uint64_t elemStride = 0, uint64_t idxBegin = 0, uint64_t idxEnd = 0);
+// Batched data transfer
+// Note: All transfers of a batch run as one command, in parallel when multithreaded.
+// Transfers of a batch must not overlap on either the host or the PIM side.
+// A batch is modeled as a single transfer of all its bytes, so per-transfer overheads are paid once.
+PimStatus pimCopyHostToDeviceBatch(const PimCopyDesc* descs, uint64_t numDescs);
+PimStatus pimCopyDeviceToHostBatch(const PimCopyDesc* descs, uint64_t numDescs);
 PimStatus pimConvertType(PimObjId src, PimObjId dest);
 
 // Logic and Arithmetic Operation
@@ -230,6 +267,24 @@ struct PimProg {
 };
 PimStatus pimFuse(PimProg prog);
 
+////////////////////////////////////////////////////////////////////////////////
+// Experimental Feature: Asynchronous Streams with Modeled Overlap            //
+////////////////////////////////////////////////////////////////////////////////
+// While a stream is set for the calling host thread, PIM commands are enqueued
+// to it and return immediately, so host code overlaps with simulation. Enqueued
+// commands of all streams are simulated one at a time in enqueue order; overlap
+// of independent commands across streams, and of host-device transfers with
+// computation, is reflected in modeled runtime only. Host buffers of
+// enqueued copies and reductions must stay valid until the stream is synced.
+// Synchronous commands, pimFree and pimShowStats wait for pending commands that
+// access the same objects. Errors of enqueued commands are reported at sync.
+PimStreamId pimStreamCreate();
+PimStatus pimStreamDestroy(PimStreamId stream);
+PimStatus pimSetStream(PimStreamId stream);  // -1 for synchronous execution
+PimStatus pimStreamSync(PimStreamId stream);
+PimEventId pimEventRecord(PimStreamId stream);
+PimStatus pimEventWait(PimEventId event);
+
 ////////////////////////////////////////////////////////////////////////////////
 // Warning: Avoid using below customized APIs for functional simulation       //
 //          Some are PIM architecture dependent, some are in progress         //
@@ -7,6 +7,8 @@
 #include "pimDevice.h"       // for pimDevice
 #include "pimCore.h"         // for pimCore
 #include "pimResMgr.h"       // for pimResMgr
+#include "pimKernels.h"      // for pimKernels
+#include "pimProbe.h"        // for PIM_PROBE_SCOPE
 #include "libpimeval.h"      // for PimObjId
 #include <cstdio>
 #include <cmath>
@@ -14,6 +16,10 @@
 #include <unordered_set>
 #include <climits>
 #include <cinttypes>         // for PRIu64, PRIx64
+#include <type_traits>       // for is_integral_v
+#include <chrono>            // for high_resolution_clock
+#include <algorithm>         // for min, max, sort, unique
+#include <tuple>             // for tuple
 
 //! @brief  Get PIM command name from command type enum
 std::string
@@ -142,28 +148,123 @@ pimCmd::isConvertibleType(const pimObjInfo& src, const pimObjInfo& dest) const
 }
 
 //! @brief  Process all regions in MT used by derived classes
+//!         Adjacent regions are batched so that each thread gets a few chunks to balance
 bool
 pimCmd::computeAllRegions(unsigned numRegions)
+{
+  unsigned numThreads = pimSim::get()->getNumThreads();
+  uint64_t grainSize = std::max<uint64_t>(1, numRegions / (static_cast<uint64_t>(numThreads) * s_numChunksPerThread));
+  runInParallel(numRegions, grainSize, [this](uint64_t regionBegin, uint64_t regionEnd) {
+    for (uint64_t i = regionBegin; i < regionEnd; ++i) {
+      computeRegion(i);
+    }
+  });
+  return true;
+}
+
+//! @brief  Process all elements in MT used by element-wise derived classes
+//!         Work is partitioned by element count instead of regions. Small objects are split evenly
+//!         across threads, and large objects are processed in chunks that fit the task chunk size
+bool
+pimCmd::computeAllElements(uint64_t numElements, unsigned bytesPerElement)
+{
+  uint64_t grainSize = getElementGrainSize(numElements, bytesPerElement);
+  runInParallel(numElements, grainSize, [this](uint64_t idxBegin, uint64_t idxEnd) {
+    computeElements(idxBegin, idxEnd - idxBegin);
+  });
+  return true;
+}
+
+//! @brief  Get number of elements per task chunk for element-wise computation
+uint64_t
+pimCmd::getElementGrainSize(uint64_t numElements, unsigned bytesPerElement) const
+{
+  unsigned numThreads = pimSim::get()->getNumThreads();
+  uint64_t chunkBytes = pimSim::get()->getConfig().getTaskChunkSize();
+  uint64_t grainSize = std::max<uint64_t>(1, chunkBytes / std::max(bytesPerElement, 1u));
+  if (numElements < grainSize * numThreads) {
+    grainSize = (numElements + numThreads - 1) / numThreads;
+  }
+  // keep chunk boundaries aligned for vectorized kernels
+  return std::max<uint64_t>(s_minElementsPerChunk, (grainSize + 63) / 64 * 64);
+}
+
+//! @brief  Execute an element-wise command after sanity check
+//!         Sync sources from simulated memory, compute all elements, then sync dest back
+bool
+pimCmd::executeElementWise()
+{
+  pimElementWiseInfo info;
+  if (!getElementWiseInfo(info)) {
+    return false;
+  }
+
+  pimResMgr* resMgr = m_device->getResMgr();
+  if (pimSim::get()->getDeviceType() != PIM_FUNCTIONAL) {
+    for (PimObjId objId : info.m_srcIds) {
+      resMgr->getObjInfo(objId).syncFromSimulatedMem();
+    }
+  }
+
+  computeAllElements(info.m_numElements, info.m_bytesPerElement);
+
+  if (pimSim::get()->getDeviceType() != PIM_FUNCTIONAL) {
+    pimObjInfo &objDest = resMgr->getObjInfo(info.m_destId);
+    objDest.markDataHolderModified();
+    objDest.syncToSimulatedMem();
+  }
+
+  updateStats();
+  return true;
+}
+
+//! @brief  Run func over [0, numItems) in chunks of grainSize, with the thread pool if MT
+void
+pimCmd::runInParallel(uint64_t numItems, uint64_t grainSize, const pimUtils::threadPool::rangeFunc& func)
 {
   // skip PIM computation in analysis mode
   if (pimSim::get()->isAnalysisMode()) {
-    return true;
+    return;
   }
+  PIM_PROBE_SCOPE("compute");
+  bool isBenchmarkMode = pimSim::get()->getConfig().isBenchmarkMode();
+  auto startTime = isBenchmarkMode ? std::chrono::high_resolution_clock::now() : std::chrono::high_resolution_clock::time_point();
   if (pimSim::get()->getNumThreads() > 1) { // MT
-    std::vector<pimUtils::threadWorker*> workers;
-    for (unsigned i = 0; i < numRegions; ++i) {
-      workers.push_back(new regionWorker(this, i));
-    }
-    pimSim::get()->getThreadPool()->doWork(workers);
-    for (unsigned i = 0; i < numRegions; ++i) {
-      delete workers[i];
-    }
+    pimSim::get()->getThreadPool()->parallelFor(0, numItems, grainSize, func);
   } else { // single thread
-    for (unsigned i = 0; i < numRegions; ++i) {
-      computeRegion(i);
+    for (uint64_t i = 0; i < numItems; i += grainSize) {
+      func(i, std::min(i + grainSize, numItems));
     }
   }
-  return true;
+  if (isBenchmarkMode) {
+    auto now = std::chrono::high_resolution_clock::now();
+    m_msKernelElapsed = std::chrono::duration<double, std::milli>(now - startTime).count();
+  }
+}
+
+//! @brief  Performance and energy of a command, used by commands that can be fused
+pimeval::perfEnergy
+pimCmd::getPerfEnergy() const
+{
+  return pimeval::perfEnergy();
+}
+
+//! @brief  Record host throughput of functional computation in benchmark mode
+void
+pimCmd::recordKernelThroughput(const std::string& cmdName, uint64_t numElements) const
+{
+  if (pimSim::get()->getConfig().isBenchmarkMode() && !pimSim::get()->isAnalysisMode()) {
+    pimSim::get()->getStatsMgr()->recordKernelThroughput(cmdName, numElements, m_msKernelElapsed);
+  }
+}
+
+//! @brief  Record host throughput of functional computation in benchmark mode
+void
+pimCmd::recordKernelThroughput(PimDataType dataType, bool isVLayout, uint64_t numElements) const
+{
+  if (pimSim::get()->getConfig().isBenchmarkMode() && !pimSim::get()->isAnalysisMode()) {
+    pimSim::get()->getStatsMgr()->recordKernelThroughput(m_cmdType, dataType, isVLayout, numElements, m_msKernelElapsed);
+  }
 }
 
 
@@ -184,12 +285,21 @@ pimCmdCopy::execute()
   }
 
   if (!pimSim::get()->isAnalysisMode()) {
+    PIM_PROBE_SCOPE("copy");
     if (m_cmdType == PimCmdEnum::COPY_H2D) {
       pimObjInfo &objDest = m_device->getResMgr()->getObjInfo(m_dest);
-      objDest.copyFromHost(m_ptr, m_idxBegin, m_idxEnd);
+      if (m_isHostStrided) {
+        objDest.copyFromHost2D(m_ptr, m_hostLayout, m_idxBegin, m_idxEnd);
+      } else {
+        objDest.copyFromHost(m_ptr, m_idxBegin, m_idxEnd);
+      }
     } else if (m_cmdType == PimCmdEnum::COPY_D2H) {
       const pimObjInfo &objSrc = m_device->getResMgr()->getObjInfo(m_src);
-      objSrc.copyToHost(m_ptr, m_idxBegin, m_idxEnd);
+      if (m_isHostStrided) {
+        objSrc.copyToHost2D(m_ptr, m_hostLayout, m_idxBegin, m_idxEnd);
+      } else {
+        objSrc.copyToHost(m_ptr, m_idxBegin, m_idxEnd);
+      }
     } else if (m_cmdType == PimCmdEnum::COPY_D2D) {
       const pimObjInfo &objSrc = m_device->getResMgr()->getObjInfo(m_src);
       pimObjInfo &objDest = m_device->getResMgr()->getObjInfo(m_dest);
@@ -202,7 +312,8 @@ pimCmdCopy::execute()
   // for non-functional simulation, sync dest data to simulated memory
   if (pimSim::get()->getDeviceType() != PIM_FUNCTIONAL) {
     if (m_cmdType == PimCmdEnum::COPY_H2D || m_cmdType == PimCmdEnum::COPY_D2D) {
-      const pimObjInfo &objDest = m_device->getResMgr()->getObjInfo(m_dest);
+      pimObjInfo &objDest = m_device->getResMgr()->getObjInfo(m_dest);
+      objDest.markDataHolderModified();
       objDest.syncToSimulatedMem();
     }
   }
@@ -268,6 +379,10 @@ pimCmdCopy::sanityCheck() const
   default:
     assert(0);
   }
+  if (m_isHostStrided && m_hostLayout.m_numElementsPerRow == 0) {
+    std::printf("PIM-Error: Invalid zero number of elements per row for strided host copy\n");
+    return false;
+  }
   if (!m_copyFullRange) {
     if (m_idxBegin > numElements) {
       std::printf("PIM-Error: The beginning of the copy range for PIM object ID %d is greater than the number of elements\n", m_dest);
@@ -286,6 +401,21 @@ pimCmdCopy::sanityCheck() const
   return true;
 }
 
+//! @brief  PIM Data Copy - get objects read and written
+bool
+pimCmdCopy::getObjAccess(std::vector<PimObjId>& readIds, std::vector<PimObjId>& writeIds) const
+{
+  readIds.clear();
+  writeIds.clear();
+  if (m_cmdType == PimCmdEnum::COPY_D2H || m_cmdType == PimCmdEnum::COPY_D2D) {
+    readIds.push_back(m_src);
+  }
+  if (m_cmdType == PimCmdEnum::COPY_H2D || m_cmdType == PimCmdEnum::COPY_D2D) {
+    writeIds.push_back(m_dest);
+  }
+  return true;
+}
+
 //! @brief  PIM Data Copy - update stats
 bool
 pimCmdCopy::updateStats() const
@@ -339,40 +469,196 @@ pimCmdCopy::updateStats() const
 }
 
 
-//! @brief  PIM CMD: Functional 1-operand
-bool
-pimCmdFunc1::execute()
+//! @brief  PIM Data Copy Batch - number of elements of a transfer
+uint64_t
+pimCmdCopyBatch::getNumElements(const PimCopyDesc& desc) const
 {
-  if (m_debugCmds) {
-    std::printf("PIM-Cmd: %s (obj id %d -> %d)\n", getName().c_str(), m_src, m_dest);
+  if (desc.idxEnd == 0ULL) {
+    return m_device->getResMgr()->getObjInfo(desc.obj).getNumElements() - desc.idxBegin;
   }
+  return desc.idxEnd - desc.idxBegin;
+}
 
+//! @brief  PIM Data Copy Batch
+bool
+pimCmdCopyBatch::execute()
+{
   if (!sanityCheck()) {
     return false;
   }
 
+  pimResMgr* resMgr = m_device->getResMgr();
+  std::vector<PimObjId> readIds;
+  std::vector<PimObjId> writeIds;
+  getObjAccess(readIds, writeIds);
+
+  // for non-functional simulation, sync src data from simulated memory
   if (pimSim::get()->getDeviceType() != PIM_FUNCTIONAL) {
-    pimObjInfo &objSrc = m_device->getResMgr()->getObjInfo(m_src);
-    objSrc.syncFromSimulatedMem();
-    if (m_cmdType == PimCmdEnum::BIT_SLICE_INSERT) {  // require dest data to be synced
-      pimObjInfo &objDest = m_device->getResMgr()->getObjInfo(m_dest);
-      objDest.syncFromSimulatedMem();
+    for (PimObjId objId : readIds) {
+      resMgr->getObjInfo(objId).syncFromSimulatedMem();
     }
   }
 
-  const pimObjInfo& objSrc = m_device->getResMgr()->getObjInfo(m_src);
-  unsigned numRegions = objSrc.getRegions().size();
-  computeAllRegions(numRegions);
+  if (!pimSim::get()->isAnalysisMode()) {
+    PIM_PROBE_SCOPE("copy");
+    auto func = [&](uint64_t descBegin, uint64_t descEnd) {
+      for (uint64_t i = descBegin; i < descEnd; ++i) {
+        const PimCopyDesc& desc = m_descs[i];
+        if (m_cmdType == PimCmdEnum::COPY_H2D) {
+          resMgr->getObjInfo(desc.obj).copyFromHost(desc.hostPtr, desc.idxBegin, desc.idxEnd);
+        } else {
+          resMgr->getObjInfo(desc.obj).copyToHost(desc.hostPtr, desc.idxBegin, desc.idxEnd);
+        }
+      }
+    };
+    if (pimSim::get()->getNumThreads() > 1 && m_descs.size() > 1) { // MT
+      pimSim::get()->getThreadPool()->parallelFor(0, m_descs.size(), 1, func);
+    } else {
+      func(0, m_descs.size());
+    }
+  }
 
+  // for non-functional simulation, sync dest data to simulated memory
   if (pimSim::get()->getDeviceType() != PIM_FUNCTIONAL) {
-    const pimObjInfo &objDest = m_device->getResMgr()->getObjInfo(m_dest);
-    objDest.syncToSimulatedMem();
+    for (PimObjId objId : writeIds) {
+      pimObjInfo &objDest = resMgr->getObjInfo(objId);
+      objDest.markDataHolderModified();
+      objDest.syncToSimulatedMem();
+    }
   }
 
   updateStats();
   return true;
 }
 
+//! @brief  PIM Data Copy Batch - sanity check
+bool
+pimCmdCopyBatch::sanityCheck() const
+{
+  assert(m_cmdType == PimCmdEnum::COPY_H2D || m_cmdType == PimCmdEnum::COPY_D2H);
+  pimResMgr* resMgr = m_device->getResMgr();
+  bool isH2D = (m_cmdType == PimCmdEnum::COPY_H2D);
+  for (const PimCopyDesc& desc : m_descs) {
+    if (!desc.hostPtr) {
+      std::printf("PIM-Error: Invalid null pointer as copy %s\n", isH2D ? "source" : "destination");
+      return false;
+    }
+    if (!resMgr->isValidObjId(desc.obj)) {
+      std::printf("PIM-Error: Invalid PIM object ID %d as copy %s\n", desc.obj, isH2D ? "destination" : "source");
+      return false;
+    }
+    // idxEnd of 0 copies the full range
+    if (desc.idxEnd == 0ULL && desc.idxBegin != 0ULL) {
+      std::printf("PIM-Error: The beginning of the full copy range for PIM object ID %d must be 0\n", desc.obj);
+      return false;
+    }
+    if (desc.idxEnd != 0ULL) {
+      uint64_t numElements = resMgr->getObjInfo(desc.obj).getNumElements();
+      if (desc.idxEnd > numElements) {
+        std::printf("PIM-Error: The end of the copy range for PIM object ID %d is greater than the number of elements\n", desc.obj);
+        return false;
+      }
+      if (desc.idxEnd < desc.idxBegin) {
+        std::printf("PIM-Error: The end of the copy range for PIM object ID %d is less than its beginning\n", desc.obj);
+        return false;
+      }
+    }
+  }
+
+  // transfers run in parallel, so device-side ranges written by a batch must be disjoint
+  // A ref, e.g., a dual-contact ref, shares rows of its root object at the same element indices
+  if (isH2D) {
+    std::vector<std::tuple<PimObjId, uint64_t, uint64_t>> ranges;
+    ranges.reserve(m_descs.size());
+    for (const PimCopyDesc& desc : m_descs) {
+      PimObjId rootId = desc.obj;
+      while (resMgr->getObjInfo(rootId).getRefObjId() != -1) {
+        rootId = resMgr->getObjInfo(rootId).getRefObjId();
+      }
+      ranges.emplace_back(rootId, desc.idxBegin, desc.idxBegin + getNumElements(desc));
+    }
+    std::sort(ranges.begin(), ranges.end());
+    for (size_t i = 1; i < ranges.size(); ++i) {
+      if (std::get<0>(ranges[i]) == std::get<0>(ranges[i - 1]) && std::get<1>(ranges[i]) < std::get<2>(ranges[i - 1])) {
+        std::printf("PIM-Error: Overlapping copy ranges for PIM object ID %d or its refs in a batch\n", std::get<0>(ranges[i]));
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+//! @brief  PIM Data Copy Batch - get objects read and written
+bool
+pimCmdCopyBatch::getObjAccess(std::vector<PimObjId>& readIds, std::vector<PimObjId>& writeIds) const
+{
+  readIds.clear();
+  writeIds.clear();
+  std::vector<PimObjId>& ids = (m_cmdType == PimCmdEnum::COPY_H2D) ? writeIds : readIds;
+  for (const PimCopyDesc& desc : m_descs) {
+    ids.push_back(desc.obj);
+  }
+  std::sort(ids.begin(), ids.end());
+  ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+  return true;
+}
+
+//! @brief  PIM Data Copy Batch - update stats
+//!         All transfers of a batch are modeled as a single transfer of the total bytes,
+//!         so that per-transfer overheads of the perf energy model are paid once
+bool
+pimCmdCopyBatch::updateStats() const
+{
+  uint64_t numBits = 0;
+  for (const PimCopyDesc& desc : m_descs) {
+    const pimObjInfo &obj = m_device->getResMgr()->getObjInfo(desc.obj);
+    numBits += getNumElements(desc) * obj.getBitsPerElement(PimBitWidth::ACTUAL);
+  }
+  pimeval::perfEnergy mPerfEnergy = pimSim::get()->getPerfEnergyModel()->getPerfEnergyForBytesTransfer(m_cmdType, numBits / 8);
+  if (m_cmdType == PimCmdEnum::COPY_H2D) {
+    pimSim::get()->getStatsMgr()->recordCopyMainToDevice(numBits, mPerfEnergy);
+  } else {
+    pimSim::get()->getStatsMgr()->recordCopyDeviceToMain(numBits, mPerfEnergy);
+  }
+
+  if (m_debugCmds) {
+    std::printf("PIM-Cmd: Copied %" PRIu64 " bits in a batch of %zu transfers %s\n",
+                numBits, m_descs.size(), m_cmdType == PimCmdEnum::COPY_H2D ? "from host to PIM" : "from PIM to host");
+  }
+  return true;
+}
+
+//! @brief  PIM CMD: Functional 1-operand
+bool
+pimCmdFunc1::execute()
+{
+  if (m_debugCmds) {
+    std::printf("PIM-Cmd: %s (obj id %d -> %d)\n", getName().c_str(), m_src, m_dest);
+  }
+
+  if (!sanityCheck()) {
+    return false;
+  }
+
+  return executeElementWise();
+}
+
+//! @brief  PIM CMD: Functional 1-operand - get element-wise operands
+bool
+pimCmdFunc1::getElementWiseInfo(pimElementWiseInfo& info) const
+{
+  const pimObjInfo& objSrc = m_device->getResMgr()->getObjInfo(m_src);
+  const pimObjInfo& objDest = m_device->getResMgr()->getObjInfo(m_dest);
+  info.m_srcIds = { m_src };
+  if (m_cmdType == PimCmdEnum::BIT_SLICE_INSERT) {  // require dest data to be synced
+    info.m_srcIds.push_back(m_dest);
+  }
+  info.m_destId = m_dest;
+  info.m_numElements = objSrc.getNumElements();
+  info.m_bytesPerElement = (objSrc.getBitsPerElement(PimBitWidth::HOST) + objDest.getBitsPerElement(PimBitWidth::HOST)) / 8;
+  return true;
+}
+
 //! @brief  PIM CMD: Functional 1-operand - sanity check
 bool
 pimCmdFunc1::sanityCheck() const
@@ -455,22 +741,25 @@ pimCmdFunc1::sanityCheck() const
   return true;
 }
 
-//! @brief  PIM CMD: Functional 1-operand - compute region
+//! @brief  PIM CMD: Functional 1-operand - compute elements in [idxBegin, idxBegin + numElements)
 bool
-pimCmdFunc1::computeRegion(unsigned index)
+pimCmdFunc1::computeElements(uint64_t idxBegin, uint64_t numElements)
 {
   const pimObjInfo& objSrc = m_device->getResMgr()->getObjInfo(m_src);
   pimObjInfo& objDest = m_device->getResMgr()->getObjInfo(m_dest);
 
   PimDataType dataType = objSrc.getDataType();
   unsigned bitsPerElementSrc = objSrc.getBitsPerElement(PimBitWidth::SIM);
-  const pimRegion& srcRegion = objSrc.getRegions()[index];
 
-  // perform the computation
-  uint64_t elemIdxBegin = srcRegion.getElemIdxBegin();
-  unsigned numElementsInRegion = srcRegion.getNumElemInRegion();
-  for (unsigned j = 0; j < numElementsInRegion; ++j) {
-    uint64_t elemIdx = elemIdxBegin + j;
+  // fast path: type and opcode specialized kernel over contiguous typed spans
+  bool isHandled = false;
+  bool status = computeRegionTyped(objSrc, objDest, idxBegin, numElements, isHandled);
+  if (isHandled) {
+    return status;
+  }
+
+  for (uint64_t j = 0; j < numElements; ++j) {
+    uint64_t elemIdx = idxBegin + j;
     if (m_cmdType == PimCmdEnum::CONVERT_TYPE) {
       convertType(objSrc, objDest, elemIdx);
       continue;
@@ -509,6 +798,67 @@ pimCmdFunc1::computeRegion(unsigned index)
   return true;
 }
 
+//! @brief  PIM CMD: Functional 1-operand - compute region with type and opcode specialized kernels
+//!         Set isHandled to false if the command requires the generic per-element path
+bool
+pimCmdFunc1::computeRegionTyped(const pimObjInfo& objSrc, pimObjInfo& objDest, uint64_t idxBegin, uint64_t numElements, bool& isHandled) const
+{
+  isHandled = false;
+  PimDataType dataType = objSrc.getDataType();
+  PimDataType dataTypeDest = pimKernels::isBoolResultCmd(m_cmdType) ? PIM_BOOL : dataType;
+  // dual-contact refs negate bits per element
+  if (objSrc.getRefObjId() != -1 || objDest.getRefObjId() != -1 || objDest.getDataType() != dataTypeDest) {
+    return true;
+  }
+  bool status = true;
+  pimKernels::dispatchDataType(dataType, [&](auto typeTag) {
+    using T = decltype(typeTag);
+    status = computeSpanTyped<T>(objSrc.getTypedData<T>(), objDest, idxBegin, numElements, isHandled);
+  });
+  return status;
+}
+
+//! @brief  PIM CMD: Functional 1-operand - select specialized kernel of element type T
+template <typename T>
+bool
+pimCmdFunc1::computeSpanTyped(const T* src, pimObjInfo& objDest, uint64_t idxBegin, uint64_t numElements, bool& isHandled) const
+{
+  PimSimdIsa isa = pimSim::get()->getConfig().getSimdIsa();
+#define PIM_FUNC1_KERNEL_CASE(op) \
+    case PimCmdEnum::op: isHandled = true; return pimKernels::func1Kernel<PimCmdEnum::op, T>(isa, src, objDest, idxBegin, numElements, m_scalarValue);
+
+  if constexpr (std::is_integral_v<T>) {
+    switch (m_cmdType) {
+      PIM_FUNC1_KERNEL_CASE(NOT)
+      PIM_FUNC1_KERNEL_CASE(AND_SCALAR)
+      PIM_FUNC1_KERNEL_CASE(OR_SCALAR)
+      PIM_FUNC1_KERNEL_CASE(XOR_SCALAR)
+      PIM_FUNC1_KERNEL_CASE(XNOR_SCALAR)
+      PIM_FUNC1_KERNEL_CASE(POPCOUNT)
+      PIM_FUNC1_KERNEL_CASE(SHIFT_BITS_R)
+      PIM_FUNC1_KERNEL_CASE(SHIFT_BITS_L)
+      default: break;
+    }
+  }
+  switch (m_cmdType) {
+    PIM_FUNC1_KERNEL_CASE(COPY_O2O)
+    PIM_FUNC1_KERNEL_CASE(ADD_SCALAR)
+    PIM_FUNC1_KERNEL_CASE(SUB_SCALAR)
+    PIM_FUNC1_KERNEL_CASE(MUL_SCALAR)
+    PIM_FUNC1_KERNEL_CASE(DIV_SCALAR)
+    PIM_FUNC1_KERNEL_CASE(GT_SCALAR)
+    PIM_FUNC1_KERNEL_CASE(LT_SCALAR)
+    PIM_FUNC1_KERNEL_CASE(EQ_SCALAR)
+    PIM_FUNC1_KERNEL_CASE(NE_SCALAR)
+    PIM_FUNC1_KERNEL_CASE(MIN_SCALAR)
+    PIM_FUNC1_KERNEL_CASE(MAX_SCALAR)
+    PIM_FUNC1_KERNEL_CASE(ABS)
+    default: break;
+  }
+#undef PIM_FUNC1_KERNEL_CASE
+  return true;
+}
+
 //! @brief  PIM CMD: Functional 1-operand - compute region - convert data type
 bool
 pimCmdFunc1::convertType(const pimObjInfo& objSrc, pimObjInfo& objDest, uint64_t elemIdx) const
@@ -564,6 +914,20 @@ pimCmdFunc1::bitSliceInsert(const pimObjInfo& objSrcBool, pimObjInfo& objDest, u
   return true;
 }
 
+//! @brief  PIM CMD: Functional 1-operand - performance and energy
+pimeval::perfEnergy
+pimCmdFunc1::getPerfEnergy() const
+{
+  // Special handling: Use dest for performance energy calculation of bit-slice insert
+  bool useDestAsSrc = (m_cmdType == PimCmdEnum::BIT_SLICE_INSERT);
+  const pimObjInfo& objSrc = (useDestAsSrc? m_device->getResMgr()->getObjInfo(m_dest) : m_device->getResMgr()->getObjInfo(m_src));
+  const pimObjInfo& objDest = m_device->getResMgr()->getObjInfo(m_dest);
+  const pimPerfEnergyBase* model = pimSim::get()->getPerfEnergyModel();
+  return model->getMemoizedPerfEnergy(pimeval::perfEnergyKey(m_cmdType, objSrc, objDest.getDataType()), [&]() {
+    return model->getPerfEnergyForFunc1(m_cmdType, objSrc, objDest);
+  });
+}
+
 //! @brief  PIM CMD: Functional 1-operand - update stats
 bool
 pimCmdFunc1::updateStats() const
@@ -571,12 +935,11 @@ pimCmdFunc1::updateStats() const
   // Special handling: Use dest for performance energy calculation of bit-slice insert
   bool useDestAsSrc = (m_cmdType == PimCmdEnum::BIT_SLICE_INSERT);
   const pimObjInfo& objSrc = (useDestAsSrc? m_device->getResMgr()->getObjInfo(m_dest) : m_device->getResMgr()->getObjInfo(m_src));
-  const pimObjInfo& objDest = m_device->getResMgr()->getObjInfo(m_dest);
   PimDataType dataType = objSrc.getDataType();
   bool isVLayout = objSrc.isVLayout();
 
-  pimeval::perfEnergy mPerfEnergy = pimSim::get()->getPerfEnergyModel()->getPerfEnergyForFunc1(m_cmdType, objSrc, objDest);
-  pimSim::get()->getStatsMgr()->recordCmd(getName(dataType, isVLayout), mPerfEnergy);
+  pimSim::get()->getStatsMgr()->recordCmd(m_cmdType, dataType, isVLayout, getPerfEnergy());
+  recordKernelThroughput(dataType, isVLayout, objSrc.getNumElements());
   return true;
 }
 
@@ -592,23 +955,19 @@ pimCmdFunc2::execute()
     return false;
   }
 
-  if (pimSim::get()->getDeviceType() != PIM_FUNCTIONAL) {
-    pimObjInfo &objSrc1 = m_device->getResMgr()->getObjInfo(m_src1);
-    pimObjInfo &objSrc2 = m_device->getResMgr()->getObjInfo(m_src2);
-    objSrc1.syncFromSimulatedMem();
-    objSrc2.syncFromSimulatedMem();
-  }
+  return executeElementWise();
+}
 
+//! @brief  PIM CMD: Functional 2-operand - get element-wise operands
+bool
+pimCmdFunc2::getElementWiseInfo(pimElementWiseInfo& info) const
+{
   const pimObjInfo& objSrc1 = m_device->getResMgr()->getObjInfo(m_src1);
-  unsigned numRegions = objSrc1.getRegions().size();
-  computeAllRegions(numRegions);
-
-  if (pimSim::get()->getDeviceType() != PIM_FUNCTIONAL) {
-    const pimObjInfo &objDest = m_device->getResMgr()->getObjInfo(m_dest);
-    objDest.syncToSimulatedMem();
-  }
-
-  updateStats();
+  const pimObjInfo& objDest = m_device->getResMgr()->getObjInfo(m_dest);
+  info.m_srcIds = { m_src1, m_src2 };
+  info.m_destId = m_dest;
+  info.m_numElements = objSrc1.getNumElements();
+  info.m_bytesPerElement = (objSrc1.getBitsPerElement(PimBitWidth::HOST) * 2 + objDest.getBitsPerElement(PimBitWidth::HOST)) / 8;
   return true;
 }
 
@@ -692,9 +1051,9 @@ pimCmdFunc2::sanityCheck() const
   return true;
 }
 
-//! @brief  PIM CMD: Functional 2-operand - compute region
+//! @brief  PIM CMD: Functional 2-operand - compute elements in [idxBegin, idxBegin + numElements)
 bool
-pimCmdFunc2::computeRegion(unsigned index)
+pimCmdFunc2::computeElements(uint64_t idxBegin, uint64_t numElements)
 {
   const pimObjInfo& objSrc1 = m_device->getResMgr()->getObjInfo(m_src1);
   const pimObjInfo& objSrc2 = m_device->getResMgr()->getObjInfo(m_src2);
@@ -702,13 +1061,15 @@ pimCmdFunc2::computeRegion(unsigned index)
 
   PimDataType dataType = objSrc1.getDataType();
 
-  const pimRegion& src1Region = objSrc1.getRegions()[index];
+  // fast path: type and opcode specialized kernel over contiguous typed spans
+  bool isHandled = false;
+  bool status = computeRegionTyped(objSrc1, objSrc2, objDest, idxBegin, numElements, isHandled);
+  if (isHandled) {
+    return status;
+  }
 
-  // perform the computation
-  uint64_t elemIdxBegin = src1Region.getElemIdxBegin();
-  unsigned numElementsInRegion = src1Region.getNumElemInRegion();
-  for (unsigned j = 0; j < numElementsInRegion; ++j) {
-    uint64_t elemIdx = elemIdxBegin + j;
+  for (uint64_t j = 0; j < numElements; ++j) {
+    uint64_t elemIdx = idxBegin + j;
     if (pimUtils::isSigned(dataType)) {
       uint64_t operandBits1 = objSrc1.getElementBits(elemIdx);
       uint64_t operandBits2 = objSrc2.getElementBits(elemIdx);
@@ -743,18 +1104,86 @@ pimCmdFunc2::computeRegion(unsigned index)
   return true;
 }
 
-//! @brief  PIM CMD: Functional 2-operand - update stats
+//! @brief  PIM CMD: Functional 2-operand - compute region with type and opcode specialized kernels
+//!         Set isHandled to false if the command requires the generic per-element path
 bool
-pimCmdFunc2::updateStats() const
+pimCmdFunc2::computeRegionTyped(const pimObjInfo& objSrc1, const pimObjInfo& objSrc2, pimObjInfo& objDest, uint64_t idxBegin, uint64_t numElements, bool& isHandled) const
+{
+  isHandled = false;
+  PimDataType dataType = objSrc1.getDataType();
+  PimDataType dataTypeDest = pimKernels::isBoolResultCmd(m_cmdType) ? PIM_BOOL : dataType;
+  // dual-contact refs negate bits per element, and mixed types need per-element conversion
+  if (objSrc1.getRefObjId() != -1 || objSrc2.getRefObjId() != -1 || objDest.getRefObjId() != -1 ||
+      objSrc2.getDataType() != dataType || objDest.getDataType() != dataTypeDest) {
+    return true;
+  }
+  bool status = true;
+  pimKernels::dispatchDataType(dataType, [&](auto typeTag) {
+    using T = decltype(typeTag);
+    status = computeSpanTyped<T>(objSrc1.getTypedData<T>(), objSrc2.getTypedData<T>(), objDest, idxBegin, numElements, isHandled);
+  });
+  return status;
+}
+
+//! @brief  PIM CMD: Functional 2-operand - select specialized kernel of element type T
+template <typename T>
+bool
+pimCmdFunc2::computeSpanTyped(const T* src1, const T* src2, pimObjInfo& objDest, uint64_t idxBegin, uint64_t numElements, bool& isHandled) const
+{
+  PimSimdIsa isa = pimSim::get()->getConfig().getSimdIsa();
+#define PIM_FUNC2_KERNEL_CASE(op) \
+    case PimCmdEnum::op: isHandled = true; return pimKernels::func2Kernel<PimCmdEnum::op, T>(isa, src1, src2, objDest, idxBegin, numElements, m_scalarValue);
+
+  if constexpr (std::is_integral_v<T>) {
+    switch (m_cmdType) {
+      PIM_FUNC2_KERNEL_CASE(AND)
+      PIM_FUNC2_KERNEL_CASE(OR)
+      PIM_FUNC2_KERNEL_CASE(XOR)
+      PIM_FUNC2_KERNEL_CASE(XNOR)
+      default: break;
+    }
+  }
+  switch (m_cmdType) {
+    PIM_FUNC2_KERNEL_CASE(ADD)
+    PIM_FUNC2_KERNEL_CASE(SUB)
+    PIM_FUNC2_KERNEL_CASE(MUL)
+    PIM_FUNC2_KERNEL_CASE(DIV)
+    PIM_FUNC2_KERNEL_CASE(GT)
+    PIM_FUNC2_KERNEL_CASE(LT)
+    PIM_FUNC2_KERNEL_CASE(EQ)
+    PIM_FUNC2_KERNEL_CASE(NE)
+    PIM_FUNC2_KERNEL_CASE(MIN)
+    PIM_FUNC2_KERNEL_CASE(MAX)
+    PIM_FUNC2_KERNEL_CASE(SCALED_ADD)
+    default: break;
+  }
+#undef PIM_FUNC2_KERNEL_CASE
+  return true;
+}
+
+//! @brief  PIM CMD: Functional 2-operand - performance and energy
+pimeval::perfEnergy
+pimCmdFunc2::getPerfEnergy() const
 {
   const pimObjInfo& objSrc1 = m_device->getResMgr()->getObjInfo(m_src1);
   const pimObjInfo& objSrc2 = m_device->getResMgr()->getObjInfo(m_src2);
   const pimObjInfo& objDest = m_device->getResMgr()->getObjInfo(m_dest);
+  const pimPerfEnergyBase* model = pimSim::get()->getPerfEnergyModel();
+  return model->getMemoizedPerfEnergy(pimeval::perfEnergyKey(m_cmdType, objSrc1, objDest.getDataType()), [&]() {
+    return model->getPerfEnergyForFunc2(m_cmdType, objSrc1, objSrc2, objDest);
+  });
+}
+
+//! @brief  PIM CMD: Functional 2-operand - update stats
+bool
+pimCmdFunc2::updateStats() const
+{
+  const pimObjInfo& objSrc1 = m_device->getResMgr()->getObjInfo(m_src1);
   PimDataType dataType = objSrc1.getDataType();
   bool isVLayout = objSrc1.isVLayout();
 
-  pimeval::perfEnergy mPerfEnergy = pimSim::get()->getPerfEnergyModel()->getPerfEnergyForFunc2(m_cmdType, objSrc1, objSrc2, objDest);
-  pimSim::get()->getStatsMgr()->recordCmd(getName(dataType, isVLayout), mPerfEnergy);
+  pimSim::get()->getStatsMgr()->recordCmd(m_cmdType, dataType, isVLayout, getPerfEnergy());
+  recordKernelThroughput(dataType, isVLayout, objSrc1.getNumElements());
   return true;
 }
 
@@ -771,33 +1200,28 @@ pimCmdCond::execute()
     return false;
   }
 
-  if (pimSim::get()->getDeviceType() != PIM_FUNCTIONAL) {
-    pimObjInfo &objBool = m_device->getResMgr()->getObjInfo(m_condBool);
-    objBool.syncFromSimulatedMem();
-    if (m_cmdType == PimCmdEnum::COND_COPY || m_cmdType == PimCmdEnum::COND_SELECT || m_cmdType == PimCmdEnum::COND_SELECT_SCALAR) {
-      pimObjInfo &objSrc1 = m_device->getResMgr()->getObjInfo(m_src1);
-      objSrc1.syncFromSimulatedMem();
-    }
-    if (m_cmdType == PimCmdEnum::COND_SELECT) {
-      pimObjInfo &objSrc2 = m_device->getResMgr()->getObjInfo(m_src2);
-      objSrc2.syncFromSimulatedMem();
-    }
-    if (m_cmdType == PimCmdEnum::COND_COPY || m_cmdType == PimCmdEnum::COND_BROADCAST) {  // require dest data to be synced
-      pimObjInfo &objDest = m_device->getResMgr()->getObjInfo(m_dest);
-      objDest.syncFromSimulatedMem();
-    }
-  }
-
-  const pimObjInfo& objDest = m_device->getResMgr()->getObjInfo(m_dest);
-  unsigned numRegions = objDest.getRegions().size();
-  computeAllRegions(numRegions);
+  return executeElementWise();
+}
 
-  if (pimSim::get()->getDeviceType() != PIM_FUNCTIONAL) {
-    const pimObjInfo &objDest = m_device->getResMgr()->getObjInfo(m_dest);
-    objDest.syncToSimulatedMem();
+//! @brief  PIM CMD: Conditional Operations - get element-wise operands
+bool
+pimCmdCond::getElementWiseInfo(pimElementWiseInfo& info) const
+{
+  info.m_srcIds = { m_condBool };
+  if (m_cmdType == PimCmdEnum::COND_COPY || m_cmdType == PimCmdEnum::COND_SELECT || m_cmdType == PimCmdEnum::COND_SELECT_SCALAR) {
+    info.m_srcIds.push_back(m_src1);
   }
-
-  updateStats();
+  if (m_cmdType == PimCmdEnum::COND_SELECT) {
+    info.m_srcIds.push_back(m_src2);
+  }
+  if (m_cmdType == PimCmdEnum::COND_COPY || m_cmdType == PimCmdEnum::COND_BROADCAST) {  // require dest data to be synced
+    info.m_srcIds.push_back(m_dest);
+  }
+  const pimObjInfo& objDest = m_device->getResMgr()->getObjInfo(m_dest);
+  info.m_destId = m_dest;
+  info.m_numElements = objDest.getNumElements();
+  // condition, up to two sources and dest
+  info.m_bytesPerElement = 1 + objDest.getBitsPerElement(PimBitWidth::HOST) * 3 / 8;
   return true;
 }
 
@@ -851,22 +1275,25 @@ pimCmdCond::sanityCheck() const
   return true;
 }
 
-//! @brief  PIM CMD: Conditional Operations - compute region
+//! @brief  PIM CMD: Conditional Operations - compute elements in [idxBegin, idxBegin + numElements)
 bool
-pimCmdCond::computeRegion(unsigned index)
+pimCmdCond::computeElements(uint64_t idxBegin, uint64_t numElements)
 {
   const pimObjInfo& objBool = m_device->getResMgr()->getObjInfo(m_condBool);
   pimObjInfo& objDest = m_device->getResMgr()->getObjInfo(m_dest);
 
-  // perform the computation
-  const pimRegion& destRegion = objDest.getRegions()[index];
-  uint64_t elemIdxBegin = destRegion.getElemIdxBegin();
-  unsigned numElementsInRegion = destRegion.getNumElemInRegion();
+  // fast path: specialized kernel over contiguous raw element bits
+  bool isHandled = false;
+  bool status = computeRegionTyped(objBool, objDest, idxBegin, numElements, isHandled);
+  if (isHandled) {
+    return status;
+  }
+
   switch (m_cmdType) {
     case PimCmdEnum::COND_COPY: {
       const pimObjInfo& objSrc1 = m_device->getResMgr()->getObjInfo(m_src1);
-      for (unsigned j = 0; j < numElementsInRegion; ++j) {
-        uint64_t elemIdx = elemIdxBegin + j;
+      for (uint64_t j = 0; j < numElements; ++j) {
+        uint64_t elemIdx = idxBegin + j;
         uint64_t bitsBool = objBool.getElementBits(elemIdx);
         uint64_t bitsSrc1 = objSrc1.getElementBits(elemIdx);
         uint64_t bitsDest = objDest.getElementBits(elemIdx);
@@ -876,8 +1303,8 @@ pimCmdCond::computeRegion(unsigned index)
       break;
     }
     case PimCmdEnum::COND_BROADCAST: {
-      for (unsigned j = 0; j < numElementsInRegion; ++j) {
-        uint64_t elemIdx = elemIdxBegin + j;
+      for (uint64_t j = 0; j < numElements; ++j) {
+        uint64_t elemIdx = idxBegin + j;
         uint64_t bitsBool = objBool.getElementBits(elemIdx);
         uint64_t bitsDest = objDest.getElementBits(elemIdx);
         uint64_t bitsResult = bitsBool ? m_scalarBits : bitsDest;
@@ -888,8 +1315,8 @@ pimCmdCond::computeRegion(unsigned index)
     case PimCmdEnum::COND_SELECT: {
       const pimObjInfo& objSrc1 = m_device->getResMgr()->getObjInfo(m_src1);
       const pimObjInfo& objSrc2 = m_device->getResMgr()->getObjInfo(m_src2);
-      for (unsigned j = 0; j < numElementsInRegion; ++j) {
-        uint64_t elemIdx = elemIdxBegin + j;
+      for (uint64_t j = 0; j < numElements; ++j) {
+        uint64_t elemIdx = idxBegin + j;
         uint64_t bitsBool = objBool.getElementBits(elemIdx);
         uint64_t bitsSrc1 = objSrc1.getElementBits(elemIdx);
         uint64_t bitsSrc2 = objSrc2.getElementBits(elemIdx);
@@ -900,8 +1327,8 @@ pimCmdCond::computeRegion(unsigned index)
     }
     case PimCmdEnum::COND_SELECT_SCALAR: {
       const pimObjInfo& objSrc1 = m_device->getResMgr()->getObjInfo(m_src1);
-      for (unsigned j = 0; j < numElementsInRegion; ++j) {
-        uint64_t elemIdx = elemIdxBegin + j;
+      for (uint64_t j = 0; j < numElements; ++j) {
+        uint64_t elemIdx = idxBegin + j;
         uint64_t bitsBool = objBool.getElementBits(elemIdx);
         uint64_t bitsSrc1 = objSrc1.getElementBits(elemIdx);
         uint64_t bitsResult = bitsBool ? bitsSrc1 : m_scalarBits;
@@ -915,6 +1342,80 @@ pimCmdCond::computeRegion(unsigned index)
   return true;
 }
 
+//! @brief  PIM CMD: Conditional Operations - compute region with specialized kernels on raw element bits
+//!         Set isHandled to false if the command requires the generic per-element path
+bool
+pimCmdCond::computeRegionTyped(const pimObjInfo& objBool, pimObjInfo& objDest, uint64_t idxBegin, uint64_t numElements, bool& isHandled) const
+{
+  isHandled = false;
+  pimResMgr* resMgr = m_device->getResMgr();
+  const pimObjInfo* objSrc1 = (m_src1 != -1 ? &resMgr->getObjInfo(m_src1) : nullptr);
+  const pimObjInfo* objSrc2 = (m_src2 != -1 ? &resMgr->getObjInfo(m_src2) : nullptr);
+  unsigned bitsPerElement = objDest.getBitsPerElement(PimBitWidth::HOST);
+  // dual-contact refs negate bits per element
+  if (objBool.getRefObjId() != -1 || objDest.getRefObjId() != -1) {
+    return true;
+  }
+  for (const pimObjInfo* objSrc : { objSrc1, objSrc2 }) {
+    if (objSrc && (objSrc->getRefObjId() != -1 || objSrc->getBitsPerElement(PimBitWidth::HOST) != bitsPerElement)) {
+      return true;
+    }
+  }
+  PimSimdIsa isa = pimSim::get()->getConfig().getSimdIsa();
+  pimKernels::dispatchBitsType(bitsPerElement / 8, [&](auto bitsTag) {
+    using U = decltype(bitsTag);
+    const uint8_t* cond = objBool.getTypedData<uint8_t>();
+    const U* src1 = (objSrc1 ? objSrc1->getTypedData<U>() : nullptr);
+    const U* src2 = (objSrc2 ? objSrc2->getTypedData<U>() : nullptr);
+    U* dest = objDest.getTypedData<U>();
+    isHandled = true;
+    switch (m_cmdType) {
+      case PimCmdEnum::COND_COPY:
+        pimKernels::condKernel<PimCmdEnum::COND_COPY, U>(isa, cond, src1, src2, dest, idxBegin, numElements, m_scalarBits);
+        break;
+      case PimCmdEnum::COND_BROADCAST:
+        pimKernels::condKernel<PimCmdEnum::COND_BROADCAST, U>(isa, cond, src1, src2, dest, idxBegin, numElements, m_scalarBits);
+        break;
+      case PimCmdEnum::COND_SELECT:
+        pimKernels::condKernel<PimCmdEnum::COND_SELECT, U>(isa, cond, src1, src2, dest, idxBegin, numElements, m_scalarBits);
+        break;
+      case PimCmdEnum::COND_SELECT_SCALAR:
+        pimKernels::condKernel<PimCmdEnum::COND_SELECT_SCALAR, U>(isa, cond, src1, src2, dest, idxBegin, numElements, m_scalarBits);
+        break;
+      default:
+        isHandled = false;
+    }
+  });
+  return true;
+}
+
+//! @brief  PIM CMD: Conditional Operations - get objects read and written
+bool
+pimCmdCond::getObjAccess(std::vector<PimObjId>& readIds, std::vector<PimObjId>& writeIds) const
+{
+  readIds = { m_condBool, m_dest };  // dest is partially updated by some conditional operations
+  if (m_src1 != -1) {
+    readIds.push_back(m_src1);
+  }
+  if (m_src2 != -1) {
+    readIds.push_back(m_src2);
+  }
+  writeIds = { m_dest };
+  return true;
+}
+
+//! @brief  PIM CMD: Conditional Operations - performance and energy
+pimeval::perfEnergy
+pimCmdCond::getPerfEnergy() const
+{
+  const pimObjInfo& objDest = m_device->getResMgr()->getObjInfo(m_dest);
+  // Reuse func2 to calculate performance and energy
+  const pimPerfEnergyBase* model = pimSim::get()->getPerfEnergyModel();
+  return model->getMemoizedPerfEnergy(pimeval::perfEnergyKey(m_cmdType, objDest, objDest.getDataType()), [&]() {
+    return model->getPerfEnergyForFunc2(m_cmdType, objDest, objDest, objDest);
+  });
+}
+
 //! @brief  PIM CMD: Conditional Operations - update stats
 bool
 pimCmdCond::updateStats() const
@@ -923,9 +1424,8 @@ pimCmdCond::updateStats() const
   PimDataType dataType = objDest.getDataType();
   bool isVLayout = objDest.isVLayout();
 
-  // Reuse func2 to calculate performance and energy
-  pimeval::perfEnergy mPerfEnergy = pimSim::get()->getPerfEnergyModel()->getPerfEnergyForFunc2(m_cmdType, objDest, objDest, objDest);
-  pimSim::get()->getStatsMgr()->recordCmd(getName(dataType, isVLayout), mPerfEnergy);
+  pimSim::get()->getStatsMgr()->recordCmd(m_cmdType, dataType, isVLayout, getPerfEnergy());
+  recordKernelThroughput(dataType, isVLayout, objDest.getNumElements());
   return true;
 }
  
@@ -966,115 +1466,140 @@ pimCmdReduction<T>::execute()
     objSrc.syncFromSimulatedMem();
   }
 
-  unsigned numRegions = objSrc.getRegions().size();
-
-  // prepare per-region storage
-  //reduction
-  for (unsigned i = 0; i < numRegions; ++i) {
-    if (m_cmdType == PimCmdEnum::REDSUM || m_cmdType == PimCmdEnum::REDSUM_RANGE) {
-      m_regionResult.resize(numRegions, 0);
-    } else if (m_cmdType == PimCmdEnum::REDMIN || m_cmdType == PimCmdEnum::REDMIN_RANGE) {
-      m_regionResult.resize(numRegions, std::numeric_limits<T>::max());
-    } else if (m_cmdType == PimCmdEnum::REDMAX || m_cmdType == PimCmdEnum::REDMAX_RANGE) {
-      m_regionResult.resize(numRegions, std::numeric_limits<T>::lowest());
-    }
-  }
-
-  computeAllRegions(numRegions);
-  
-  //reduction
-  for (unsigned i = 0; i < numRegions; ++i) {
-    if (m_cmdType == PimCmdEnum::REDSUM || m_cmdType == PimCmdEnum::REDSUM_RANGE) {
-      if (std::is_integral_v<T> && std::is_signed_v<T>)
-      {
-        *static_cast<int64_t *>(m_result) += static_cast<int64_t>(m_regionResult[i]);
-      }
-      else if (std::is_integral_v<T> && std::is_unsigned_v<T>)
-      {
-        *static_cast<uint64_t *>(m_result) += static_cast<uint64_t>(m_regionResult[i]);
-      }
-      else
-      {
-        *static_cast<float *>(m_result) += static_cast<float>(m_regionResult[i]);
-      }
+  T result = combinePartials();
+  if (m_cmdType == PimCmdEnum::REDSUM || m_cmdType == PimCmdEnum::REDSUM_RANGE) {
+    if (std::is_integral_v<T> && std::is_signed_v<T>)
+    {
+      *static_cast<int64_t *>(m_result) += static_cast<int64_t>(result);
     }
-    else if (m_cmdType == PimCmdEnum::REDMIN || m_cmdType == PimCmdEnum::REDMIN_RANGE)
+    else if (std::is_integral_v<T> && std::is_unsigned_v<T>)
     {
-      *static_cast<T *>(m_result) = *static_cast<T *>(m_result) > static_cast<T>(m_regionResult[i]) ? static_cast<T>(m_regionResult[i]) : *static_cast<T *>(m_result);
+      *static_cast<uint64_t *>(m_result) += static_cast<uint64_t>(result);
     }
-    else if (m_cmdType == PimCmdEnum::REDMAX || m_cmdType == PimCmdEnum::REDMAX_RANGE)
+    else
     {
-      *static_cast<T *>(m_result) = *static_cast<T *>(m_result) < static_cast<T>(m_regionResult[i]) ? static_cast<T>(m_regionResult[i]) : *static_cast<T *>(m_result);
+      *static_cast<float *>(m_result) += static_cast<float>(result);
     }
+  } else {
+    *static_cast<T *>(m_result) = combine(*static_cast<T *>(m_result), result);
   }
 
   updateStats();
   return true;
 }
 
-template <typename T> bool
-pimCmdReduction<T>::computeRegion(unsigned index)
+//! @brief  PIM CMD: Reduction - identity value of the reduction operation
+template <typename T> T
+pimCmdReduction<T>::getIdentity() const
+{
+  if (m_cmdType == PimCmdEnum::REDMIN || m_cmdType == PimCmdEnum::REDMIN_RANGE) {
+    return std::numeric_limits<T>::max();
+  } else if (m_cmdType == PimCmdEnum::REDMAX || m_cmdType == PimCmdEnum::REDMAX_RANGE) {
+    return std::numeric_limits<T>::lowest();
+  }
+  return 0;
+}
+
+//! @brief  PIM CMD: Reduction - combine two values with the reduction operation
+template <typename T> T
+pimCmdReduction<T>::combine(T val1, T val2) const
+{
+  if (m_cmdType == PimCmdEnum::REDMIN || m_cmdType == PimCmdEnum::REDMIN_RANGE) {
+    return val1 > val2 ? val2 : val1;
+  } else if (m_cmdType == PimCmdEnum::REDMAX || m_cmdType == PimCmdEnum::REDMAX_RANGE) {
+    return val1 < val2 ? val2 : val1;
+  }
+  return val1 + val2;
+}
+
+//! @brief  PIM CMD: Reduction - compute partial result of elements in [idxBegin, idxEnd)
+template <typename T> T
+pimCmdReduction<T>::computePartial(uint64_t idxBegin, uint64_t idxEnd) const
 {
   const pimObjInfo& objSrc = m_device->getResMgr()->getObjInfo(m_src);
-  const pimRegion& srcRegion = objSrc.getRegions()[index];
   PimDataType dataType = objSrc.getDataType();
-  unsigned numElementsInRegion = srcRegion.getNumElemInRegion();
-  uint64_t currIdx = srcRegion.getElemIdxBegin();
-
-  for (unsigned j = 0; j < numElementsInRegion && currIdx < m_idxEnd; ++j) {
-    if (currIdx >= m_idxBegin) {
-      uint64_t operandBits = objSrc.getElementBits(currIdx);
-      bool isFP = pimUtils::isFP(dataType);
-      bool isSigned = pimUtils::isSigned(dataType);
-      if (!isFP)
-      {
-        T integerOperand;
-        if (isSigned)
-        {
-          integerOperand = pimUtils::signExt(operandBits, dataType);
-        }
-        else
-        {
-          integerOperand = static_cast<T>(operandBits);
+  T result = getIdentity();
+
+  // fast path: typed span of the data holder, with operation selected outside of the loop
+  bool isHandled = false;
+  if (objSrc.getRefObjId() == -1) {
+    pimKernels::dispatchDataType(dataType, [&](auto typeTag) {
+      using E = decltype(typeTag);
+      const E* src = objSrc.getTypedData<E>();
+      if (m_cmdType == PimCmdEnum::REDMIN || m_cmdType == PimCmdEnum::REDMIN_RANGE) {
+        for (uint64_t i = idxBegin; i < idxEnd; ++i) {
+          T val = static_cast<T>(src[i]);
+          result = result > val ? val : result;
         }
-
-        if (m_cmdType == PimCmdEnum::REDSUM || m_cmdType == PimCmdEnum::REDSUM_RANGE)
-        {
-          m_regionResult[index] += integerOperand;
-        }
-        else if (m_cmdType == PimCmdEnum::REDMIN || m_cmdType == PimCmdEnum::REDMIN_RANGE)
-        {
-          m_regionResult[index] = m_regionResult[index] > integerOperand ? integerOperand : m_regionResult[index];
-        }
-        else if (m_cmdType == PimCmdEnum::REDMAX || m_cmdType == PimCmdEnum::REDMAX_RANGE)
-        {
-          m_regionResult[index] = m_regionResult[index] < integerOperand ? integerOperand : m_regionResult[index];
-        }
-      }
-      else if (isFP)
-      {
-        float floatOperand = pimUtils::castBitsToType<float>(operandBits);
-        if (m_cmdType == PimCmdEnum::REDSUM || m_cmdType == PimCmdEnum::REDSUM_RANGE)
-        {
-          m_regionResult[index] += floatOperand;
+      } else if (m_cmdType == PimCmdEnum::REDMAX || m_cmdType == PimCmdEnum::REDMAX_RANGE) {
+        for (uint64_t i = idxBegin; i < idxEnd; ++i) {
+          T val = static_cast<T>(src[i]);
+          result = result < val ? val : result;
         }
-        else if (m_cmdType == PimCmdEnum::REDMIN || m_cmdType == PimCmdEnum::REDMIN_RANGE)
-        {
-          m_regionResult[index] = m_regionResult[index] > floatOperand ? floatOperand : m_regionResult[index];
-        }
-        else if (m_cmdType == PimCmdEnum::REDMAX || m_cmdType == PimCmdEnum::REDMAX_RANGE)
-        {
-          m_regionResult[index] = m_regionResult[index] < floatOperand ? floatOperand : m_regionResult[index];
+      } else {
+        for (uint64_t i = idxBegin; i < idxEnd; ++i) {
+          result += static_cast<T>(src[i]);
         }
       }
-      else
-      {
-        assert(0); // Unexpected data type
-      }
+      isHandled = true;
+    });
+  }
+  if (isHandled) {
+    return result;
+  }
+
+  for (uint64_t i = idxBegin; i < idxEnd; ++i) {
+    uint64_t operandBits = objSrc.getElementBits(i);
+    T operand;
+    if (pimUtils::isFP(dataType)) {
+      operand = pimUtils::castBitsToType<float>(operandBits);
+    } else if (pimUtils::isSigned(dataType)) {
+      operand = pimUtils::signExt(operandBits, dataType);
+    } else {
+      operand = static_cast<T>(operandBits);
     }
-    currIdx += 1;
+    result = combine(result, operand);
   }
-  return true;
+  return result;
+}
+
+//! @brief  PIM CMD: Reduction - compute partial results of fixed-size chunks in MT, then combine
+//!         them with a pairwise tree. Chunk size does not depend on number of threads, so that FP
+//!         results are reproducible
+template <typename T> T
+pimCmdReduction<T>::combinePartials()
+{
+  const pimObjInfo& objSrc = m_device->getResMgr()->getObjInfo(m_src);
+  uint64_t idxBegin = std::min(m_idxBegin, objSrc.getNumElements());
+  uint64_t idxEnd = std::min(m_idxEnd, objSrc.getNumElements());
+  if (idxBegin >= idxEnd) {
+    return getIdentity();
+  }
+
+  // partial results per chunk, padded to cache lines
+  uint64_t chunkBytes = pimSim::get()->getConfig().getTaskChunkSize();
+  unsigned bytesPerElement = std::max(1u, objSrc.getBitsPerElement(PimBitWidth::HOST) / 8);
+  uint64_t chunkSize = std::max<uint64_t>(s_minElementsPerChunk, chunkBytes / bytesPerElement / 64 * 64);
+  uint64_t numChunks = (idxEnd - idxBegin + chunkSize - 1) / chunkSize;
+  m_partialResult.assign(numChunks, pimUtils::cacheLinePadded<T>{getIdentity()});
+  runInParallel(numChunks, 1, [&](uint64_t chunkBegin, uint64_t chunkEnd) {
+    for (uint64_t i = chunkBegin; i < chunkEnd; ++i) {
+      uint64_t elemBegin = idxBegin + i * chunkSize;
+      m_partialResult[i].m_val = computePartial(elemBegin, std::min(elemBegin + chunkSize, idxEnd));
+    }
+  });
+
+  // pairwise tree combine, with each level processed in MT
+  for (uint64_t stride = 1; stride < numChunks; stride *= 2) {
+    uint64_t numPairs = (numChunks - stride + 2 * stride - 1) / (2 * stride);
+    runInParallel(numPairs, s_minElementsPerChunk, [&](uint64_t pairBegin, uint64_t pairEnd) {
+      for (uint64_t i = pairBegin; i < pairEnd; ++i) {
+        uint64_t idx = i * 2 * stride;
+        m_partialResult[idx].m_val = combine(m_partialResult[idx].m_val, m_partialResult[idx + stride].m_val);
+      }
+    });
+  }
+  return m_partialResult[0].m_val;
 }
 
 template <typename T> bool
@@ -1089,7 +1614,8 @@ pimCmdReduction<T>::updateStats() const
     // determine numPass for ranged reduction
     std::unordered_map<PimCoreId, unsigned> activeRegionPerCore;
     uint64_t index = 0;
-    for (const auto& region : objSrc.getRegions()) {
+    for (uint64_t regionIdx = 0; regionIdx < objSrc.getNumRegions(); ++regionIdx) {
+      const pimRegion region = objSrc.getRegion(regionIdx);
       PimCoreId coreId = region.getCoreId();
       unsigned numElementsInRegion = region.getNumElemInRegion();
       bool isActive = index < m_idxEnd && index + numElementsInRegion - 1 >= m_idxBegin;
@@ -1107,8 +1633,11 @@ pimCmdReduction<T>::updateStats() const
     numPass = objSrc.getMaxNumRegionsPerCore();
   }
 
-  pimeval::perfEnergy mPerfEnergy = pimSim::get()->getPerfEnergyModel()->getPerfEnergyForReduction(m_cmdType, objSrc, numPass);
-  pimSim::get()->getStatsMgr()->recordCmd(getName(dataType, isVLayout), mPerfEnergy);
+  const pimPerfEnergyBase* model = pimSim::get()->getPerfEnergyModel();
+  pimeval::perfEnergy mPerfEnergy = model->getMemoizedPerfEnergy(pimeval::perfEnergyKey(m_cmdType, objSrc, dataType, numPass), [&]() {
+    return model->getPerfEnergyForReduction(m_cmdType, objSrc, numPass);
+  });
+  pimSim::get()->getStatsMgr()->recordCmd(m_cmdType, dataType, isVLayout, mPerfEnergy);
   return true;
 }
 
@@ -1124,17 +1653,10 @@ pimCmdBroadcast::execute()
     return false;
   }
 
-  const pimObjInfo& objDest = m_device->getResMgr()->getObjInfo(m_dest);
-  unsigned numRegions = objDest.getRegions().size();
-  computeAllRegions(numRegions);
-
-  if (pimSim::get()->getDeviceType() != PIM_FUNCTIONAL) {
-    const pimObjInfo &objDest = m_device->getResMgr()->getObjInfo(m_dest);
-    objDest.syncToSimulatedMem();
-  }
+  // all elements are overwritten, so a recycled data buffer needs no zero-fill
+  m_device->getResMgr()->getObjInfo(m_dest).discardDataForOverwrite();
 
-  updateStats();
-  return true;
+  return executeElementWise();
 }
 
 //! @brief  PIM CMD: broadcast a value to all elements - sanity check
@@ -1148,22 +1670,39 @@ pimCmdBroadcast::sanityCheck() const
   return true;
 }
 
-//! @brief  PIM CMD: broadcast a value to all elements - compute region
+//! @brief  PIM CMD: broadcast a value to all elements - get element-wise operands
 bool
-pimCmdBroadcast::computeRegion(unsigned index)
+pimCmdBroadcast::getElementWiseInfo(pimElementWiseInfo& info) const
 {
-  pimObjInfo& objDest = m_device->getResMgr()->getObjInfo(m_dest);
-  const pimRegion& destRegion = objDest.getRegions()[index];
-
-  uint64_t elemIdxBegin = destRegion.getElemIdxBegin();
-  unsigned numElementsInRegion = destRegion.getNumElemInRegion();
+  const pimObjInfo& objDest = m_device->getResMgr()->getObjInfo(m_dest);
+  info.m_destId = m_dest;
+  info.m_numElements = objDest.getNumElements();
+  info.m_bytesPerElement = objDest.getBitsPerElement(PimBitWidth::HOST) / 8;
+  return true;
+}
 
-  for (unsigned j = 0; j < numElementsInRegion; ++j) {
-    objDest.setElement(elemIdxBegin + j, m_signExtBits);
+//! @brief  PIM CMD: broadcast a value to all elements - compute elements in [idxBegin, idxBegin + numElements)
+bool
+pimCmdBroadcast::computeElements(uint64_t idxBegin, uint64_t numElements)
+{
+  pimObjInfo& objDest = m_device->getResMgr()->getObjInfo(m_dest);
+  for (uint64_t j = 0; j < numElements; ++j) {
+    objDest.setElement(idxBegin + j, m_signExtBits);
   }
   return true;
 }
 
+//! @brief  PIM CMD: broadcast a value to all elements - performance and energy
+pimeval::perfEnergy
+pimCmdBroadcast::getPerfEnergy() const
+{
+  const pimObjInfo& objDest = m_device->getResMgr()->getObjInfo(m_dest);
+  const pimPerfEnergyBase* model = pimSim::get()->getPerfEnergyModel();
+  return model->getMemoizedPerfEnergy(pimeval::perfEnergyKey(m_cmdType, objDest, objDest.getDataType()), [&]() {
+    return model->getPerfEnergyForBroadcast(m_cmdType, objDest);
+  });
+}
+
 //! @brief  PIM CMD: broadcast a value to all elements - update stats
 bool
 pimCmdBroadcast::updateStats() const
@@ -1172,8 +1711,7 @@ pimCmdBroadcast::updateStats() const
   PimDataType dataType = objDest.getDataType();
   bool isVLayout = objDest.isVLayout();
 
-  pimeval::perfEnergy mPerfEnergy = pimSim::get()->getPerfEnergyModel()->getPerfEnergyForBroadcast(m_cmdType, objDest);
-  pimSim::get()->getStatsMgr()->recordCmd(getName(dataType, isVLayout), mPerfEnergy);
+  pimSim::get()->getStatsMgr()->recordCmd(m_cmdType, dataType, isVLayout, getPerfEnergy());
   return true;
 }
 
@@ -1196,15 +1734,21 @@ pimCmdRotate::execute()
   }
 
   pimObjInfo& objSrc = m_device->getResMgr()->getObjInfo(m_src);
-  unsigned numRegions = objSrc.getRegions().size();
+  unsigned numRegions = objSrc.getNumRegions();
   m_regionBoundary.resize(numRegions, 0);
 
   computeAllRegions(numRegions);
 
+  // no data to move across region boundaries in analysis mode
+  if (pimSim::get()->isAnalysisMode()) {
+    updateStats();
+    return true;
+  }
+
   // handle region boundaries
   if (m_cmdType == PimCmdEnum::ROTATE_ELEM_R || m_cmdType == PimCmdEnum::SHIFT_ELEM_R) {
     for (unsigned i = 0; i < numRegions; ++i) {
-      const pimRegion &srcRegion = objSrc.getRegions()[i];
+      const pimRegion srcRegion = objSrc.getRegion(i);
       uint64_t elemIdxBegin = srcRegion.getElemIdxBegin();
       uint64_t val = 0;
       if (i == 0 && m_cmdType == PimCmdEnum::ROTATE_ELEM_R) {
@@ -1216,7 +1760,7 @@ pimCmdRotate::execute()
     }
   } else if (m_cmdType == PimCmdEnum::ROTATE_ELEM_L || m_cmdType == PimCmdEnum::SHIFT_ELEM_L) {
     for (unsigned i = 0; i < numRegions; ++i) {
-      const pimRegion &srcRegion = objSrc.getRegions()[i];
+      const pimRegion srcRegion = objSrc.getRegion(i);
       unsigned numElementsInRegion = srcRegion.getNumElemInRegion();
       uint64_t elemIdxBegin = srcRegion.getElemIdxBegin();
       uint64_t val = 0;
@@ -1232,7 +1776,8 @@ pimCmdRotate::execute()
   }
 
   if (pimSim::get()->getDeviceType() != PIM_FUNCTIONAL) {
-    const pimObjInfo &objSrc = m_device->getResMgr()->getObjInfo(m_src);
+    pimObjInfo &objSrc = m_device->getResMgr()->getObjInfo(m_src);
+    objSrc.markDataHolderModified();
     objSrc.syncToSimulatedMem();
   }
 
@@ -1257,7 +1802,7 @@ pimCmdRotate::computeRegion(unsigned index)
 {
   pimObjInfo& objSrc = m_device->getResMgr()->getObjInfo(m_src);
 
-  const pimRegion& srcRegion = objSrc.getRegions()[index];
+  const pimRegion srcRegion = objSrc.getRegion(index);
 
   // read out values
   uint64_t elemIdxBegin = srcRegion.getElemIdxBegin();
@@ -1303,8 +1848,11 @@ pimCmdRotate::updateStats() const
   PimDataType dataType = objSrc.getDataType();
   bool isVLayout = objSrc.isVLayout();
 
-  pimeval::perfEnergy mPerfEnergy = pimSim::get()->getPerfEnergyModel()->getPerfEnergyForRotate(m_cmdType, objSrc);
-  pimSim::get()->getStatsMgr()->recordCmd(getName(dataType, isVLayout), mPerfEnergy);
+  const pimPerfEnergyBase* model = pimSim::get()->getPerfEnergyModel();
+  pimeval::perfEnergy mPerfEnergy = model->getMemoizedPerfEnergy(pimeval::perfEnergyKey(m_cmdType, objSrc, dataType), [&]() {
+    return model->getPerfEnergyForRotate(m_cmdType, objSrc);
+  });
+  pimSim::get()->getStatsMgr()->recordCmd(m_cmdType, dataType, isVLayout, mPerfEnergy);
   return true;
 }
 
@@ -1353,10 +1901,8 @@ pimCmdMAC<T>::execute()
     objSrc2.syncFromSimulatedMem();
   }
 
-  unsigned numRegions = objSrc1.getRegions().size();
-  for (unsigned i = 0; i < numRegions; ++i) {
-    m_regionResult.resize(numRegions, 0);
-  }
+  unsigned numRegions = objSrc1.getNumRegions();
+  m_regionResult.assign(numRegions, pimUtils::cacheLinePadded<T>{0});
   computeAllRegions(numRegions);
   
   //reduction
@@ -1366,16 +1912,16 @@ pimCmdMAC<T>::execute()
       switch (objSrc1.getDataType())
       {
       case PIM_INT8:
-        static_cast<int8_t *>(m_dest)[objSrc1.getRegions()[i].getCoreId()] += static_cast<int8_t>(m_regionResult[i]);
+        static_cast<int8_t *>(m_dest)[objSrc1.getRegion(i).getCoreId()] += static_cast<int8_t>(m_regionResult[i].m_val);
         break;
       case PIM_INT16:
-        static_cast<int16_t *>(m_dest)[objSrc1.getRegions()[i].getCoreId()] += static_cast<int16_t>(m_regionResult[i]);
+        static_cast<int16_t *>(m_dest)[objSrc1.getRegion(i).getCoreId()] += static_cast<int16_t>(m_regionResult[i].m_val);
         break;
       case PIM_INT32:
-        static_cast<int32_t *>(m_dest)[objSrc1.getRegions()[i].getCoreId()] += static_cast<int32_t>(m_regionResult[i]);
+        static_cast<int32_t *>(m_dest)[objSrc1.getRegion(i).getCoreId()] += static_cast<int32_t>(m_regionResult[i].m_val);
         break;
       case PIM_INT64:
-        static_cast<int64_t *>(m_dest)[objSrc1.getRegions()[i].getCoreId()] += static_cast<int64_t>(m_regionResult[i]);
+        static_cast<int64_t *>(m_dest)[objSrc1.getRegion(i).getCoreId()] += static_cast<int64_t>(m_regionResult[i].m_val);
         break;
       default:
         break;
@@ -1386,16 +1932,16 @@ pimCmdMAC<T>::execute()
       switch (objSrc1.getDataType())
       {
       case PIM_UINT8:
-        static_cast<int8_t *>(m_dest)[objSrc1.getRegions()[i].getCoreId()] += static_cast<int8_t>(m_regionResult[i]);
+        static_cast<int8_t *>(m_dest)[objSrc1.getRegion(i).getCoreId()] += static_cast<int8_t>(m_regionResult[i].m_val);
         break;
       case PIM_UINT16:
-        static_cast<int16_t *>(m_dest)[objSrc1.getRegions()[i].getCoreId()] += static_cast<int16_t>(m_regionResult[i]);
+        static_cast<int16_t *>(m_dest)[objSrc1.getRegion(i).getCoreId()] += static_cast<int16_t>(m_regionResult[i].m_val);
         break;
       case PIM_UINT32:
-        static_cast<int32_t *>(m_dest)[objSrc1.getRegions()[i].getCoreId()] += static_cast<int32_t>(m_regionResult[i]);
+        static_cast<int32_t *>(m_dest)[objSrc1.getRegion(i).getCoreId()] += static_cast<int32_t>(m_regionResult[i].m_val);
         break;
       case PIM_UINT64:
-        static_cast<int64_t *>(m_dest)[objSrc1.getRegions()[i].getCoreId()] += static_cast<int64_t>(m_regionResult[i]);
+        static_cast<int64_t *>(m_dest)[objSrc1.getRegion(i).getCoreId()] += static_cast<int64_t>(m_regionResult[i].m_val);
         break;
       default:
         break;
@@ -1403,7 +1949,7 @@ pimCmdMAC<T>::execute()
     }
     else
     {
-      static_cast<float *>(m_dest)[objSrc1.getRegions()[i].getCoreId()] += static_cast<float>(m_regionResult[i]);
+      static_cast<float *>(m_dest)[objSrc1.getRegion(i).getCoreId()] += static_cast<float>(m_regionResult[i].m_val);
     }
   }
   updateStats();
@@ -1417,7 +1963,7 @@ pimCmdMAC<T>::computeRegion(unsigned index)
   const pimObjInfo& objSrc1 = m_device->getResMgr()->getObjInfo(m_src1);
   const pimObjInfo& objSrc2 = m_device->getResMgr()->getObjInfo(m_src2);
 
-  const pimRegion& src1Region = objSrc1.getRegions()[index];
+  const pimRegion src1Region = objSrc1.getRegion(index);
   PimDataType dataType = objSrc1.getDataType();
   uint64_t elemIdxBegin = src1Region.getElemIdxBegin();
   unsigned numElementsInRegion = src1Region.getNumElemInRegion();
@@ -1429,17 +1975,17 @@ pimCmdMAC<T>::computeRegion(unsigned index)
       uint64_t operandBits2 = objSrc2.getElementBits(j);
       int64_t operand1 = pimUtils::signExt(operandBits1, dataType);
       int64_t operand2 = pimUtils::signExt(operandBits2, dataType);
-      m_regionResult[index] += operand1 * operand2;
+      m_regionResult[index].m_val += operand1 * operand2;
     } else if (pimUtils::isUnsigned(dataType)) {
       uint64_t unsignedOperand1 = objSrc1.getElementBits(elemIdx);
       uint64_t unsignedOperand2 = objSrc2.getElementBits(elemIdx);
-      m_regionResult[index] += unsignedOperand1 * unsignedOperand2;
+      m_regionResult[index].m_val += unsignedOperand1 * unsignedOperand2;
     } else if (pimUtils::isFP(dataType)) {
       uint64_t operandBits1 = objSrc1.getElementBits(elemIdx);
       uint64_t operandBits2 = objSrc2.getElementBits(elemIdx);
       float floatOperand1 = pimUtils::castBitsToType<float>(operandBits1);
       float floatOperand2 = pimUtils::castBitsToType<float>(operandBits2);
-      m_regionResult[index] += floatOperand1 * floatOperand2;
+      m_regionResult[index].m_val += floatOperand1 * floatOperand2;
     } else {
       assert(0); // todo: data type
     }
@@ -1453,8 +1999,11 @@ pimCmdMAC<T>::updateStats() const
   const pimObjInfo& objSrc = m_device->getResMgr()->getObjInfo(m_src1);
   PimDataType dataType = objSrc.getDataType();
   bool isVLayout = objSrc.isVLayout();
-  pimeval::perfEnergy mPerfEnergy = pimSim::get()->getPerfEnergyModel()->getPerfEnergyForMac(m_cmdType, objSrc);
-  pimSim::get()->getStatsMgr()->recordCmd(getName(dataType, isVLayout), mPerfEnergy);
+  const pimPerfEnergyBase* model = pimSim::get()->getPerfEnergyModel();
+  pimeval::perfEnergy mPerfEnergy = model->getMemoizedPerfEnergy(pimeval::perfEnergyKey(m_cmdType, objSrc, dataType), [&]() {
+    return model->getPerfEnergyForMac(m_cmdType, objSrc);
+  });
+  pimSim::get()->getStatsMgr()->recordCmd(m_cmdType, dataType, isVLayout, mPerfEnergy);
   return true;
 }
 
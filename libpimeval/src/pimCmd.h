@@ -7,7 +7,7 @@
 #include "libpimeval.h"      // for PimDataType, PimObjId
 #include "pimResMgr.h"       // for pimResMgr, pimObjInfo
 #include "pimCore.h"         // for pimCore
-#include "pimUtils.h"        // for pimDataTypeEnumToStr, threadWorker
+#include "pimUtils.h"        // for pimDataTypeEnumToStr, threadPool
 #include <vector>            // for vector
 #include <string>            // for string
 #include <climits>           // for numeric_limits
@@ -16,6 +16,8 @@
 #include <variant>
 
 class pimDevice;
+class pimCmdFuse;
+namespace pimeval { class perfEnergy; }
 
 enum class PimCmdEnum {
   NOOP = 0,
@@ -83,6 +85,17 @@ enum class PimCmdEnum {
   AES_INVERSE_SBOX,
   PREFIX_SUM,
   MAC,
+  CMD_ENUM_MAX,  // number of command types, keep as the last entry
+};
+
+//! @struct pimElementWiseInfo
+//! @brief  Operands of an element-wise command, where element i of dest only depends on element i of sources
+struct pimElementWiseInfo
+{
+  std::vector<PimObjId> m_srcIds;  // objects read by the command, including dest if it is partially updated
+  PimObjId m_destId = -1;
+  uint64_t m_numElements = 0;
+  unsigned m_bytesPerElement = 0;  // host bytes accessed per element, for task partitioning
 };
 
 
@@ -90,12 +103,19 @@ enum class PimCmdEnum {
 //! @brief  Pim command base class
 class pimCmd
 {
+  friend class pimCmdFuse;
 public:
   pimCmd(PimCmdEnum cmdType);
   virtual ~pimCmd() {}
 
   void setDevice(pimDevice* device) { m_device = device; }
+  PimCmdEnum getCmdType() const { return m_cmdType; }
   virtual bool execute() = 0;
+  virtual bool isElementWise() const { return false; }
+  virtual bool getElementWiseInfo(pimElementWiseInfo& info) const { return false; }
+  virtual pimeval::perfEnergy getPerfEnergy() const;
+  //! @brief  Get objects read and written by the command. Return false if unknown
+  virtual bool getObjAccess(std::vector<PimObjId>& readIds, std::vector<PimObjId>& writeIds) const { return false; }
 
   std::string getName() const {
     return getName(m_cmdType, "");
@@ -117,8 +137,14 @@ protected:
 
   virtual bool sanityCheck() const { return false; }
   virtual bool computeRegion(unsigned index) { return false; }
+  virtual bool computeElements(uint64_t idxBegin, uint64_t numElements) { return false; }
   virtual bool updateStats() const { return false; }
   bool computeAllRegions(unsigned numRegions);
+  bool computeAllElements(uint64_t numElements, unsigned bytesPerElement);
+  uint64_t getElementGrainSize(uint64_t numElements, unsigned bytesPerElement) const;
+  bool executeElementWise();
+  void recordKernelThroughput(const std::string& cmdName, uint64_t numElements) const;
+  void recordKernelThroughput(PimDataType dataType, bool isVLayout, uint64_t numElements) const;
 
   //! @brief  Utility: Get bits of an element from a region. The bits are stored as uint64_t without sign extension
   inline uint64_t getBits(const pimCore& core, bool isVLayout, unsigned rowLoc, unsigned colLoc, unsigned numBits) const
@@ -138,21 +164,12 @@ protected:
 
   PimCmdEnum m_cmdType;
   pimDevice* m_device = nullptr;
+  double m_msKernelElapsed = 0.0;  // host time of computeAllRegions in benchmark mode
   bool m_debugCmds;
 
-  //! @class  pimCmd::regionWorker
-  //! @brief  Thread worker to process regions in parallel
-  class regionWorker : public pimUtils::threadWorker {
-  public:
-    regionWorker(pimCmd* cmd, unsigned regionIdx) : m_cmd(cmd), m_regionIdx(regionIdx) {}
-    virtual ~regionWorker() {}
-    virtual void execute() {
-      m_cmd->computeRegion(m_regionIdx);
-    }
-  private:
-    pimCmd* m_cmd = nullptr;
-    unsigned m_regionIdx = 0;
-  };
+  static constexpr uint64_t s_numChunksPerThread = 8;     // region batches per thread for load balancing
+  static constexpr uint64_t s_minElementsPerChunk = 1024; // avoid tasks smaller than scheduling overhead
+  void runInParallel(uint64_t numItems, uint64_t grainSize, const pimUtils::threadPool::rangeFunc& func);
 };
 
 //! @class  pimCmdDataTransfer
@@ -166,10 +183,16 @@ public:
     : pimCmd(PimCmdEnum::COPY_D2H), m_copyType(copyType), m_ptr(dest), m_src(src), m_idxBegin(idxBegin), m_idxEnd(idxEnd), m_copyFullRange(idxEnd == 0ULL) {}
   pimCmdCopy(PimCmdEnum cmdType, PimCopyEnum copyType, PimObjId src, PimObjId dest, uint64_t idxBegin = 0, uint64_t idxEnd = 0)
     : pimCmd(PimCmdEnum::COPY_D2D), m_copyType(copyType), m_src(src), m_dest(dest), m_idxBegin(idxBegin), m_idxEnd(idxEnd), m_copyFullRange(idxEnd == 0ULL) {}
+  // host-device copy with a strided host layout
+  pimCmdCopy(PimCmdEnum cmdType, PimCopyEnum copyType, void* src, const pimHostLayout& srcLayout, PimObjId dest, uint64_t idxBegin = 0, uint64_t idxEnd = 0)
+    : pimCmdCopy(cmdType, copyType, src, dest, idxBegin, idxEnd) { m_hostLayout = srcLayout; m_isHostStrided = true; }
+  pimCmdCopy(PimCmdEnum cmdType, PimCopyEnum copyType, PimObjId src, void* dest, const pimHostLayout& destLayout, uint64_t idxBegin = 0, uint64_t idxEnd = 0)
+    : pimCmdCopy(cmdType, copyType, src, dest, idxBegin, idxEnd) { m_hostLayout = destLayout; m_isHostStrided = true; }
 
   virtual ~pimCmdCopy() {}
   virtual bool execute() override;
   virtual bool sanityCheck() const override;
+  virtual bool getObjAccess(std::vector<PimObjId>& readIds, std::vector<PimObjId>& writeIds) const override;
   virtual bool updateStats() const override;
 protected:
   PimCopyEnum m_copyType;
@@ -179,6 +202,26 @@ protected:
   uint64_t m_idxBegin = 0;
   uint64_t m_idxEnd = 0; 
   bool m_copyFullRange = false;
+  pimHostLayout m_hostLayout;
+  bool m_isHostStrided = false;
+};
+
+//! @class  pimCmdCopyBatch
+//! @brief  Pim CMD: Host-device data copy of multiple ranges as one command
+class pimCmdCopyBatch : public pimCmd
+{
+public:
+  pimCmdCopyBatch(PimCmdEnum cmdType, const PimCopyDesc* descs, uint64_t numDescs)
+    : pimCmd(cmdType), m_descs(descs, descs + numDescs) {}
+
+  virtual ~pimCmdCopyBatch() {}
+  virtual bool execute() override;
+  virtual bool sanityCheck() const override;
+  virtual bool getObjAccess(std::vector<PimObjId>& readIds, std::vector<PimObjId>& writeIds) const override;
+  virtual bool updateStats() const override;
+protected:
+  uint64_t getNumElements(const PimCopyDesc& desc) const;
+  std::vector<PimCopyDesc> m_descs;
 };
 
 //! @class  pimCmdFunc1
@@ -193,7 +236,15 @@ public:
   virtual ~pimCmdFunc1() {}
   virtual bool execute() override;
   virtual bool sanityCheck() const override;
-  virtual bool computeRegion(unsigned index) override;
+  virtual bool isElementWise() const override { return true; }
+  virtual bool getElementWiseInfo(pimElementWiseInfo& info) const override;
+  virtual bool computeElements(uint64_t idxBegin, uint64_t numElements) override;
+  virtual pimeval::perfEnergy getPerfEnergy() const override;
+  virtual bool getObjAccess(std::vector<PimObjId>& readIds, std::vector<PimObjId>& writeIds) const override {
+    readIds = { m_src };
+    writeIds = { m_dest };
+    return true;
+  }
   virtual bool updateStats() const override;
 protected:
   PimObjId m_src;
@@ -306,6 +357,8 @@ private:
     return true;
   }
 
+  bool computeRegionTyped(const pimObjInfo& objSrc, pimObjInfo& objDest, uint64_t idxBegin, uint64_t numElements, bool& isHandled) const;
+  template <typename T> bool computeSpanTyped(const T* src, pimObjInfo& objDest, uint64_t idxBegin, uint64_t numElements, bool& isHandled) const;
   bool convertType(const pimObjInfo& objSrc, pimObjInfo& objDest, uint64_t elemIdx) const;
   bool bitSliceExtract(const pimObjInfo& objSrc, pimObjInfo& objDestBool, uint64_t bitIdx, uint64_t elemIdx) const;
   bool bitSliceInsert(const pimObjInfo& objSrcBool, pimObjInfo& objDest, uint64_t bitIdx, uint64_t elemIdx) const;
@@ -323,7 +376,15 @@ public:
   virtual ~pimCmdFunc2() {}
   virtual bool execute() override;
   virtual bool sanityCheck() const override;
-  virtual bool computeRegion(unsigned index) override;
+  virtual bool isElementWise() const override { return true; }
+  virtual bool getElementWiseInfo(pimElementWiseInfo& info) const override;
+  virtual bool computeElements(uint64_t idxBegin, uint64_t numElements) override;
+  virtual pimeval::perfEnergy getPerfEnergy() const override;
+  virtual bool getObjAccess(std::vector<PimObjId>& readIds, std::vector<PimObjId>& writeIds) const override {
+    readIds = { m_src1, m_src2 };
+    writeIds = { m_dest };
+    return true;
+  }
   virtual bool updateStats() const override;
 protected:
   PimObjId m_src1;
@@ -331,6 +392,9 @@ protected:
   PimObjId m_dest;
   uint64_t m_scalarValue;
 private:
+  bool computeRegionTyped(const pimObjInfo& objSrc1, const pimObjInfo& objSrc2, pimObjInfo& objDest, uint64_t idxBegin, uint64_t numElements, bool& isHandled) const;
+  template <typename T> bool computeSpanTyped(const T* src1, const T* src2, pimObjInfo& objDest, uint64_t idxBegin, uint64_t numElements, bool& isHandled) const;
+
   template<typename T>
   inline bool computeResult(T operand1, T operand2, PimCmdEnum cmdType, T scalarValue, T& result) {
     switch (cmdType) {
@@ -428,7 +492,11 @@ public:
   virtual ~pimCmdCond() {}
   virtual bool execute() override;
   virtual bool sanityCheck() const override;
-  virtual bool computeRegion(unsigned index) override;
+  virtual bool isElementWise() const override { return true; }
+  virtual bool getElementWiseInfo(pimElementWiseInfo& info) const override;
+  virtual bool computeElements(uint64_t idxBegin, uint64_t numElements) override;
+  virtual pimeval::perfEnergy getPerfEnergy() const override;
+  virtual bool getObjAccess(std::vector<PimObjId>& readIds, std::vector<PimObjId>& writeIds) const override;
   virtual bool updateStats() const override;
 protected:
   PimObjId m_condBool;
@@ -436,6 +504,8 @@ protected:
   PimObjId m_src2 = -1;
   uint64_t m_scalarBits = 0;
   PimObjId m_dest;
+private:
+  bool computeRegionTyped(const pimObjInfo& objBool, pimObjInfo& objDest, uint64_t idxBegin, uint64_t numElements, bool& isHandled) const;
 };
 
 //! @class  pimCmdReduction
@@ -458,14 +528,23 @@ public:
   virtual ~pimCmdReduction() {}
   virtual bool execute() override;
   virtual bool sanityCheck() const override;
-  virtual bool computeRegion(unsigned index) override;
+  virtual bool getObjAccess(std::vector<PimObjId>& readIds, std::vector<PimObjId>& writeIds) const override {
+    readIds = { m_src };
+    writeIds.clear();
+    return true;
+  }
   virtual bool updateStats() const override;
 protected:
   PimObjId m_src;
   void* m_result;
-  std::vector<T> m_regionResult;
+  std::vector<pimUtils::cacheLinePadded<T>> m_partialResult;  // one per fixed-size chunk of elements
   uint64_t m_idxBegin = 0;
   uint64_t m_idxEnd = std::numeric_limits<uint64_t>::max();
+private:
+  T getIdentity() const;
+  T combine(T val1, T val2) const;
+  T computePartial(uint64_t idxBegin, uint64_t idxEnd) const;
+  T combinePartials();
 };
 
 //! @class  pimCmdMAC
@@ -483,9 +562,14 @@ public:
   virtual bool execute() override;
   virtual bool sanityCheck() const override;
   virtual bool computeRegion(unsigned index) override;
+  virtual bool getObjAccess(std::vector<PimObjId>& readIds, std::vector<PimObjId>& writeIds) const override {
+    readIds = { m_src1, m_src2 };
+    writeIds.clear();
+    return true;
+  }
   virtual bool updateStats() const override;
 protected:
-  std::vector<T> m_regionResult;
+  std::vector<pimUtils::cacheLinePadded<T>> m_regionResult;
   PimObjId m_src1, m_src2;
   void* m_dest; // Pointer to the destination buffer where MAC results will be stored
 };
@@ -504,7 +588,15 @@ public:
   virtual ~pimCmdBroadcast() {}
   virtual bool execute() override;
   virtual bool sanityCheck() const override;
-  virtual bool computeRegion(unsigned index) override;
+  virtual bool isElementWise() const override { return true; }
+  virtual bool getElementWiseInfo(pimElementWiseInfo& info) const override;
+  virtual bool computeElements(uint64_t idxBegin, uint64_t numElements) override;
+  virtual pimeval::perfEnergy getPerfEnergy() const override;
+  virtual bool getObjAccess(std::vector<PimObjId>& readIds, std::vector<PimObjId>& writeIds) const override {
+    readIds.clear();
+    writeIds = { m_dest };
+    return true;
+  }
   virtual bool updateStats() const override;
 protected:
   PimObjId m_dest;
@@ -526,6 +618,11 @@ public:
   virtual bool execute() override;
   virtual bool sanityCheck() const override;
   virtual bool computeRegion(unsigned index) override;
+  virtual bool getObjAccess(std::vector<PimObjId>& readIds, std::vector<PimObjId>& writeIds) const override {
+    readIds = { m_src };
+    writeIds = { m_src };
+    return true;
+  }
   virtual bool updateStats() const override;
 protected:
   PimObjId m_src;
@@ -2,36 +2,165 @@
 // PIMeval Simulator - PIM API Fusion
 
 #include "pimCmdFuse.h"
+#include "pimSim.h"
+#include "pimDevice.h"
+#include "pimTrace.h"
 #include <cstdio>
+#include <algorithm>
+#include <string>
 
 //! @brief  Pim CMD: PIM API Fusion
 bool
 pimCmdFuse::execute()
 {
   if (m_debugCmds) {
-    std::printf("PIM-Cmd: API Fusion\n");
+    std::printf("PIM-Cmd: API Fusion (%zu APIs)\n", m_prog.m_apis.size());
   }
 
-  // Functional simulation
-  // TODO: skip original updateStats
+  // Functional simulation with element-wise commands captured
+  // APIs of the program are recorded into its trace segment as they run
+  pimCmdFuse* prevFuseCmd = m_device->getFuseCmd();
+  m_device->setFuseCmd(this);
   bool success = true;
-  for (auto& api : m_prog.m_apis) {
-    PimStatus status = api();
-    if (status != PIM_OK) {
-      success = false;
-      break;
+  {
+    pimTraceWriter::scopedSegment traceSegment(m_traceSegment);
+    for (auto& api : m_prog.m_apis) {
+      PimStatus status = api();
+      if (status != PIM_OK) {
+        success = false;
+        break;
+      }
     }
   }
-
-  // Analyze API fusion opportunities
-  success = success && updateStats();
+  // stats of each sweep are updated by flush()
+  success = flush() && success;
+  m_device->setFuseCmd(prevFuseCmd);
   return success;
 }
 
-//! @brief  Pim CMD: PIM API Fusion - update stats
+//! @brief  Pim CMD: PIM API Fusion - set the API trace segment to record APIs of the program into
+void
+pimCmdFuse::setTraceSegment(pimTraceWriter* traceWriter, pimTraceWriter::segment* traceSegment)
+{
+  m_traceWriter = traceWriter;
+  m_traceSegment = traceSegment;
+}
+
+//! @brief  pimCmdFuse dtor. End the API trace segment, even if the program did not run
+pimCmdFuse::~pimCmdFuse()
+{
+  if (m_traceWriter) {
+    m_traceWriter->closeSegment(m_traceSegment, pimTraceOp::FUSE_END);
+  }
+}
+
+//! @brief  Pim CMD: PIM API Fusion - capture an element-wise command
+//!         Commands accessing object references are executed immediately, as an element index
+//!         may map to different locations of the same memory
+bool
+pimCmdFuse::capture(std::unique_ptr<pimCmd> cmd)
+{
+  if (!cmd->sanityCheck()) {
+    return false;
+  }
+  pimElementWiseInfo info;
+  if (!cmd->getElementWiseInfo(info)) {
+    return false;
+  }
+
+  pimResMgr* resMgr = m_device->getResMgr();
+  bool hasRef = resMgr->getObjInfo(info.m_destId).getRefObjId() != -1;
+  for (PimObjId objId : info.m_srcIds) {
+    hasRef = hasRef || resMgr->getObjInfo(objId).getRefObjId() != -1;
+  }
+  if (hasRef) {
+    return flush() && cmd->executeElementWise();
+  }
+
+  // start a new sweep if the iteration space differs
+  if (!m_infos.empty() && m_infos.front().m_numElements != info.m_numElements) {
+    if (!flush()) {
+      return false;
+    }
+  }
+  m_cmds.push_back(std::move(cmd));
+  m_infos.push_back(info);
+  return true;
+}
+
+//! @brief  Pim CMD: PIM API Fusion - execute captured commands in one sweep
+bool
+pimCmdFuse::flush()
+{
+  if (m_cmds.empty()) {
+    return true;
+  }
+  if (m_debugCmds) {
+    std::printf("PIM-Cmd: API Fusion - %zu commands in one sweep\n", m_cmds.size());
+  }
+
+  pimResMgr* resMgr = m_device->getResMgr();
+  bool isFunctional = pimSim::get()->getDeviceType() == PIM_FUNCTIONAL;
+  uint64_t numElements = m_infos.front().m_numElements;
+  unsigned bytesPerElement = 0;
+  std::vector<PimObjId> destIds;
+  for (const auto& info : m_infos) {
+    bytesPerElement += info.m_bytesPerElement;
+    if (std::find(destIds.begin(), destIds.end(), info.m_destId) == destIds.end()) {
+      destIds.push_back(info.m_destId);
+    }
+    if (!isFunctional) {
+      for (PimObjId objId : info.m_srcIds) {
+        resMgr->getObjInfo(objId).syncFromSimulatedMem();
+      }
+    }
+  }
+
+  // run all commands on a chunk before moving to the next chunk
+  uint64_t grainSize = getElementGrainSize(numElements, bytesPerElement);
+  runInParallel(numElements, grainSize, [this](uint64_t idxBegin, uint64_t idxEnd) {
+    for (auto& cmd : m_cmds) {
+      cmd->computeElements(idxBegin, idxEnd - idxBegin);
+    }
+  });
+
+  if (!isFunctional) {
+    for (PimObjId objId : destIds) {
+      pimObjInfo &objDest = resMgr->getObjInfo(objId);
+      objDest.markDataHolderModified();
+      objDest.syncToSimulatedMem();
+    }
+  }
+
+  updateStats();
+
+  m_cmds.clear();
+  m_infos.clear();
+  return true;
+}
+
+//! @brief  Pim CMD: PIM API Fusion - update stats of the current sweep
+//!         Record one fused.<ops> entry with fused performance and energy, replacing per-command entries
 bool
 pimCmdFuse::updateStats() const
 {
-  // TODO: Parse m_prog and update stats
+  if (m_cmds.empty()) {
+    return true;
+  }
+  if (m_cmds.size() == 1) {  // nothing fused
+    m_cmds.front()->m_msKernelElapsed = m_msKernelElapsed;
+    return m_cmds.front()->updateStats();
+  }
+  std::vector<pimeval::fusedOp> ops;
+  std::string cmdName = "fused.";
+  for (size_t i = 0; i < m_cmds.size(); ++i) {
+    ops.push_back({ m_cmds[i]->m_cmdType, m_infos[i].m_srcIds, m_infos[i].m_destId, m_cmds[i]->getPerfEnergy() });
+    cmdName += (i == 0 ? "" : "+") + m_cmds[i]->getName();
+  }
+
+  const pimObjInfo& obj = m_device->getResMgr()->getObjInfo(m_infos.front().m_destId);
+  pimeval::perfEnergy mPerfEnergy = pimSim::get()->getPerfEnergyModel()->getPerfEnergyForFused(ops, obj);
+  pimSim::get()->getStatsMgr()->recordCmd(cmdName, mPerfEnergy);
+  recordKernelThroughput(cmdName, m_infos.front().m_numElements);
   return true;
-}
\ No newline at end of file
+}
@@ -6,18 +6,37 @@
 
 #include "libpimeval.h"
 #include "pimCmd.h"
+#include "pimTrace.h"
+#include <vector>
+#include <memory>
 
 //! @class  pimCmdFuse
 //! @brief  Pim CMD: PIM API Fusion
+//! - APIs of a PimProg are run in capture mode, where element-wise commands are sanity checked
+//!   and deferred instead of being executed
+//! - Deferred commands over the same number of elements are lowered into one sweep: each task
+//!   chunk runs all commands in program order, so intermediates stay in cache
+//! - Any other command or object deletion flushes deferred commands first
+//! - Each sweep is recorded as one fused.<ops> stats entry with fused performance and energy
+//! - When tracing, APIs of the program are recorded as they run, into a segment between FUSE_BEGIN
+//!   and FUSE_END reserved at the position of the pimFuse call
 class pimCmdFuse : public pimCmd
 {
 public:
   pimCmdFuse(PimProg prog) : pimCmd(PimCmdEnum::NOOP), m_prog(prog) {}
-  virtual ~pimCmdFuse() {}
+  virtual ~pimCmdFuse();
   virtual bool execute() override;
   virtual bool updateStats() const override;
+
+  bool capture(std::unique_ptr<pimCmd> cmd);
+  bool flush();
+  void setTraceSegment(pimTraceWriter* traceWriter, pimTraceWriter::segment* traceSegment);
 private:
   PimProg m_prog;
+  std::vector<std::unique_ptr<pimCmd>> m_cmds;
+  std::vector<pimElementWiseInfo> m_infos;
+  pimTraceWriter* m_traceWriter = nullptr;
+  pimTraceWriter::segment* m_traceSegment = nullptr;
 };
 
-#endif
\ No newline at end of file
+#endif
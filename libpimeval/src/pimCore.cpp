@@ -6,24 +6,37 @@
 #include <cstdio>
 #include <iomanip>
 #include <sstream>
+#include <algorithm>
 
 
 //! @brief  pimCore ctor
 pimCore::pimCore(unsigned numRows, unsigned numCols)
   : m_numRows(numRows),
     m_numCols(numCols),
-    m_array(numRows, std::vector<bool>(numCols)),
+    m_numWordsPerRow(((numCols + 63) / 64 + s_numWordsPerCacheLine - 1) / s_numWordsPerCacheLine * s_numWordsPerCacheLine),
+    m_lastWordMask((numCols % 64 == 0) ? ~0ULL : ((1ULL << (numCols % 64)) - 1)),
+    m_pageShift(0),
+    m_pageRowMask(0),
+    m_zeroRow(m_numWordsPerRow),
     m_senseAmpCol(numRows)
 {
+  // Use a power-of-two number of rows per page, with page size close to the target
+  while ((2ULL << m_pageShift) * m_numWordsPerRow * sizeof(uint64_t) <= s_targetPageBytes && (2ULL << m_pageShift) <= numRows) {
+    ++m_pageShift;
+  }
+  m_pageRowMask = getNumRowsPerPage() - 1;
+  m_pages = std::vector<std::atomic<pimRowBits*>>((static_cast<uint64_t>(numRows) + m_pageRowMask) >> m_pageShift);
+
   // Initialize memory contents with random 0/1
   if (0) {
     std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<int> dist(0, 1);
+    std::mt19937_64 gen(rd());
     for (unsigned row = 0; row < m_numRows; ++row) {
-      for (unsigned col = 0; col < m_numCols; ++col) {
-        m_array[row][col] = dist(gen);
+      uint64_t* rowPtr = getRowPtrForWrite(row);
+      for (unsigned word = 0; word < getNumValidWords(); ++word) {
+        rowPtr[word] = gen();
       }
+      rowPtr[getNumValidWords() - 1] &= m_lastWordMask;
     }
   }
 
@@ -35,13 +48,42 @@ pimCore::pimCore(unsigned numRows, unsigned numCols)
 //! @brief  pimCore dtor
 pimCore::~pimCore()
 {
+  for (auto& page : m_pages) {
+    delete page.load(std::memory_order_relaxed);
+  }
+}
+
+//! @brief  Materialize a page of simulated memory. If another thread wins the race, use its page
+pimCore::pimRowBits*
+pimCore::materializePage(std::atomic<pimRowBits*>& slot)
+{
+  pimRowBits* newPage = new pimRowBits(static_cast<uint64_t>(getNumRowsPerPage()) * m_numWordsPerRow);
+  pimRowBits* expected = nullptr;
+  if (slot.compare_exchange_strong(expected, newPage, std::memory_order_acq_rel, std::memory_order_acquire)) {
+    return newPage;
+  }
+  delete newPage;
+  return expected;
+}
+
+//! @brief  Get number of materialized pages of simulated memory
+unsigned
+pimCore::getNumPagesInUse() const
+{
+  unsigned numPages = 0;
+  for (const auto& page : m_pages) {
+    if (page.load(std::memory_order_relaxed)) {
+      ++numPages;
+    }
+  }
+  return numPages;
 }
 
 //! @brief  Initialize a row reg
 bool
 pimCore::declareRowReg(PimRowReg reg)
 {
-  m_rowRegs[reg].resize(m_numCols);
+  m_rowRegs[reg].resize(m_numWordsPerRow);
   return true;
 }
 
@@ -53,7 +95,8 @@ pimCore::readRow(unsigned rowIndex)
     std::printf("PIM-Error: Out-of-boundary subarray row read: index = %u, numRows = %u\n", rowIndex, m_numRows);
     return false;
   }
-  m_rowRegs[PIM_RREG_SA] = m_array[rowIndex];
+  const uint64_t* rowPtr = getRowPtrForRead(rowIndex);
+  std::copy(rowPtr, rowPtr + m_numWordsPerRow, m_rowRegs[PIM_RREG_SA].begin());
   return true;
 }
 
@@ -66,7 +109,7 @@ pimCore::readCol(unsigned colIndex)
     return false;
   }
   for (unsigned row = 0; row < m_numRows; ++row) {
-    m_senseAmpCol[row] = m_array[row][colIndex];
+    m_senseAmpCol[row] = getBit(row, colIndex);
   }
   return true;
 }
@@ -87,22 +130,46 @@ pimCore::readMultiRows(const std::vector<std::pair<unsigned, bool>>& rowIdxs)
       return false;
     }
   }
-  // compute majority
-  for (unsigned col = 0; col < m_numCols; ++col) {
-    unsigned sum = 0;
+  // compute majority 64 columns at a time with bit-sliced counters
+  unsigned numRowsActivated = rowIdxs.size();
+  unsigned threshold = numRowsActivated / 2;
+  unsigned numCounterBits = 1;
+  while ((1u << numCounterBits) <= numRowsActivated) {
+    ++numCounterBits;
+  }
+  std::vector<uint64_t> counter(numCounterBits);
+  pimRowBits& sa = m_rowRegs[PIM_RREG_SA];
+  unsigned numValidWords = getNumValidWords();
+  ++m_memGen;
+  for (unsigned word = 0; word < numValidWords; ++word) {
+    std::fill(counter.begin(), counter.end(), 0);
     for (const auto& kv : rowIdxs) {
-      unsigned idx = kv.first;
-      bool isDCCN = kv.second;
-      bool val = (isDCCN ? !m_array[idx][col] : m_array[idx][col]);
-      sum += val ? 1 : 0;
+      uint64_t carry = getRowPtrForRead(kv.first)[word];
+      if (kv.second) {
+        carry = ~carry;
+      }
+      for (unsigned i = 0; i < numCounterBits && carry; ++i) {
+        uint64_t sum = counter[i] ^ carry;
+        carry &= counter[i];
+        counter[i] = sum;
+      }
+    }
+    // per-bit comparison: counter > threshold
+    uint64_t gt = 0;
+    uint64_t eq = ~0ULL;
+    for (int i = static_cast<int>(numCounterBits) - 1; i >= 0; --i) {
+      if ((threshold >> i) & 1u) {
+        eq &= counter[i];
+      } else {
+        gt |= eq & counter[i];
+        eq &= ~counter[i];
+      }
     }
-    bool maj = (sum > rowIdxs.size() / 2);
+    uint64_t maj = gt & getWordMask(word);
     for (const auto& kv : rowIdxs) {
-      unsigned idx = kv.first;
-      bool isDCCN = kv.second;
-      m_array[idx][col] = (isDCCN ? !maj : maj);
+      getRowPtrForWrite(kv.first)[word] = kv.second ? (~maj & getWordMask(word)) : maj;
     }
-    m_rowRegs[PIM_RREG_SA][col] = maj;
+    sa[word] = maj;
   }
   return true;
 }
@@ -120,12 +187,14 @@ pimCore::writeMultiRows(const std::vector<std::pair<unsigned, bool>>& rowIdxs)
     }
   }
   // write
-  for (unsigned col = 0; col < m_numCols; ++col) {
-    bool val = m_rowRegs[PIM_RREG_SA][col];
-    for (const auto& kv : rowIdxs) {
-      unsigned idx = kv.first;
-      bool isDCCN = kv.second;
-      m_array[idx][col] = (isDCCN ? !val :val);
+  const pimRowBits& sa = m_rowRegs[PIM_RREG_SA];
+  unsigned numValidWords = getNumValidWords();
+  ++m_memGen;
+  for (const auto& kv : rowIdxs) {
+    uint64_t* rowPtr = getRowPtrForWrite(kv.first);
+    bool isDCCN = kv.second;
+    for (unsigned word = 0; word < numValidWords; ++word) {
+      rowPtr[word] = isDCCN ? (~sa[word] & getWordMask(word)) : sa[word];
     }
   }
   return true;
@@ -139,7 +208,9 @@ pimCore::writeRow(unsigned rowIndex)
     std::printf("PIM-Error: Out-of-boundary subarray row write: index = %u, numRows = %u\n", rowIndex, m_numRows);
     return false;
   }
-  m_array[rowIndex] = m_rowRegs[PIM_RREG_SA];
+  const pimRowBits& sa = m_rowRegs[PIM_RREG_SA];
+  std::copy(sa.begin(), sa.end(), getRowPtrForWrite(rowIndex));
+  ++m_memGen;
   return true;
 }
 
@@ -152,8 +223,9 @@ pimCore::writeCol(unsigned colIndex)
     return false;
   }
   for (unsigned row = 0; row < m_numRows; ++row) {
-    m_array[row][colIndex] = m_senseAmpCol[row];
+    setBit(row, colIndex, m_senseAmpCol[row]);
   }
+  ++m_memGen;
   return true;
 }
 
@@ -165,7 +237,13 @@ pimCore::setSenseAmpRow(const std::vector<bool>& vals)
     std::printf("PIM-Error: Incorrect data size write to row SAs: size = %lu, numCols = %u\n", vals.size(), m_numCols);
     return false;
   }
-  m_rowRegs[PIM_RREG_SA] = vals;
+  pimRowBits& sa = m_rowRegs[PIM_RREG_SA];
+  std::fill(sa.begin(), sa.end(), 0);
+  for (unsigned col = 0; col < m_numCols; ++col) {
+    if (vals[col]) {
+      sa[col >> 6] |= 1ULL << (col & 63);
+    }
+  }
   return true;
 }
 
@@ -181,6 +259,33 @@ pimCore::setSenseAmpCol(const std::vector<bool>& vals)
   return true;
 }
 
+//! @brief  Directly set #numBits bits of #numVals V-layout elements in consecutive columns starting at colIdx
+//!         Elements are transposed as a 64x64 bit block, so that each row is updated with word operations
+void
+pimCore::setBitsVBlock(unsigned rowIdx, unsigned colIdx, const uint64_t* vals, unsigned numVals, unsigned numBits)
+{
+  assert(numVals > 0 && numVals <= 64 && numBits > 0 && numBits <= 64);
+  uint64_t block[64] = {};
+  std::copy(vals, vals + numVals, block);
+  pimUtils::transposeBits64x64(block);
+  for (unsigned i = 0; i < numBits; ++i) {
+    setBitsH(rowIdx + i, colIdx, block[i], numVals);
+  }
+}
+
+//! @brief  Directly get #numBits bits of #numVals V-layout elements in consecutive columns starting at colIdx
+void
+pimCore::getBitsVBlock(unsigned rowIdx, unsigned colIdx, uint64_t* vals, unsigned numVals, unsigned numBits) const
+{
+  assert(numVals > 0 && numVals <= 64 && numBits > 0 && numBits <= 64);
+  uint64_t block[64] = {};
+  for (unsigned i = 0; i < numBits; ++i) {
+    block[i] = getBitsH(rowIdx + i, colIdx, numVals);
+  }
+  pimUtils::transposeBits64x64(block);
+  std::copy(block, block + numVals, vals);
+}
+
 //! @brief  Print out memory subarray contents
 void
 pimCore::print() const
@@ -188,31 +293,32 @@ pimCore::print() const
   std::ostringstream oss;
   // header
   oss << "  Row S ";
-  for (unsigned col = 0; col < m_array[0].size(); ++col) {
+  for (unsigned col = 0; col < m_numCols; ++col) {
     oss << (col % 8 == 0 ? '+' : '-');
   }
   oss << std::endl;
-  for (unsigned row = 0; row < m_array.size(); ++row) {
+  for (unsigned row = 0; row < m_numRows; ++row) {
     // row index
     oss << std::setw(5) << row << ' ';
     // col SA
     oss << m_senseAmpCol[row] << ' ';
     // row contents
-    for (unsigned col = 0; col < m_array[0].size(); ++col) {
-      oss << m_array[row][col];
+    for (unsigned col = 0; col < m_numCols; ++col) {
+      oss << getBit(row, col);
     }
     oss << std::endl;
   }
   // footer
   oss << "        ";
-  for (unsigned col = 0; col < m_array[0].size(); ++col) {
+  for (unsigned col = 0; col < m_numCols; ++col) {
     oss << (col % 8 == 0 ? '+' : '-');
   }
   oss << std::endl;
   // row SA
   oss << "     SA ";
-  for (unsigned col = 0; col < m_array[0].size(); ++col) {
-    oss << m_rowRegs.at(PIM_RREG_SA)[col];
+  const pimRowBits& sa = m_rowRegs.at(PIM_RREG_SA);
+  for (unsigned col = 0; col < m_numCols; ++col) {
+    oss << ((sa[col >> 6] >> (col & 63)) & 1ULL);
   }
   oss << std::endl;
   std::printf("%s\n", oss.str().c_str());
@@ -5,19 +5,29 @@
 #define LAVA_PIM_CORE_H
 
 #include "libpimeval.h"
+#include "pimUtils.h"
 #include <vector>
+#include <atomic>
 #include <string>
 #include <map>
+#include <memory>
 #include <cassert>
 #include <cstdint>
 
 
 //! @class  pimCore
 //! @brief  A PIM core which performs computation on a 2D memory subarray
+//! Each memory row is packed into 64-bit words, i.e., column c is bit (c % 64) of word (c / 64).
+//! Rows are padded to whole cache lines so that row-wide operations work on aligned words.
+//! Simulated memory is split into pages of rows which are materialized on first write.
+//! Untouched pages read as zero, and pages can be released once no PIM object uses them.
 class pimCore
 {
 public:
+  typedef std::vector<uint64_t, pimUtils::alignedAllocator<uint64_t, 64>> pimRowBits;
+
   pimCore(unsigned numRows, unsigned numCols);
+  pimCore(pimCore&&) = default;
   ~pimCore();
 
   // ID
@@ -27,7 +37,7 @@ public:
   // Row-based operations
   bool readRow(unsigned rowIndex);
   bool writeRow(unsigned rowIndex);
-  std::vector<bool>& getSenseAmpRow() { return m_rowRegs[PIM_RREG_SA]; }
+  pimRowBits& getSenseAmpRow() { return m_rowRegs[PIM_RREG_SA]; }
   bool setSenseAmpRow(const std::vector<bool>& vals);
   bool readMultiRows(const std::vector<std::pair<unsigned, bool>>& rowIdxs);
   bool writeMultiRows(const std::vector<std::pair<unsigned, bool>>& rowIdxs);
@@ -39,7 +49,17 @@ public:
   bool setSenseAmpCol(const std::vector<bool>& vals);
 
   // Reg access
-  std::vector<bool>& getRowReg(PimRowReg reg) { return m_rowRegs[reg]; }
+  pimRowBits& getRowReg(PimRowReg reg) { return m_rowRegs[reg]; }
+
+  // Paged simulated memory
+  unsigned getNumRowsPerPage() const { return 1u << m_pageShift; }
+  unsigned getNumPages() const { return m_pages.size(); }
+  unsigned getNumPagesInUse() const;
+  void releasePage(unsigned pageIdx) { delete m_pages[pageIdx].exchange(nullptr, std::memory_order_acq_rel); ++m_memGen; }
+
+  //! @brief  Generation of simulated memory contents, bumped by row/column level writes.
+  //!         Direct bit access for syncing functional data holders does not bump it
+  uint64_t getMemGen() const { return m_memGen; }
 
   // Utilities
   bool declareRowReg(PimRowReg reg);
@@ -50,31 +70,36 @@ public:
   //! @brief  Directly set a bit for functional simulation
   inline void setBit(unsigned rowIdx, unsigned colIdx, bool val) {
     assert(rowIdx < m_numRows && colIdx < m_numCols);
-    m_array[rowIdx][colIdx] = val;
+    uint64_t& word = getRowPtrForWrite(rowIdx)[colIdx >> 6];
+    uint64_t mask = 1ULL << (colIdx & 63);
+    word = val ? (word | mask) : (word & ~mask);
   }
   //! @brief  Directly get a bit for functional simulation
   inline bool getBit(unsigned rowIdx, unsigned colIdx) const {
     assert(rowIdx < m_numRows && colIdx < m_numCols);
-    return m_array[rowIdx][colIdx];
+    return (getRowPtrForRead(rowIdx)[colIdx >> 6] >> (colIdx & 63)) & 1ULL;
   }
   //! @brief  Directly set #numBits bits for V-layout functional simulation
   inline void setBitsV(unsigned rowIdx, unsigned colIdx, uint64_t val, unsigned numBits) {
     assert(numBits > 0 && numBits <= 64);
     assert(rowIdx + (numBits - 1) < m_numRows && colIdx < m_numCols);
+    unsigned wordIdx = colIdx >> 6;
+    unsigned shift = colIdx & 63;
+    uint64_t mask = 1ULL << shift;
     for (unsigned i = 0; i < numBits; ++i) {
-      bool bitVal = val & 1;
-      setBit(rowIdx + i, colIdx, bitVal);
-      val = val >> 1;
+      uint64_t& word = getRowPtrForWrite(rowIdx + i)[wordIdx];
+      word = (word & ~mask) | (((val >> i) & 1ULL) << shift);
     }
   }
   //! @brief  Directly get #numBits bits for V-layout functional simulation
   inline uint64_t getBitsV(unsigned rowIdx, unsigned colIdx, unsigned numBits) const {
     assert(numBits > 0 && numBits <= 64);
     assert(rowIdx + (numBits - 1) < m_numRows && colIdx < m_numCols);
+    unsigned wordIdx = colIdx >> 6;
+    unsigned shift = colIdx & 63;
     uint64_t val = 0;
-    for (int i = (numBits - 1); i >= 0; --i) {
-      bool bitVal = getBit(rowIdx + i, colIdx);
-      val = (val << 1) | bitVal;
+    for (unsigned i = 0; i < numBits; ++i) {
+      val |= ((getRowPtrForRead(rowIdx + i)[wordIdx] >> shift) & 1ULL) << i;
     }
     return val;
   }
@@ -82,35 +107,76 @@ public:
   inline void setBitsH(unsigned rowIdx, unsigned colIdx, uint64_t val, unsigned numBits) {
     assert(numBits > 0 && numBits <= 64);
     assert(rowIdx < m_numRows && colIdx + (numBits - 1) < m_numCols);
-    for (unsigned i = 0; i < numBits; ++i) {
-      bool bitVal = val & 1;
-      setBit(rowIdx, colIdx + i, bitVal);
-      val = val >> 1;
+    uint64_t* ptr = getRowPtrForWrite(rowIdx) + (colIdx >> 6);
+    unsigned shift = colIdx & 63;
+    uint64_t mask = (numBits == 64) ? ~0ULL : ((1ULL << numBits) - 1);
+    val &= mask;
+    ptr[0] = (ptr[0] & ~(mask << shift)) | (val << shift);
+    if (shift + numBits > 64) {
+      // spill over to the next word
+      unsigned lowBits = 64 - shift;
+      ptr[1] = (ptr[1] & ~(mask >> lowBits)) | (val >> lowBits);
     }
   }
   //! @brief  Directly get #numBits bits for H-layout functional simulation
   inline uint64_t getBitsH(unsigned rowIdx, unsigned colIdx, unsigned numBits) const {
     assert(numBits > 0 && numBits <= 64);
     assert(rowIdx < m_numRows && colIdx + (numBits - 1) < m_numCols);
-    uint64_t val = 0;
-    for (int i = (numBits - 1); i >= 0; --i) {
-      bool bitVal = getBit(rowIdx, colIdx + i);
-      val = (val << 1) | bitVal;
+    const uint64_t* ptr = getRowPtrForRead(rowIdx) + (colIdx >> 6);
+    unsigned shift = colIdx & 63;
+    uint64_t val = ptr[0] >> shift;
+    if (shift + numBits > 64) {
+      val |= ptr[1] << (64 - shift);
     }
-    return val;
+    return (numBits == 64) ? val : (val & ((1ULL << numBits) - 1));
   }
+  // Block transfer of up to 64 V-layout elements in consecutive columns, using bit-matrix transpose
+  void setBitsVBlock(unsigned rowIdx, unsigned colIdx, const uint64_t* vals, unsigned numVals, unsigned numBits);
+  void getBitsVBlock(unsigned rowIdx, unsigned colIdx, uint64_t* vals, unsigned numVals, unsigned numBits) const;
 
 private:
+  static constexpr unsigned s_numWordsPerCacheLine = 64 / sizeof(uint64_t);
+  static constexpr unsigned s_targetPageBytes = 256 * 1024;
+
+  //! @brief  Number of words holding valid columns in a row, excluding padding
+  inline unsigned getNumValidWords() const { return (m_numCols + 63) / 64; }
+  //! @brief  Mask of valid columns in a word of a row
+  inline uint64_t getWordMask(unsigned wordIdx) const { return (wordIdx == getNumValidWords() - 1) ? m_lastWordMask : ~0ULL; }
+  //! @brief  Get a row for read. Rows of an untouched page read as zero
+  inline const uint64_t* getRowPtrForRead(unsigned rowIdx) const {
+    const pimRowBits* page = m_pages[rowIdx >> m_pageShift].load(std::memory_order_acquire);
+    if (!page) {
+      return m_zeroRow.data();
+    }
+    return page->data() + static_cast<uint64_t>(rowIdx & m_pageRowMask) * m_numWordsPerRow;
+  }
+  //! @brief  Get a row for write. Materialize the page on first write
+  //!         Worker threads may write different rows of a page, so the page is published with compare-and-swap
+  inline uint64_t* getRowPtrForWrite(unsigned rowIdx) {
+    std::atomic<pimRowBits*>& slot = m_pages[rowIdx >> m_pageShift];
+    pimRowBits* page = slot.load(std::memory_order_acquire);
+    if (!page) {
+      page = materializePage(slot);
+    }
+    return page->data() + static_cast<uint64_t>(rowIdx & m_pageRowMask) * m_numWordsPerRow;
+  }
+  pimRowBits* materializePage(std::atomic<pimRowBits*>& slot);
+
   PimCoreId m_coreId;
   unsigned m_numRows;
   unsigned m_numCols;
+  unsigned m_numWordsPerRow;  // including cache line padding
+  uint64_t m_lastWordMask;    // valid bits of the last non-padding word of a row
+  unsigned m_pageShift;       // log2 of number of rows per page
+  unsigned m_pageRowMask;     // row index mask within a page
 
-  std::vector<std::vector<bool>> m_array;
+  std::vector<std::atomic<pimRowBits*>> m_pages;  // owned pages, null until first write
+  uint64_t m_memGen = 0;
+  pimRowBits m_zeroRow;
   std::vector<bool> m_senseAmpCol;
 
-  std::map<PimRowReg, std::vector<bool>> m_rowRegs;
+  std::map<PimRowReg, pimRowBits> m_rowRegs;
   std::map<std::string, std::vector<bool>> m_colRegs;
 };
 
 #endif
-
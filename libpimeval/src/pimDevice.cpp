@@ -3,6 +3,7 @@
 
 #include "pimDevice.h"
 #include "pimResMgr.h"
+#include "pimCmdFuse.h"
 #include "pimSim.h"
 #include "libpimeval.h"
 #include "pimUtils.h"
@@ -10,11 +11,13 @@
 #include <memory>
 #include <cassert>
 #include <string>
+#include <mutex>
 
 
 //! @brief  pimDevice ctor
 pimDevice::pimDevice(const pimSimConfig& config)
-  : m_config(config)
+  : m_config(config),
+    m_streamMgr(std::make_unique<pimStreamMgr>(this))
 {
   init();
 }
@@ -22,6 +25,8 @@ pimDevice::pimDevice(const pimSimConfig& config)
 //! @brief  pimDevice dtor
 pimDevice::~pimDevice()
 {
+  // drain pending stream commands before releasing resources
+  m_streamMgr.reset();
 }
 
 //! @brief  Adjust config for modeling different simulation target with same inputs
@@ -116,9 +121,14 @@ pimDevice::init()
   pimPerfEnergyModelParams params(getSimTarget(), getNumRanks(), paramsDram);
   m_perfEnergyModel = pimPerfEnergyFactory::createPerfEnergyModel(params);
 
-  // Disable simulated memory creation for functional simulation
-  if (getDeviceType() != PIM_FUNCTIONAL) {
-    m_cores.resize(m_numCores, pimCore(m_numRows, m_numCols));
+  // Disable simulated memory creation for functional simulation and analysis mode
+  // Simulated memory pages of each core are materialized lazily on first write
+  if (getDeviceType() != PIM_FUNCTIONAL && !isAnalysisMode()) {
+    m_cores.reserve(m_numCores);
+    for (unsigned coreId = 0; coreId < m_numCores; ++coreId) {
+      m_cores.emplace_back(m_numRows, m_numCols);
+      m_cores.back().setCoreId(coreId);
+    }
   }
 
   if (m_bufferSize > 0) {
@@ -138,6 +148,7 @@ pimDevice::init()
 PimObjId
 pimDevice::pimAlloc(PimAllocEnum allocType, uint64_t numElements, PimDataType dataType)
 {
+  std::lock_guard<std::recursive_mutex> lock(pimSim::get()->getExecMutex());
   if (allocType == PIM_ALLOC_AUTO) {
     if (isVLayoutDevice()) {
       allocType = PIM_ALLOC_V;
@@ -165,6 +176,7 @@ pimDevice::pimAllocBuffer(uint32_t numElements, PimDataType dataType)
 PimObjId
 pimDevice::pimAllocAssociated(PimObjId assocId, PimDataType dataType)
 {
+  std::lock_guard<std::recursive_mutex> lock(pimSim::get()->getExecMutex());
   return m_resMgr->pimAllocAssociated(assocId, dataType);
 }
 
@@ -172,6 +184,12 @@ pimDevice::pimAllocAssociated(PimObjId assocId, PimDataType dataType)
 bool
 pimDevice::pimFree(PimObjId obj)
 {
+  m_streamMgr->waitForObj(obj);
+  std::lock_guard<std::recursive_mutex> lock(pimSim::get()->getExecMutex());
+  if (m_fuseCmd && !m_fuseCmd->flush()) {
+    return false;
+  }
+  m_streamMgr->removeObj(obj);
   return m_resMgr->pimFree(obj);
 }
 
@@ -179,14 +197,87 @@ pimDevice::pimFree(PimObjId obj)
 PimObjId
 pimDevice::pimCreateRangedRef(PimObjId refId, uint64_t idxBegin, uint64_t idxEnd)
 {
-  return m_resMgr->pimCreateRangedRef(refId, idxBegin, idxEnd);
+  std::lock_guard<std::recursive_mutex> lock(pimSim::get()->getExecMutex());
+  PimObjId obj = m_resMgr->pimCreateRangedRef(refId, idxBegin, idxEnd);
+  if (obj != -1) {
+    m_streamMgr->addRef(obj, refId);
+  }
+  return obj;
 }
 
 //! @brief  Create an obj referencing to negation of an existing obj based on dual-contact memory cells
 PimObjId
 pimDevice::pimCreateDualContactRef(PimObjId refId)
 {
-  return m_resMgr->pimCreateDualContactRef(refId);
+  std::lock_guard<std::recursive_mutex> lock(pimSim::get()->getExecMutex());
+  PimObjId obj = m_resMgr->pimCreateDualContactRef(refId);
+  if (obj != -1) {
+    m_streamMgr->addRef(obj, refId);
+  }
+  return obj;
+}
+
+//! @brief  Allocate a PIM object that uses a host buffer as zero-copy backing store
+PimObjId
+pimDevice::pimAllocFromHostBuffer(PimAllocEnum allocType, uint64_t numElements, PimDataType dataType, void* hostBuffer)
+{
+  PimObjId obj = pimAlloc(allocType, numElements, dataType);
+  if (obj == -1) {
+    return -1;
+  }
+  if (!pimRegisterHostBuffer(obj, hostBuffer)) {
+    pimFree(obj);
+    return -1;
+  }
+  return obj;
+}
+
+//! @brief  Register a host buffer as zero-copy backing store of a PIM object
+//!         The registration is modeled as a host-to-device copy of all elements, without moving bytes
+bool
+pimDevice::pimRegisterHostBuffer(PimObjId obj, void* hostBuffer)
+{
+  if (!hostBuffer) {
+    std::printf("PIM-Error: Invalid null pointer as host buffer\n");
+    return false;
+  }
+  m_streamMgr->waitForObj(obj);
+  {
+    std::lock_guard<std::recursive_mutex> lock(pimSim::get()->getExecMutex());
+    if (!m_resMgr->isValidObjId(obj)) {
+      std::printf("PIM-Error: Invalid PIM object ID %d for host buffer registration\n", obj);
+      return false;
+    }
+    pimObjInfo& objInfo = m_resMgr->getObjInfo(obj);
+    if (!objInfo.registerHostBuffer(hostBuffer)) {
+      return false;
+    }
+  }
+  // record copy stats, and sync to simulated memory for non-functional simulation
+  return pimCopyMainToDevice(hostBuffer, obj);
+}
+
+//! @brief  Notify that the host wrote the registered host buffer of a PIM object
+//!         Modeled as a host-to-device copy of all elements without moving bytes, same as registration,
+//!         which also bumps the data holder generation and syncs simulated memory for non-functional simulation
+bool
+pimDevice::pimMarkHostBufferModified(PimObjId obj)
+{
+  void* hostBuffer = nullptr;
+  m_streamMgr->waitForObj(obj);
+  {
+    std::lock_guard<std::recursive_mutex> lock(pimSim::get()->getExecMutex());
+    if (!m_resMgr->isValidObjId(obj)) {
+      std::printf("PIM-Error: Invalid PIM object ID %d for host buffer modification\n", obj);
+      return false;
+    }
+    hostBuffer = m_resMgr->getObjInfo(obj).getHostBuffer();
+    if (!hostBuffer) {
+      std::printf("PIM-Error: PIM object ID %d has no registered host buffer\n", obj);
+      return false;
+    }
+  }
+  return pimCopyMainToDevice(hostBuffer, obj);
 }
 
 //! @brief  Copy data from host to PIM within a range
@@ -223,6 +314,44 @@ pimDevice::pimCopyDeviceToMainWithType(PimCopyEnum copyType, PimObjId src, void*
   return executeCmd(std::move(cmd));
 }
 
+//! @brief  Copy data from a strided host layout to PIM within a range
+bool
+pimDevice::pimCopyMainToDevice2D(void* src, PimObjId dest, const pimHostLayout& srcLayout, uint64_t idxBegin, uint64_t idxEnd)
+{
+  PimCopyEnum copyType = m_resMgr->isHLayoutObj(dest) ? PIM_COPY_H : PIM_COPY_V;
+  std::unique_ptr<pimCmd> cmd =
+    std::make_unique<pimCmdCopy>(PimCmdEnum::COPY_H2D, copyType, src, srcLayout, dest, idxBegin, idxEnd);
+  return executeCmd(std::move(cmd));
+}
+
+//! @brief  Copy data from PIM to a strided host layout within a range
+bool
+pimDevice::pimCopyDeviceToMain2D(PimObjId src, void* dest, const pimHostLayout& destLayout, uint64_t idxBegin, uint64_t idxEnd)
+{
+  PimCopyEnum copyType = m_resMgr->isHLayoutObj(src) ? PIM_COPY_H : PIM_COPY_V;
+  std::unique_ptr<pimCmd> cmd =
+    std::make_unique<pimCmdCopy>(PimCmdEnum::COPY_D2H, copyType, src, dest, destLayout, idxBegin, idxEnd);
+  return executeCmd(std::move(cmd));
+}
+
+//! @brief  Copy data from host to PIM for a batch of ranges
+bool
+pimDevice::pimCopyMainToDeviceBatch(const PimCopyDesc* descs, uint64_t numDescs)
+{
+  std::unique_ptr<pimCmd> cmd =
+    std::make_unique<pimCmdCopyBatch>(PimCmdEnum::COPY_H2D, descs, numDescs);
+  return executeCmd(std::move(cmd));
+}
+
+//! @brief  Copy data from PIM to host for a batch of ranges
+bool
+pimDevice::pimCopyDeviceToMainBatch(const PimCopyDesc* descs, uint64_t numDescs)
+{
+  std::unique_ptr<pimCmd> cmd =
+    std::make_unique<pimCmdCopyBatch>(PimCmdEnum::COPY_D2H, descs, numDescs);
+  return executeCmd(std::move(cmd));
+}
+
 //! @brief  Copy data from PIM to PIM within a range
 bool
 pimDevice::pimCopyDeviceToDevice(PimObjId src, PimObjId dest, uint64_t idxBegin, uint64_t idxEnd)
@@ -239,6 +368,27 @@ bool
 pimDevice::executeCmd(std::unique_ptr<pimCmd> cmd)
 {
   cmd->setDevice(this);
+
+  // enqueue to the current stream of the host thread
+  PimStreamId stream = m_streamMgr->getCurrentStream();
+  if (stream != -1) {
+    return m_streamMgr->enqueue(stream, std::move(cmd));
+  }
+
+  // run synchronously after pending stream commands that access the same objects
+  m_streamMgr->waitForCmd(*cmd);
+  std::lock_guard<std::recursive_mutex> lock(pimSim::get()->getExecMutex());
+
+  // defer element-wise commands while capturing an API fusion program
+  if (m_fuseCmd) {
+    if (cmd->isElementWise()) {
+      return m_fuseCmd->capture(std::move(cmd));
+    }
+    if (!m_fuseCmd->flush()) {
+      return false;
+    }
+  }
+
   bool ok = cmd->execute();
 
   return ok;
@@ -9,12 +9,14 @@
 #include "pimCore.h"
 #include "pimCmd.h"
 #include "pimPerfEnergyBase.h"
+#include "pimStream.h"
 #ifdef DRAMSIM3_INTEG
 #include "cpu.h"
 #endif
 #include <memory>
 
 class pimResMgr;
+class pimCmdFuse;
 
 
 //! @class  pimDevice
@@ -29,6 +31,7 @@ public:
 
   PimDeviceEnum getDeviceType() const { return m_config.getDeviceType(); }
   PimDeviceEnum getSimTarget() const { return m_config.getSimTarget(); }
+  bool isAnalysisMode() const { return m_config.isAnalysisMode(); }
   unsigned getNumRanks() const { return m_config.getNumRanks(); }
   unsigned getNumBankPerRank() const { return m_config.getNumBankPerRank(); }
   unsigned getNumSubarrayPerBank() const { return m_config.getNumSubarrayPerBank(); }
@@ -52,17 +55,28 @@ public:
   bool pimFree(PimObjId obj);
   PimObjId pimCreateRangedRef(PimObjId refId, uint64_t idxBegin, uint64_t idxEnd);
   PimObjId pimCreateDualContactRef(PimObjId refId);
+  PimObjId pimAllocFromHostBuffer(PimAllocEnum allocType, uint64_t numElements, PimDataType dataType, void* hostBuffer);
+  bool pimRegisterHostBuffer(PimObjId obj, void* hostBuffer);
+  bool pimMarkHostBufferModified(PimObjId obj);
 
   bool pimCopyMainToDevice(void* src, PimObjId dest, uint64_t idxBegin = 0, uint64_t idxEnd = 0);
   bool pimCopyDeviceToMain(PimObjId src, void* dest, uint64_t idxBegin = 0, uint64_t idxEnd = 0);
   bool pimCopyMainToDeviceWithType(PimCopyEnum copyType, void* src, PimObjId dest, uint64_t idxBegin = 0, uint64_t idxEnd = 0);
   bool pimCopyDeviceToMainWithType(PimCopyEnum copyType, PimObjId src, void* dest, uint64_t idxBegin = 0, uint64_t idxEnd = 0);
+  bool pimCopyMainToDevice2D(void* src, PimObjId dest, const pimHostLayout& srcLayout, uint64_t idxBegin = 0, uint64_t idxEnd = 0);
+  bool pimCopyDeviceToMain2D(PimObjId src, void* dest, const pimHostLayout& destLayout, uint64_t idxBegin = 0, uint64_t idxEnd = 0);
+  bool pimCopyMainToDeviceBatch(const PimCopyDesc* descs, uint64_t numDescs);
+  bool pimCopyDeviceToMainBatch(const PimCopyDesc* descs, uint64_t numDescs);
   bool pimCopyDeviceToDevice(PimObjId src, PimObjId dest, uint64_t idxBegin = 0, uint64_t idxEnd = 0);
 
   pimResMgr* getResMgr() { return m_resMgr.get(); }
+  pimStreamMgr* getStreamMgr() { return m_streamMgr.get(); }
   pimPerfEnergyBase* getPerfEnergyModel() { return m_perfEnergyModel.get(); }
   pimCore& getCore(PimCoreId coreId) { return m_cores[coreId]; }
+  bool hasSimulatedMem() const { return !m_cores.empty(); }
   bool executeCmd(std::unique_ptr<pimCmd> cmd);
+  pimCmdFuse* getFuseCmd() const { return m_fuseCmd; }
+  void setFuseCmd(pimCmdFuse* fuseCmd) { m_fuseCmd = fuseCmd; }
 
 private:
   bool init();
@@ -78,6 +92,8 @@ private:
   std::unique_ptr<pimResMgr> m_resMgr;
   std::unique_ptr<pimPerfEnergyBase> m_perfEnergyModel;
   std::vector<pimCore> m_cores;
+  pimCmdFuse* m_fuseCmd = nullptr;  // API fusion program being captured
+  std::unique_ptr<pimStreamMgr> m_streamMgr;
 
 #ifdef DRAMSIM3_INTEG
   dramsim3::PIMCPU* m_hostMemory = nullptr;
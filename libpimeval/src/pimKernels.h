@@ -0,0 +1,320 @@
+// File: pimKernels.h
+// PIMeval Simulator - Type- and Opcode-Specialized Functional Kernels
+
+#ifndef LAVA_PIM_KERNELS_H
+#define LAVA_PIM_KERNELS_H
+
+#include "libpimeval.h"      // for PimDataType
+#include "pimCmd.h"          // for PimCmdEnum
+#include "pimUtils.h"        // for PimSimdIsa, castBitsToType
+#include <algorithm>         // for min, max, find
+#include <bitset>            // for bitset
+#include <cstdint>           // for uint64_t
+#include <cstdio>            // for printf
+#include <type_traits>       // for conditional_t, is_floating_point_v
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define PIM_KERNEL_X86_SIMD
+#define PIM_KERNEL_INLINE inline __attribute__((always_inline))
+#define PIM_KERNEL_TARGET_AVX2 __attribute__((target("avx2,popcnt")))
+#define PIM_KERNEL_TARGET_AVX512 __attribute__((target("avx512f,avx512bw,avx512dq,avx512vl,popcnt")))
+#else
+#define PIM_KERNEL_INLINE inline
+#endif
+
+
+//! @brief  Functional kernels over contiguous typed spans of PIM object data holders
+//! - Each (element type, command) pair instantiates its own inner loop, so that type and opcode
+//!   dispatching happens once per region instead of once per element
+//! - Operands are widened the same way as the generic per-element path, i.e., int64_t for signed,
+//!   uint64_t for unsigned and float for floating point, then narrowed to the dest element type
+//! - Inner loops are written to be auto-vectorized, and each loop is compiled for every SIMD ISA
+//!   level. The best level supported by host CPU is selected at runtime, with scalar code as fallback
+namespace pimKernels
+{
+  template <typename T>
+  using computeType = std::conditional_t<std::is_floating_point_v<T>, float,
+                                         std::conditional_t<std::is_signed_v<T>, int64_t, uint64_t>>;
+
+  //! @brief  Check if a functional command writes PIM_BOOL results
+  constexpr bool
+  isBoolResultCmd(PimCmdEnum cmdType)
+  {
+    switch (cmdType) {
+      case PimCmdEnum::GT: case PimCmdEnum::LT: case PimCmdEnum::EQ: case PimCmdEnum::NE:
+      case PimCmdEnum::GT_SCALAR: case PimCmdEnum::LT_SCALAR: case PimCmdEnum::EQ_SCALAR: case PimCmdEnum::NE_SCALAR:
+        return true;
+      default:
+        break;
+    }
+    return false;
+  }
+
+  //! @brief  Interpret scalar value bits as the compute type
+  template <typename C>
+  PIM_KERNEL_INLINE C
+  scalarFromBits(uint64_t bits)
+  {
+    if constexpr (std::is_floating_point_v<C>) {
+      return pimUtils::castBitsToType<float>(bits);
+    } else {
+      return static_cast<C>(bits);
+    }
+  }
+
+  //! @brief  Narrow a result to dest element type. FP results written to PIM_BOOL are tested for > 0
+  template <typename TDest, typename C>
+  PIM_KERNEL_INLINE TDest
+  narrowResult(C result)
+  {
+    if constexpr (std::is_floating_point_v<C> && !std::is_floating_point_v<TDest>) {
+      return static_cast<TDest>(result > 0);
+    } else {
+      return static_cast<TDest>(result);
+    }
+  }
+
+  //! @brief  Element operation of 1-operand functional commands
+  template <PimCmdEnum Op, typename T, typename C>
+  PIM_KERNEL_INLINE C
+  func1Op(C operand, C scalar)
+  {
+    if constexpr (Op == PimCmdEnum::COPY_O2O) { return operand; }
+    else if constexpr (Op == PimCmdEnum::ADD_SCALAR) { return operand + scalar; }
+    else if constexpr (Op == PimCmdEnum::SUB_SCALAR) { return operand - scalar; }
+    else if constexpr (Op == PimCmdEnum::MUL_SCALAR) { return operand * scalar; }
+    else if constexpr (Op == PimCmdEnum::DIV_SCALAR) { return operand / scalar; }
+    else if constexpr (Op == PimCmdEnum::NOT) { return ~operand; }
+    else if constexpr (Op == PimCmdEnum::AND_SCALAR) { return operand & scalar; }
+    else if constexpr (Op == PimCmdEnum::OR_SCALAR) { return operand | scalar; }
+    else if constexpr (Op == PimCmdEnum::XOR_SCALAR) { return operand ^ scalar; }
+    else if constexpr (Op == PimCmdEnum::XNOR_SCALAR) { return ~(operand ^ scalar); }
+    else if constexpr (Op == PimCmdEnum::GT_SCALAR) { return operand > scalar ? 1 : 0; }
+    else if constexpr (Op == PimCmdEnum::LT_SCALAR) { return operand < scalar ? 1 : 0; }
+    else if constexpr (Op == PimCmdEnum::EQ_SCALAR) { return operand == scalar ? 1 : 0; }
+    else if constexpr (Op == PimCmdEnum::NE_SCALAR) { return operand != scalar ? 1 : 0; }
+    else if constexpr (Op == PimCmdEnum::MIN_SCALAR) { return operand < scalar ? operand : scalar; }
+    else if constexpr (Op == PimCmdEnum::MAX_SCALAR) { return operand > scalar ? operand : scalar; }
+    else if constexpr (Op == PimCmdEnum::POPCOUNT) {
+      return std::bitset<sizeof(T) * 8>(static_cast<std::make_unsigned_t<T>>(operand)).count();
+    }
+    else if constexpr (Op == PimCmdEnum::SHIFT_BITS_R) { return operand >> static_cast<uint64_t>(scalar); }
+    else if constexpr (Op == PimCmdEnum::SHIFT_BITS_L) { return operand << static_cast<uint64_t>(scalar); }
+    else if constexpr (Op == PimCmdEnum::ABS) {
+      if constexpr (std::is_signed_v<C>) {
+        return operand < 0 ? -operand : operand;
+      } else {
+        return operand;
+      }
+    } else {
+      static_assert(Op == PimCmdEnum::COPY_O2O, "unsupported 1-operand kernel");
+    }
+  }
+
+  //! @brief  Element operation of 2-operand functional commands
+  template <PimCmdEnum Op, typename C>
+  PIM_KERNEL_INLINE C
+  func2Op(C operand1, C operand2, C scalar)
+  {
+    if constexpr (Op == PimCmdEnum::ADD) { return operand1 + operand2; }
+    else if constexpr (Op == PimCmdEnum::SUB) { return operand1 - operand2; }
+    else if constexpr (Op == PimCmdEnum::MUL) { return operand1 * operand2; }
+    else if constexpr (Op == PimCmdEnum::DIV) { return operand1 / operand2; }
+    else if constexpr (Op == PimCmdEnum::AND) { return operand1 & operand2; }
+    else if constexpr (Op == PimCmdEnum::OR) { return operand1 | operand2; }
+    else if constexpr (Op == PimCmdEnum::XOR) { return operand1 ^ operand2; }
+    else if constexpr (Op == PimCmdEnum::XNOR) { return ~(operand1 ^ operand2); }
+    else if constexpr (Op == PimCmdEnum::GT) { return operand1 > operand2 ? 1 : 0; }
+    else if constexpr (Op == PimCmdEnum::LT) { return operand1 < operand2 ? 1 : 0; }
+    else if constexpr (Op == PimCmdEnum::EQ) { return operand1 == operand2 ? 1 : 0; }
+    else if constexpr (Op == PimCmdEnum::NE) { return operand1 != operand2 ? 1 : 0; }
+    else if constexpr (Op == PimCmdEnum::MIN) { return operand1 < operand2 ? operand1 : operand2; }
+    else if constexpr (Op == PimCmdEnum::MAX) { return operand1 > operand2 ? operand1 : operand2; }
+    else if constexpr (Op == PimCmdEnum::SCALED_ADD) { return operand1 * scalar + operand2; }
+    else {
+      static_assert(Op == PimCmdEnum::ADD, "unsupported 2-operand kernel");
+    }
+  }
+
+  //! @brief  Inner loop of 1-operand kernels
+  template <PimCmdEnum Op, typename T, typename TDest, typename C>
+  PIM_KERNEL_INLINE void
+  func1Loop(const T* src, TDest* dest, uint64_t numElements, C scalar)
+  {
+    for (uint64_t i = 0; i < numElements; ++i) {
+      dest[i] = narrowResult<TDest>(func1Op<Op, T>(static_cast<C>(src[i]), scalar));
+    }
+  }
+
+  //! @brief  Inner loop of 2-operand kernels. Return number of elements computed, which stops at
+  //!         the first zero divisor of DIV. The zero test is a separate any-of loop to keep the
+  //!         common case vectorizable
+  template <PimCmdEnum Op, typename T, typename TDest, typename C>
+  PIM_KERNEL_INLINE uint64_t
+  func2Loop(const T* src1, const T* src2, TDest* dest, uint64_t numElements, C scalar)
+  {
+    uint64_t numValid = numElements;
+    if constexpr (Op == PimCmdEnum::DIV) {
+      bool hasZero = false;
+      for (uint64_t i = 0; i < numElements; ++i) {
+        hasZero |= (src2[i] == 0);
+      }
+      if (hasZero) {
+        numValid = std::find(src2, src2 + numElements, T(0)) - src2;
+      }
+    }
+    for (uint64_t i = 0; i < numValid; ++i) {
+      dest[i] = narrowResult<TDest>(func2Op<Op>(static_cast<C>(src1[i]), static_cast<C>(src2[i]), scalar));
+    }
+    return numValid;
+  }
+
+  //! @brief  Inner loop of conditional operations on raw element bits
+  template <PimCmdEnum Op, typename U>
+  PIM_KERNEL_INLINE void
+  condLoop(const uint8_t* cond, const U* src1, const U* src2, U* dest, uint64_t numElements, U scalar)
+  {
+    for (uint64_t i = 0; i < numElements; ++i) {
+      if constexpr (Op == PimCmdEnum::COND_COPY) { dest[i] = cond[i] ? src1[i] : dest[i]; }
+      else if constexpr (Op == PimCmdEnum::COND_BROADCAST) { dest[i] = cond[i] ? scalar : dest[i]; }
+      else if constexpr (Op == PimCmdEnum::COND_SELECT) { dest[i] = cond[i] ? src1[i] : src2[i]; }
+      else if constexpr (Op == PimCmdEnum::COND_SELECT_SCALAR) { dest[i] = cond[i] ? src1[i] : scalar; }
+    }
+  }
+
+#ifdef PIM_KERNEL_X86_SIMD
+  //! @brief  Compile an inlined kernel body for AVX-512
+  template <typename F>
+  PIM_KERNEL_TARGET_AVX512 auto
+  runAvx512(F&& body)
+  {
+    return body();
+  }
+
+  //! @brief  Compile an inlined kernel body for AVX2
+  template <typename F>
+  PIM_KERNEL_TARGET_AVX2 auto
+  runAvx2(F&& body)
+  {
+    return body();
+  }
+#endif
+
+  //! @brief  Run a kernel body with a SIMD ISA level. The body must be an always-inline lambda so
+  //!         that it is compiled with the target ISA of the caller
+  template <typename F>
+  inline auto
+  runSimd(PimSimdIsa isa, F&& body)
+  {
+#ifdef PIM_KERNEL_X86_SIMD
+    switch (isa) {
+      case PimSimdIsa::AVX512: return runAvx512(body);
+      case PimSimdIsa::AVX2: return runAvx2(body);
+      case PimSimdIsa::SCALAR: break;
+    }
+#endif
+    return body();
+  }
+
+#ifdef PIM_KERNEL_X86_SIMD
+#define PIM_KERNEL_BODY [&]() __attribute__((always_inline))
+#else
+#define PIM_KERNEL_BODY [&]()
+#endif
+
+  //! @brief  1-operand kernel over elements [idxBegin, idxBegin + numElements)
+  template <PimCmdEnum Op, typename T>
+  bool
+  func1Kernel(PimSimdIsa isa, const T* src, pimObjInfo& objDest, uint64_t idxBegin, uint64_t numElements, uint64_t scalarBits)
+  {
+    using C = computeType<T>;
+    using TDest = std::conditional_t<isBoolResultCmd(Op), uint8_t, T>;
+    const C scalar = scalarFromBits<C>(scalarBits);
+    if constexpr (Op == PimCmdEnum::DIV_SCALAR) {
+      if (scalar == 0 && numElements > 0) {
+        std::printf("PIM-Error: Division by zero\n");
+        return false;
+      }
+    }
+    const T* srcSpan = src + idxBegin;
+    TDest* destSpan = objDest.getTypedData<TDest>() + idxBegin;
+    runSimd(isa, PIM_KERNEL_BODY { func1Loop<Op, T, TDest, C>(srcSpan, destSpan, numElements, scalar); });
+    return true;
+  }
+
+  //! @brief  2-operand kernel over elements [idxBegin, idxBegin + numElements)
+  template <PimCmdEnum Op, typename T>
+  bool
+  func2Kernel(PimSimdIsa isa, const T* src1, const T* src2, pimObjInfo& objDest, uint64_t idxBegin, uint64_t numElements, uint64_t scalarBits)
+  {
+    using C = computeType<T>;
+    using TDest = std::conditional_t<isBoolResultCmd(Op), uint8_t, T>;
+    const C scalar = scalarFromBits<C>(scalarBits);
+    const T* src1Span = src1 + idxBegin;
+    const T* src2Span = src2 + idxBegin;
+    TDest* destSpan = objDest.getTypedData<TDest>() + idxBegin;
+    uint64_t numValid = runSimd(isa, PIM_KERNEL_BODY {
+      return func2Loop<Op, T, TDest, C>(src1Span, src2Span, destSpan, numElements, scalar);
+    });
+    if (numValid < numElements) {
+      std::printf("PIM-Error: Division by zero\n");
+      return false;
+    }
+    return true;
+  }
+
+  //! @brief  Conditional operation kernel over elements [idxBegin, idxBegin + numElements)
+  template <PimCmdEnum Op, typename U>
+  bool
+  condKernel(PimSimdIsa isa, const uint8_t* cond, const U* src1, const U* src2, U* dest, uint64_t idxBegin, uint64_t numElements, uint64_t scalarBits)
+  {
+    const U scalar = static_cast<U>(scalarBits);
+    const uint8_t* condSpan = cond + idxBegin;
+    const U* src1Span = src1 ? src1 + idxBegin : nullptr;
+    const U* src2Span = src2 ? src2 + idxBegin : nullptr;
+    U* destSpan = dest + idxBegin;
+    runSimd(isa, PIM_KERNEL_BODY { condLoop<Op, U>(condSpan, src1Span, src2Span, destSpan, numElements, scalar); });
+    return true;
+  }
+
+#undef PIM_KERNEL_BODY
+
+  //! @brief  Dispatch a computation on PIM data type, with the host element type passed as a value tag
+  //!         Return false if the data type has no specialized kernels
+  template <typename F>
+  bool
+  dispatchDataType(PimDataType dataType, F&& func)
+  {
+    switch (dataType) {
+      case PIM_BOOL: func(uint8_t()); return true;
+      case PIM_INT8: func(int8_t()); return true;
+      case PIM_INT16: func(int16_t()); return true;
+      case PIM_INT32: func(int32_t()); return true;
+      case PIM_INT64: func(int64_t()); return true;
+      case PIM_UINT8: func(uint8_t()); return true;
+      case PIM_UINT16: func(uint16_t()); return true;
+      case PIM_UINT32: func(uint32_t()); return true;
+      case PIM_UINT64: func(uint64_t()); return true;
+      case PIM_FP32: case PIM_FP16: case PIM_BF16: case PIM_FP8: func(float()); return true;
+      case PIM_DATA_TYPE_MAX: break;
+    }
+    return false;
+  }
+
+  //! @brief  Dispatch a computation on element size in bytes, with a raw bits type passed as a value tag
+  //!         Return false if the element size has no specialized kernels
+  template <typename F>
+  bool
+  dispatchBitsType(unsigned bytesPerElement, F&& func)
+  {
+    switch (bytesPerElement) {
+      case 1: func(uint8_t()); return true;
+      case 2: func(uint16_t()); return true;
+      case 4: func(uint32_t()); return true;
+      case 8: func(uint64_t()); return true;
+    }
+    return false;
+  }
+}
+
+#endif
@@ -0,0 +1,239 @@
+// File: pimMemPool.cpp
+// PIMeval Simulator - Pooled Host Memory for PIM Object Data
+
+#include "pimMemPool.h"
+#include <sys/mman.h>        // for mmap, munmap, madvise
+#include <algorithm>         // for max
+#include <cstdlib>           // for calloc, free
+#include <cstring>           // for memset, memcpy
+#include <new>               // for bad_alloc
+#include <utility>           // for swap
+
+//! @brief  Get the pimMemPool singleton
+pimMemPool&
+pimMemPool::get()
+{
+  static pimMemPool pool;
+  return pool;
+}
+
+//! @brief  Set the max number of bytes kept for reuse and the huge page mode of new buffers
+void
+pimMemPool::configure(uint64_t maxPooledBytes, PimHugePageMode hugePageMode)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_maxPooledBytes = maxPooledBytes;
+  m_hugePageMode = hugePageMode;
+}
+
+//! @brief  Get a buffer of at least numBytes. Return nullptr if out of memory
+void*
+pimMemPool::acquire(uint64_t numBytes, uint64_t& capacity, bool& isZeroed)
+{
+  capacity = getSizeClass(numBytes);
+  if (capacity < s_minMappedBytes) {
+    isZeroed = true;
+    return std::calloc(capacity, 1);
+  }
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_freeBuffers.find(capacity);
+    if (it != m_freeBuffers.end() && !it->second.empty()) {
+      void* ptr = it->second.back();
+      it->second.pop_back();
+      m_numPooledBytes -= capacity;
+      isZeroed = false;
+      return ptr;
+    }
+  }
+  isZeroed = true;
+  return mapBuffer(capacity);
+}
+
+//! @brief  Return a buffer. It is kept for reuse if the pool has room
+void
+pimMemPool::release(void* ptr, uint64_t capacity)
+{
+  if (capacity < s_minMappedBytes) {
+    std::free(ptr);
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_numPooledBytes + capacity <= m_maxPooledBytes) {
+      m_freeBuffers[capacity].push_back(ptr);
+      m_numPooledBytes += capacity;
+      return;
+    }
+  }
+  unmapBuffer(ptr, capacity);
+}
+
+//! @brief  Unmap all buffers kept for reuse
+void
+pimMemPool::trim()
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  for (auto& [capacity, buffers] : m_freeBuffers) {
+    for (void* ptr : buffers) {
+      unmapBuffer(ptr, capacity);
+    }
+  }
+  m_freeBuffers.clear();
+  m_numPooledBytes = 0;
+}
+
+//! @brief  Round up a size to its size class
+//!         Classes are a quarter of a power of two apart, and huge page aligned above huge page size
+uint64_t
+pimMemPool::getSizeClass(uint64_t numBytes)
+{
+  if (numBytes < s_minMappedBytes) {
+    return std::max<uint64_t>(numBytes, 1);
+  }
+  uint64_t highBit = uint64_t(1) << (63 - __builtin_clzll(numBytes));
+  uint64_t step = std::max(highBit / 4, s_pageBytes);
+  if (numBytes >= s_hugePageBytes) {
+    step = std::max(step, s_hugePageBytes);
+  }
+  return (numBytes + step - 1) / step * step;
+}
+
+//! @brief  Map a new zeroed buffer
+void*
+pimMemPool::mapBuffer(uint64_t capacity) const
+{
+  const int prot = PROT_READ | PROT_WRITE;
+  const int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+#ifdef MAP_HUGETLB
+  // fall back to regular pages if no huge pages are reserved
+  if (m_hugePageMode == PimHugePageMode::HUGETLB && capacity % s_hugePageBytes == 0) {
+    void* ptr = mmap(nullptr, capacity, prot, flags | MAP_HUGETLB, -1, 0);
+    if (ptr != MAP_FAILED) {
+      return ptr;
+    }
+  }
+#endif
+  if (m_hugePageMode == PimHugePageMode::NONE || capacity < s_hugePageBytes) {
+    void* ptr = mmap(nullptr, capacity, prot, flags, -1, 0);
+    return ptr == MAP_FAILED ? nullptr : ptr;
+  }
+
+  // align to huge page size so that transparent huge pages can back the whole buffer
+  uint64_t numMappedBytes = capacity + s_hugePageBytes;
+  void* mapped = mmap(nullptr, numMappedBytes, prot, flags, -1, 0);
+  if (mapped == MAP_FAILED) {
+    return nullptr;
+  }
+  uintptr_t begin = reinterpret_cast<uintptr_t>(mapped);
+  uintptr_t alignedBegin = (begin + s_hugePageBytes - 1) / s_hugePageBytes * s_hugePageBytes;
+  if (alignedBegin > begin) {
+    munmap(mapped, alignedBegin - begin);
+  }
+  uintptr_t alignedEnd = alignedBegin + capacity;
+  uintptr_t end = begin + numMappedBytes;
+  if (end > alignedEnd) {
+    munmap(reinterpret_cast<void*>(alignedEnd), end - alignedEnd);
+  }
+  void* ptr = reinterpret_cast<void*>(alignedBegin);
+#ifdef MADV_HUGEPAGE
+  madvise(ptr, capacity, MADV_HUGEPAGE);
+#endif
+  return ptr;
+}
+
+//! @brief  Unmap a buffer
+void
+pimMemPool::unmapBuffer(void* ptr, uint64_t capacity)
+{
+  munmap(ptr, capacity);
+}
+
+
+//! @brief  pimPooledBuffer ctor
+pimPooledBuffer::pimPooledBuffer(uint64_t numBytes)
+{
+  if (numBytes == 0) {
+    return;
+  }
+  bool isZeroed = false;
+  m_ptr = static_cast<uint8_t*>(pimMemPool::get().acquire(numBytes, m_capacity, isZeroed));
+  if (!m_ptr) {
+    throw std::bad_alloc();
+  }
+  m_numBytes = numBytes;
+  m_isZeroPending.store(!isZeroed, std::memory_order_relaxed);
+}
+
+//! @brief  pimPooledBuffer copy ctor. A pending zero-fill is copied without touching any bytes
+pimPooledBuffer::pimPooledBuffer(const pimPooledBuffer& other)
+  : pimPooledBuffer(other.m_numBytes)
+{
+  if (m_ptr && !other.m_isZeroPending.load(std::memory_order_acquire)) {
+    m_isZeroPending.store(false, std::memory_order_relaxed);
+    std::memcpy(m_ptr, other.m_ptr, m_numBytes);
+  }
+}
+
+//! @brief  pimPooledBuffer move ctor
+pimPooledBuffer::pimPooledBuffer(pimPooledBuffer&& other) noexcept
+  : m_ptr(other.m_ptr),
+    m_numBytes(other.m_numBytes),
+    m_capacity(other.m_capacity),
+    m_isZeroPending(other.m_isZeroPending.load(std::memory_order_relaxed))
+{
+  other.m_ptr = nullptr;
+  other.m_numBytes = 0;
+  other.m_capacity = 0;
+  other.m_isZeroPending.store(false, std::memory_order_relaxed);
+}
+
+//! @brief  pimPooledBuffer copy assignment
+pimPooledBuffer&
+pimPooledBuffer::operator=(const pimPooledBuffer& other)
+{
+  if (this != &other) {
+    *this = pimPooledBuffer(other);
+  }
+  return *this;
+}
+
+//! @brief  pimPooledBuffer move assignment
+pimPooledBuffer&
+pimPooledBuffer::operator=(pimPooledBuffer&& other) noexcept
+{
+  if (this != &other) {
+    reset();
+    std::swap(m_ptr, other.m_ptr);
+    std::swap(m_numBytes, other.m_numBytes);
+    std::swap(m_capacity, other.m_capacity);
+    m_isZeroPending.store(other.m_isZeroPending.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    other.m_isZeroPending.store(false, std::memory_order_relaxed);
+  }
+  return *this;
+}
+
+//! @brief  Return the buffer to the pool
+void
+pimPooledBuffer::reset()
+{
+  if (m_ptr) {
+    pimMemPool::get().release(m_ptr, m_capacity);
+  }
+  m_ptr = nullptr;
+  m_numBytes = 0;
+  m_capacity = 0;
+  m_isZeroPending.store(false, std::memory_order_relaxed);
+}
+
+//! @brief  Zero-fill a recycled buffer on first access. Threads accessing the buffer concurrently wait for one fill
+void
+pimPooledBuffer::zeroFill() const
+{
+  static std::mutex s_mutex;
+  std::lock_guard<std::mutex> lock(s_mutex);
+  if (m_isZeroPending.load(std::memory_order_relaxed)) {
+    std::memset(m_ptr, 0, m_numBytes);
+    m_isZeroPending.store(false, std::memory_order_release);
+  }
+}
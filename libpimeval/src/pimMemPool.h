@@ -0,0 +1,88 @@
+// File: pimMemPool.h
+// PIMeval Simulator - Pooled Host Memory for PIM Object Data
+
+#ifndef LAVA_PIM_MEM_POOL_H
+#define LAVA_PIM_MEM_POOL_H
+
+#include "pimUtils.h"        // for PimHugePageMode
+#include <atomic>            // for atomic
+#include <cstdint>           // for uint8_t, uint64_t
+#include <mutex>             // for mutex
+#include <unordered_map>     // for unordered_map
+#include <vector>            // for vector
+
+
+//! @class  pimMemPool
+//! @brief  Size-class pool of host buffers backing data holders of PIM objects
+//! Large buffers are mapped with mmap, optionally backed by huge pages, and recycled across alloc and free,
+//! so that kernels allocating temporaries every iteration do not pay page faults over and over.
+//! Small buffers are left to malloc. Freshly mapped buffers are zero, while recycled buffers are not
+class pimMemPool
+{
+public:
+  static pimMemPool& get();
+
+  void configure(uint64_t maxPooledBytes, PimHugePageMode hugePageMode);
+  void* acquire(uint64_t numBytes, uint64_t& capacity, bool& isZeroed);
+  void release(void* ptr, uint64_t capacity);
+  void trim();
+
+private:
+  pimMemPool() {}
+  ~pimMemPool() { trim(); }
+
+  static uint64_t getSizeClass(uint64_t numBytes);
+  void* mapBuffer(uint64_t capacity) const;
+  static void unmapBuffer(void* ptr, uint64_t capacity);
+
+  std::mutex m_mutex;
+  std::unordered_map<uint64_t, std::vector<void*>> m_freeBuffers;  // size class to recycled buffers
+  uint64_t m_numPooledBytes = 0;
+  uint64_t m_maxPooledBytes = 0;
+  PimHugePageMode m_hugePageMode = PimHugePageMode::NONE;
+
+  static constexpr uint64_t s_minMappedBytes = 64 * 1024;  // smaller buffers use malloc
+  static constexpr uint64_t s_pageBytes = 4 * 1024;
+  static constexpr uint64_t s_hugePageBytes = 2 * 1024 * 1024;
+};
+
+
+//! @class  pimPooledBuffer
+//! @brief  A byte buffer from pimMemPool
+//! Zero-fill of a recycled buffer is deferred to its first access, and skipped with discardForOverwrite()
+//! if the first use overwrites the whole buffer, e.g., a full host-to-device copy or a broadcast
+class pimPooledBuffer
+{
+public:
+  pimPooledBuffer() {}
+  explicit pimPooledBuffer(uint64_t numBytes);
+  ~pimPooledBuffer() { reset(); }
+  pimPooledBuffer(const pimPooledBuffer& other);
+  pimPooledBuffer(pimPooledBuffer&& other) noexcept;
+  pimPooledBuffer& operator=(const pimPooledBuffer& other);
+  pimPooledBuffer& operator=(pimPooledBuffer&& other) noexcept;
+
+  uint8_t* data() {
+    if (m_isZeroPending.load(std::memory_order_acquire)) { zeroFill(); }
+    return m_ptr;
+  }
+  const uint8_t* data() const {
+    if (m_isZeroPending.load(std::memory_order_acquire)) { zeroFill(); }
+    return m_ptr;
+  }
+  uint64_t size() const { return m_numBytes; }
+
+  // caller guarantees that all bytes are written before being read
+  void discardForOverwrite() { m_isZeroPending.store(false, std::memory_order_release); }
+  void reset();
+
+private:
+  void zeroFill() const;
+
+  uint8_t* m_ptr = nullptr;
+  uint64_t m_numBytes = 0;
+  uint64_t m_capacity = 0;
+  mutable std::atomic<bool> m_isZeroPending{false};
+};
+
+#endif
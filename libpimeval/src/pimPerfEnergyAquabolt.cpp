@@ -5,6 +5,7 @@
 #include "pimCmd.h"
 #include <cstdio>
 #include <cmath>
+#include <algorithm>
 
 // Aquabolt adds a SIMD FPU shared between two banks, with only one bank accessing it at a time.
 // The supported FPU instructions are: ADD, MUL, MAC, and RELU. However, RELU is currently not implemented in the simulator.
@@ -268,3 +269,93 @@ pimPerfEnergyAquabolt::getPerfEnergyForRotate(PimCmdEnum cmdType, const pimObjIn
 
   return pimeval::perfEnergy(msRuntime, mjEnergy, msRead, msWrite, msCompute, totalOp);
 }
+
+//! @brief  Perf energy model of aquabolt PIM for fused element-wise commands
+//!         A fused sweep processes one column block of all commands at a time, keeping vectors in GRF.
+//!         Compared with standalone commands:
+//!         - A source already loaded into GRF by an earlier command needs no row re-activation
+//!         - A dest overwritten by a later command needs no row write-back
+//!         Credits are not applied if the vectors of a column block do not fit in GRF,
+//!         or if any command is not modeled for aquabolt, i.e., has zero runtime or energy
+pimeval::perfEnergy
+pimPerfEnergyAquabolt::getPerfEnergyForFused(const std::vector<pimeval::fusedOp>& ops, const pimObjInfo& obj) const
+{
+  std::vector<PimObjId> objIds;
+  for (const auto& op : ops) {
+    for (PimObjId objId : op.m_srcIds) {
+      if (std::find(objIds.begin(), objIds.end(), objId) == objIds.end()) {
+        objIds.push_back(objId);
+      }
+    }
+    if (std::find(objIds.begin(), objIds.end(), op.m_destId) == objIds.end()) {
+      objIds.push_back(op.m_destId);
+    }
+  }
+  bool isModeled = std::all_of(ops.begin(), ops.end(), [](const pimeval::fusedOp& op) {
+    return op.m_perfEnergy.m_msRuntime > 0.0 && op.m_perfEnergy.m_mjEnergy > 0.0;
+  });
+  if (ops.size() < 2 || objIds.size() > m_aquaboltNumGRF || !isModeled) {
+    return pimPerfEnergyBase::getPerfEnergyForFused(ops, obj);
+  }
+
+  unsigned numPass = obj.getMaxNumRegionsPerCore();
+  unsigned bitsPerElement = obj.getBitsPerElement(PimBitWidth::ACTUAL);
+  unsigned numCoresUsed = obj.getNumCoreAvailable();
+  unsigned maxElementsPerRegion = obj.getMaxElementsPerRegion();
+  unsigned elementsPerCore = std::ceil(obj.getNumElements() * 1.0 / numCoresUsed);
+  unsigned minElementPerRegion = elementsPerCore > maxElementsPerRegion ? elementsPerCore - (maxElementsPerRegion * (numPass - 1)) : elementsPerCore;
+  unsigned maxGDLItr = std::ceil(maxElementsPerRegion * bitsPerElement * 1.0 / m_GDLWidth);
+  unsigned minGDLItr = std::ceil(minElementPerRegion * bitsPerElement * 1.0 / m_GDLWidth);
+  unsigned numActPre = std::ceil(maxElementsPerRegion * bitsPerElement * 1.0 / (8 * 256));
+  unsigned numBankPerChip = numCoresUsed / m_numChipsPerRank;
+
+  // cost of reading or writing one vector through row buffer
+  double msRowAccess = (m_tACT + m_tPRE) * numPass * numActPre;
+  double msWriteBack = msRowAccess + (maxGDLItr * m_tGDL * (numPass - 1)) + (minGDLItr * m_tGDL);
+  double mjRowAccess = (m_eACT + m_ePRE) * numActPre * numPass * numCoresUsed;
+  double mjWriteBack = mjRowAccess + (m_eW * maxGDLItr * (numPass - 1) * numBankPerChip * m_numRanks + (m_eW * minGDLItr * numBankPerChip * m_numRanks));
+
+  pimeval::perfEnergy total;
+  std::vector<PimObjId> loadedIds;
+  for (size_t i = 0; i < ops.size(); ++i) {
+    pimeval::perfEnergy pe = ops[i].m_perfEnergy;
+    double msSaved = 0.0;
+    double mjSaved = 0.0;
+    for (PimObjId objId : ops[i].m_srcIds) {
+      if (std::find(loadedIds.begin(), loadedIds.end(), objId) != loadedIds.end()) {
+        double ms = std::min(msRowAccess, pe.m_msRead);
+        double mj = std::min(mjRowAccess, pe.m_mjEnergy - mjSaved);
+        pe.m_msRead -= ms;
+        msSaved += ms;
+        mjSaved += mj;
+      } else {
+        loadedIds.push_back(objId);
+      }
+    }
+    bool isOverwritten = false;
+    for (size_t j = i + 1; j < ops.size(); ++j) {
+      isOverwritten = isOverwritten || ops[j].m_destId == ops[i].m_destId;
+    }
+    if (isOverwritten) {
+      double ms = std::min(msWriteBack, pe.m_msWrite);
+      double mj = std::min(mjWriteBack, pe.m_mjEnergy - mjSaved);
+      pe.m_msWrite -= ms;
+      msSaved += ms;
+      mjSaved += mj;
+    }
+    if (std::find(loadedIds.begin(), loadedIds.end(), ops[i].m_destId) == loadedIds.end()) {
+      loadedIds.push_back(ops[i].m_destId);
+    }
+    mjSaved += std::min(m_pBChip * m_numChipsPerRank * m_numRanks * msSaved, pe.m_mjEnergy - mjSaved);
+    pe.m_msRuntime -= msSaved;
+    pe.m_mjEnergy -= mjSaved;
+
+    total.m_msRuntime += pe.m_msRuntime;
+    total.m_mjEnergy += pe.m_mjEnergy;
+    total.m_msRead += pe.m_msRead;
+    total.m_msWrite += pe.m_msWrite;
+    total.m_msCompute += pe.m_msCompute;
+    total.m_totalOp += pe.m_totalOp;
+  }
+  return total;
+}
@@ -16,7 +16,8 @@
 class pimPerfEnergyAquabolt : public pimPerfEnergyBase
 {
 public:
-  pimPerfEnergyAquabolt(const pimPerfEnergyModelParams& params) : pimPerfEnergyBase(params) {}
+  // Model results only depend on command shapes, so opt in to memoization
+  pimPerfEnergyAquabolt(const pimPerfEnergyModelParams& params) : pimPerfEnergyBase(params) { m_isMemoized = true; }
   virtual ~pimPerfEnergyAquabolt() {}
 
   virtual pimeval::perfEnergy getPerfEnergyForFunc1(PimCmdEnum cmdType, const pimObjInfo& objSrc, const pimObjInfo& objDest) const override;
@@ -24,9 +25,13 @@ public:
   virtual pimeval::perfEnergy getPerfEnergyForReduction(PimCmdEnum cmdType, const pimObjInfo& obj, unsigned numPass) const override;
   virtual pimeval::perfEnergy getPerfEnergyForBroadcast(PimCmdEnum cmdType, const pimObjInfo& obj) const override;
   virtual pimeval::perfEnergy getPerfEnergyForRotate(PimCmdEnum cmdType, const pimObjInfo& obj) const override;
+  virtual pimeval::perfEnergy getPerfEnergyForFused(const std::vector<pimeval::fusedOp>& ops, const pimObjInfo& obj) const override;
+  //! @brief  Host accesses to banks are blocked while all banks are in PIM mode
+  virtual bool isCopyComputeOverlapSupported() const override { return false; }
   
 protected:
   unsigned m_aquaboltFPUBitWidth = 16;
+  unsigned m_aquaboltNumGRF = 16; // GRF_A and GRF_B vector registers per PIM core
   // TODO: Update for Aquabolt
   double m_aquaboltArithmeticEnergy = 0.0000000004992329586; // mJ
 };
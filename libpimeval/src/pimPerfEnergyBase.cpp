@@ -59,6 +59,7 @@ pimPerfEnergyBase::pimPerfEnergyBase(const pimPerfEnergyModelParams& params)
 pimeval::perfEnergy
 pimPerfEnergyBase::getPerfEnergyForBytesTransfer(PimCmdEnum cmdType, uint64_t numBytes) const
 {
+  PIM_PROBE_SCOPE("perfModel");
   //TODO: fine grain perf-energy modeling 
   double mjEnergy = 0.0;
   double msRead = 0.0;
@@ -185,3 +186,20 @@ pimPerfEnergyBase::getPerfEnergyForMac(PimCmdEnum cmdType, const pimObjInfo& obj
   uint64_t mTotalOP = 0;
   return pimeval::perfEnergy(msRuntime, mjEnergy, msRead, msWrite, msCompute, mTotalOP);
 }
+
+//! @brief  Perf energy model of base class for fused element-wise commands
+//!         Without device specific modeling, a fused sweep costs the same as its standalone commands
+pimeval::perfEnergy
+pimPerfEnergyBase::getPerfEnergyForFused(const std::vector<pimeval::fusedOp>& ops, const pimObjInfo& obj) const
+{
+  pimeval::perfEnergy total;
+  for (const auto& op : ops) {
+    total.m_msRuntime += op.m_perfEnergy.m_msRuntime;
+    total.m_mjEnergy += op.m_perfEnergy.m_mjEnergy;
+    total.m_msRead += op.m_perfEnergy.m_msRead;
+    total.m_msWrite += op.m_perfEnergy.m_msWrite;
+    total.m_msCompute += op.m_perfEnergy.m_msCompute;
+    total.m_totalOp += op.m_perfEnergy.m_totalOp;
+  }
+  return total;
+}
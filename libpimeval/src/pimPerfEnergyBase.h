@@ -8,8 +8,12 @@
 #include "pimParamsDram.h"             // for pimParamsDram
 #include "pimCmd.h"                    // for PimCmdEnum
 #include "pimResMgr.h"                 // for pimObjInfo
+#include "pimProbe.h"                  // for PIM_PROBE_SCOPE
 #include <cstdint>
 #include <memory>                      // for std::unique_ptr
+#include <vector>                      // for std::vector
+#include <unordered_map>               // for std::unordered_map
+#include <mutex>                       // for std::mutex
 
 
 namespace pimeval {
@@ -26,6 +30,61 @@ namespace pimeval {
       double m_msCompute;
       uint64_t m_totalOp;
   };
+
+  //! @brief  An element-wise command in a fused sweep, with its standalone performance and energy
+  struct fusedOp
+  {
+    PimCmdEnum m_cmdType;
+    std::vector<PimObjId> m_srcIds;
+    PimObjId m_destId;
+    perfEnergy m_perfEnergy;
+  };
+
+  //! @brief  Shape of a PIM command, which determines its modeled performance and energy
+  struct perfEnergyKey
+  {
+    perfEnergyKey(PimCmdEnum cmdType, const pimObjInfo& obj, PimDataType destDataType, unsigned numPass = 0)
+      : m_cmdType(cmdType),
+        m_dataType(obj.getDataType()),
+        m_destDataType(destDataType),
+        m_allocType(obj.getAllocType()),
+        m_numElements(obj.getNumElements()),
+        m_maxNumRegionsPerCore(obj.getMaxNumRegionsPerCore()),
+        m_numCoreAvailable(obj.getNumCoreAvailable()),
+        m_maxElementsPerRegion(obj.getMaxElementsPerRegion()),
+        m_numPass(numPass) {}
+
+    bool operator==(const perfEnergyKey& other) const {
+      return m_cmdType == other.m_cmdType && m_dataType == other.m_dataType && m_destDataType == other.m_destDataType &&
+             m_allocType == other.m_allocType && m_numElements == other.m_numElements &&
+             m_maxNumRegionsPerCore == other.m_maxNumRegionsPerCore && m_numCoreAvailable == other.m_numCoreAvailable &&
+             m_maxElementsPerRegion == other.m_maxElementsPerRegion && m_numPass == other.m_numPass;
+    }
+
+    PimCmdEnum m_cmdType;
+    PimDataType m_dataType;
+    PimDataType m_destDataType;
+    PimAllocEnum m_allocType;
+    uint64_t m_numElements;
+    unsigned m_maxNumRegionsPerCore;
+    unsigned m_numCoreAvailable;
+    unsigned m_maxElementsPerRegion;
+    unsigned m_numPass;  // reduction passes, 0 if not used by the model
+  };
+
+  struct perfEnergyKeyHash
+  {
+    size_t operator()(const perfEnergyKey& key) const {
+      uint64_t h = key.m_numElements;
+      for (uint64_t val : { static_cast<uint64_t>(key.m_cmdType), static_cast<uint64_t>(key.m_dataType),
+                            static_cast<uint64_t>(key.m_destDataType), static_cast<uint64_t>(key.m_allocType),
+                            static_cast<uint64_t>(key.m_maxNumRegionsPerCore), static_cast<uint64_t>(key.m_numCoreAvailable),
+                            static_cast<uint64_t>(key.m_maxElementsPerRegion), static_cast<uint64_t>(key.m_numPass) }) {
+        h ^= val + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+      }
+      return h;
+    }
+  };
 }
 
 //! @class  pimPerfEnergyModelParams
@@ -70,8 +129,43 @@ public:
   virtual pimeval::perfEnergy getPerfEnergyForRotate(PimCmdEnum cmdType, const pimObjInfo& obj) const;
   virtual pimeval::perfEnergy getPerfEnergyForPrefixSum(PimCmdEnum cmdType, const pimObjInfo& obj) const;
   virtual pimeval::perfEnergy getPerfEnergyForMac(PimCmdEnum cmdType, const pimObjInfo& obj) const;
+  virtual pimeval::perfEnergy getPerfEnergyForFused(const std::vector<pimeval::fusedOp>& ops, const pimObjInfo& obj) const;
+  //! @brief  Whether host-device data transfers of a stream can overlap with PIM computation
+  virtual bool isCopyComputeOverlapSupported() const { return true; }
+
+  //! @brief  Evaluate a model function, or return its memoized result for the same command shape
+  //!         Models opt in by setting m_isMemoized. A model must only depend on fields of the key
+  template <typename F>
+  pimeval::perfEnergy getMemoizedPerfEnergy(const pimeval::perfEnergyKey& key, F&& model) const
+  {
+    PIM_PROBE_SCOPE("perfModel");
+    if (!m_isMemoized) {
+      return model();
+    }
+    {
+      std::lock_guard<std::mutex> lock(m_cacheMutex);
+      auto it = m_cache.find(key);
+      if (it != m_cache.end()) {
+        ++m_numCacheHits;
+        return it->second;
+      }
+      ++m_numCacheMisses;
+    }
+    pimeval::perfEnergy result = model();
+    std::lock_guard<std::mutex> lock(m_cacheMutex);
+    if (m_cache.size() >= s_maxCacheEntries) {
+      m_cache.clear();
+    }
+    m_cache.emplace(key, result);
+    return result;
+  }
+  bool isMemoized() const { return m_isMemoized; }
+  uint64_t getNumCacheHits() const { return m_numCacheHits; }
+  uint64_t getNumCacheMisses() const { return m_numCacheMisses; }
+  void resetCacheStats() { m_numCacheHits = 0; m_numCacheMisses = 0; }
 
 protected:
+  bool m_isMemoized = false;
   PimDeviceEnum m_simTarget;
   unsigned m_numRanks;
   const pimParamsDram& m_paramsDram;
@@ -103,6 +197,13 @@ protected:
   unsigned m_tRCD; // RCD in cycles
   unsigned m_tRP; // RP in cycles
   unsigned m_tRAS; // RAS in cycles
+
+private:
+  mutable std::unordered_map<pimeval::perfEnergyKey, pimeval::perfEnergy, pimeval::perfEnergyKeyHash> m_cache;
+  mutable uint64_t m_numCacheHits = 0;
+  mutable uint64_t m_numCacheMisses = 0;
+  mutable std::mutex m_cacheMutex;
+  static constexpr size_t s_maxCacheEntries = 1 << 16;
 };
 
 #endif
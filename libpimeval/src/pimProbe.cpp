@@ -0,0 +1,173 @@
+// File: pimProbe.cpp
+// PIMeval Simulator - Hot-path Instrumentation Probes
+
+#include "pimProbe.h"
+#include <cstdio>            // for printf
+#include <map>               // for map
+#include <memory>            // for shared_ptr, make_shared
+#include <string>            // for string
+#include <utility>           // for pair
+
+namespace {
+  //! @brief  Global probe registry. Thread buffers outlive their threads for reporting
+  struct pimProbeRegistry
+  {
+    std::mutex m_mutex;
+    std::vector<std::string> m_names;
+    std::unordered_map<std::string, unsigned> m_nameToId;
+    std::vector<std::shared_ptr<void>> m_buffers;
+  };
+  pimProbeRegistry& getRegistry()
+  {
+    static pimProbeRegistry registry;
+    return registry;
+  }
+}
+
+//! @brief  Register a probe site. Sites with the same name share a probe ID
+unsigned
+pimProbeMgr::registerProbe(const char* name)
+{
+  pimProbeRegistry& registry = getRegistry();
+  std::lock_guard<std::mutex> lock(registry.m_mutex);
+  auto it = registry.m_nameToId.find(name);
+  if (it != registry.m_nameToId.end()) {
+    return it->second;
+  }
+  unsigned probeId = registry.m_names.size();
+  registry.m_names.push_back(name);
+  registry.m_nameToId.emplace(name, probeId);
+  return probeId;
+}
+
+//! @brief  Get probe ID of a tag with static storage. Cached per thread by tag pointer
+unsigned
+pimProbeMgr::getProbeIdOfTag(const char* tag)
+{
+  thread_local std::unordered_map<const char*, unsigned> t_probeIds;
+  auto it = t_probeIds.find(tag);
+  if (it != t_probeIds.end()) {
+    return it->second;
+  }
+  unsigned probeId = registerProbe(tag);
+  t_probeIds.emplace(tag, probeId);
+  return probeId;
+}
+
+//! @brief  Get ID of the outermost active probe of current thread, e.g., the API being called
+//!         Return s_invalidProbeId if probes are disabled or no probe is active
+unsigned
+pimProbeMgr::getRootProbeId()
+{
+  if (!isEnabled()) {
+    return s_invalidProbeId;
+  }
+  const threadBuffer& buffer = getThreadBuffer();
+  return buffer.m_frames.empty() ? s_invalidProbeId : buffer.m_frames.front().m_probeId;
+}
+
+//! @brief  Get stats buffer of current thread, registering it on first use
+pimProbeMgr::threadBuffer&
+pimProbeMgr::getThreadBuffer()
+{
+  thread_local std::shared_ptr<threadBuffer> t_buffer;
+  if (!t_buffer) {
+    t_buffer = std::make_shared<threadBuffer>();
+    t_buffer->m_frames.reserve(s_maxDepth);
+    pimProbeRegistry& registry = getRegistry();
+    std::lock_guard<std::mutex> lock(registry.m_mutex);
+    registry.m_buffers.push_back(t_buffer);
+  }
+  return *t_buffer;
+}
+
+//! @brief  Enter a probe scope. Return false if nesting is too deep
+bool
+pimProbeMgr::enter(unsigned probeId)
+{
+  threadBuffer& buffer = getThreadBuffer();
+  if (buffer.m_frames.size() >= s_maxDepth) {
+    return false;
+  }
+  buffer.m_frames.push_back({ probeId, getNsNow(), 0 });
+  return true;
+}
+
+//! @brief  Leave the innermost probe scope, and account its time to itself and its parent
+void
+pimProbeMgr::leave()
+{
+  uint64_t nsNow = getNsNow();
+  threadBuffer& buffer = getThreadBuffer();
+  probeFrame frame = buffer.m_frames.back();
+  buffer.m_frames.pop_back();
+  uint64_t nsElapsed = nsNow - frame.m_nsStart;
+  unsigned rootId = buffer.m_frames.empty() ? frame.m_probeId : buffer.m_frames.front().m_probeId;
+  if (!buffer.m_frames.empty()) {
+    buffer.m_frames.back().m_nsChildren += nsElapsed;
+  }
+  std::lock_guard<std::mutex> lock(buffer.m_mutex);
+  probeStat& stat = buffer.m_stats[(static_cast<uint64_t>(rootId) << 32) | frame.m_probeId];
+  ++stat.m_count;
+  stat.m_nsTotal += nsElapsed;
+  stat.m_nsChildren += frame.m_nsChildren;
+}
+
+//! @brief  Show host time of probes, merged from all threads
+//!         Each root probe is followed by probes nested within it
+void
+pimProbeMgr::showStats()
+{
+  pimProbeRegistry& registry = getRegistry();
+  std::lock_guard<std::mutex> lock(registry.m_mutex);
+  std::map<unsigned, std::map<unsigned, probeStat>> merged;  // root probe ID to probe ID
+  for (const auto& ptr : registry.m_buffers) {
+    threadBuffer& buffer = *std::static_pointer_cast<threadBuffer>(ptr);
+    std::lock_guard<std::mutex> bufferLock(buffer.m_mutex);
+    for (const auto& [key, stat] : buffer.m_stats) {
+      probeStat& item = merged[key >> 32][key & 0xffffffff];
+      item.m_count += stat.m_count;
+      item.m_nsTotal += stat.m_nsTotal;
+      item.m_nsChildren += stat.m_nsChildren;
+    }
+  }
+  std::printf("Simulator Probe Stats:\n");
+  std::printf(" %30s : %10s %14s %14s\n", "PROBE", "CNT", "Total(ms)", "Self(ms)");
+  std::map<std::string, unsigned> rootsByName;
+  for (const auto& it : merged) {
+    rootsByName.emplace(registry.m_names[it.first], it.first);
+  }
+  for (const auto& [rootName, rootId] : rootsByName) {
+    const auto& probes = merged[rootId];
+    auto rootIt = probes.find(rootId);
+    if (rootIt != probes.end()) {
+      const probeStat& stat = rootIt->second;
+      std::printf(" %30s : %10llu %14f %14f\n", rootName.c_str(), (unsigned long long)stat.m_count,
+                  stat.m_nsTotal * 1e-6, (stat.m_nsTotal - stat.m_nsChildren) * 1e-6);
+    }
+    std::map<std::string, const probeStat*> childrenByName;
+    for (const auto& [probeId, stat] : probes) {
+      if (probeId != rootId) {
+        childrenByName.emplace(registry.m_names[probeId], &stat);
+      }
+    }
+    for (const auto& [name, stat] : childrenByName) {
+      std::string label = "- " + name;
+      std::printf(" %30s : %10llu %14f %14f\n", label.c_str(), (unsigned long long)stat->m_count,
+                  stat->m_nsTotal * 1e-6, (stat->m_nsTotal - stat->m_nsChildren) * 1e-6);
+    }
+  }
+}
+
+//! @brief  Reset stats of all threads
+void
+pimProbeMgr::resetStats()
+{
+  pimProbeRegistry& registry = getRegistry();
+  std::lock_guard<std::mutex> lock(registry.m_mutex);
+  for (const auto& ptr : registry.m_buffers) {
+    threadBuffer& buffer = *std::static_pointer_cast<threadBuffer>(ptr);
+    std::lock_guard<std::mutex> bufferLock(buffer.m_mutex);
+    buffer.m_stats.clear();
+  }
+}
@@ -0,0 +1,112 @@
+// File: pimProbe.h
+// PIMeval Simulator - Hot-path Instrumentation Probes
+
+#ifndef LAVA_PIM_PROBE_H
+#define LAVA_PIM_PROBE_H
+
+#include <atomic>            // for atomic
+#include <chrono>            // for steady_clock
+#include <cstdint>           // for uint64_t
+#include <mutex>             // for mutex
+#include <unordered_map>     // for unordered_map
+#include <vector>            // for vector
+
+// Build with PIM_PROBES=0 to remove all probes. See Makefile
+#ifndef PIM_PROBES
+#define PIM_PROBES 1
+#endif
+
+
+//! @class  pimProbeMgr
+//! @brief  Measure host time of nested probe scopes, e.g., compute, sync, copy, stats and perf model within an API
+//! Each probe site has a static ID. Each thread accumulates into its own buffer,
+//! keyed by the outermost (root) probe of the thread and the probe itself.
+//! Buffers are merged when stats are shown. Probes are enabled by PIMEVAL_DEBUG flag DEBUG_PROBES
+class pimProbeMgr
+{
+public:
+  static constexpr unsigned s_invalidProbeId = ~0u;
+
+  static unsigned registerProbe(const char* name);
+  static unsigned getProbeIdOfTag(const char* tag);
+  static unsigned getRootProbeId();
+  static void setEnabled(bool val) { s_isEnabled.store(val, std::memory_order_relaxed); }
+  static bool isEnabled() { return s_isEnabled.load(std::memory_order_relaxed); }
+  static void showStats();
+  static void resetStats();
+
+  //! @class  scope
+  //! @brief  A probe scope. Nested scopes are supported
+  class scope
+  {
+  public:
+    scope(unsigned probeId) {
+      if (isEnabled() && probeId != s_invalidProbeId) {
+        m_isActive = enter(probeId);
+      }
+    }
+    ~scope() {
+      if (m_isActive) {
+        leave();
+      }
+    }
+    scope(const scope&) = delete;
+    scope& operator=(const scope&) = delete;
+  private:
+    bool m_isActive = false;
+  };
+
+private:
+  //! @brief  Accumulated time of a probe under a root probe
+  struct probeStat
+  {
+    uint64_t m_count = 0;
+    uint64_t m_nsTotal = 0;
+    uint64_t m_nsChildren = 0;  // time of directly nested probes
+  };
+  //! @brief  An active probe scope of a thread
+  struct probeFrame
+  {
+    unsigned m_probeId;
+    uint64_t m_nsStart;
+    uint64_t m_nsChildren;
+  };
+  //! @brief  Per-thread stats buffer
+  struct threadBuffer
+  {
+    std::mutex m_mutex;  // uncontended except at report time
+    std::unordered_map<uint64_t, probeStat> m_stats;  // key: root probe ID << 32 | probe ID
+    std::vector<probeFrame> m_frames;
+  };
+
+  static bool enter(unsigned probeId);
+  static void leave();
+  static threadBuffer& getThreadBuffer();
+  static uint64_t getNsNow() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+  }
+
+  inline static std::atomic<bool> s_isEnabled{false};
+  static constexpr size_t s_maxDepth = 64;
+};
+
+#if PIM_PROBES
+#define PIM_PROBE_CONCAT_IMPL(a, b) a##b
+#define PIM_PROBE_CONCAT(a, b) PIM_PROBE_CONCAT_IMPL(a, b)
+//! @brief  Probe the rest of current scope with a static probe ID of name
+#define PIM_PROBE_SCOPE(name) \
+  static const unsigned PIM_PROBE_CONCAT(pimProbeId_, __LINE__) = pimProbeMgr::registerProbe(name); \
+  pimProbeMgr::scope PIM_PROBE_CONCAT(pimProbeScope_, __LINE__)(PIM_PROBE_CONCAT(pimProbeId_, __LINE__))
+//! @brief  Probe the rest of current scope with a tag of static storage chosen at runtime, e.g., an API name
+#define PIM_PROBE_SCOPE_TAG(tag) \
+  pimProbeMgr::scope PIM_PROBE_CONCAT(pimProbeScope_, __LINE__)(pimProbeMgr::isEnabled() ? pimProbeMgr::getProbeIdOfTag(tag) : pimProbeMgr::s_invalidProbeId)
+//! @brief  Probe the rest of current scope with a probe ID from registerProbe or getRootProbeId
+#define PIM_PROBE_SCOPE_ID(probeId) \
+  pimProbeMgr::scope PIM_PROBE_CONCAT(pimProbeScope_, __LINE__)(probeId)
+#else
+#define PIM_PROBE_SCOPE(name) do {} while (0)
+#define PIM_PROBE_SCOPE_TAG(tag) do {} while (0)
+#define PIM_PROBE_SCOPE_ID(probeId) do { (void)(probeId); } while (0)
+#endif
+
+#endif
@@ -3,10 +3,13 @@
 
 #include "pimResMgr.h"       // for pimResMgr
 #include "pimDevice.h"       // for pimDevice
+#include "pimProbe.h"        // for PIM_PROBE_SCOPE
 #include <cstdio>            // for printf
-#include <algorithm>         // for sort, prev
+#include <cstring>           // for memcpy
+#include <algorithm>         // for sort, prev, min, find
 #include <stdexcept>         // for throw, invalid_argument
 #include <memory>            // for make_unique
+#include <utility>           // for move
 #include <cassert>           // for assert
 #include <string>            // for string
 
@@ -19,6 +22,73 @@ pimRegion::print(uint64_t regionId) const
          regionId, m_coreId, m_rowIdx, m_colIdx, m_numAllocRows, m_numAllocCols);
 }
 
+//! @brief  Copy rows of elements of type T between a dense buffer and a strided host layout
+template <typename T, typename DstPtr, typename SrcPtr>
+static void
+copyRowsOfLayout(DstPtr dst, SrcPtr src, const pimHostLayout& layout, uint64_t numElements, bool isGather)
+{
+  uint64_t numElementsPerRow = layout.m_numElementsPerRow;
+  uint64_t elemStride = layout.m_elemStride ? layout.m_elemStride : sizeof(T);
+  uint64_t rowPitch = layout.m_rowPitch ? layout.m_rowPitch : numElementsPerRow * elemStride;
+  for (uint64_t k = 0; k < numElements; k += numElementsPerRow) {
+    uint64_t numElementsInRow = std::min(numElementsPerRow, numElements - k);
+    uint64_t hostOffset = (k / numElementsPerRow) * rowPitch;
+    auto dstRow = isGather ? dst + k * sizeof(T) : dst + hostOffset;
+    auto srcRow = isGather ? src + hostOffset : src + k * sizeof(T);
+    uint64_t dstStride = isGather ? sizeof(T) : elemStride;
+    uint64_t srcStride = isGather ? elemStride : sizeof(T);
+    if (elemStride == sizeof(T)) {
+      std::memcpy(dstRow, srcRow, numElementsInRow * sizeof(T));
+      continue;
+    }
+    for (uint64_t i = 0; i < numElementsInRow; ++i) {
+      std::memcpy(dstRow + i * dstStride, srcRow + i * srcStride, sizeof(T));
+    }
+  }
+}
+
+//! @brief  Copy elements between a dense buffer and a strided host layout, dispatched by element size
+template <typename DstPtr, typename SrcPtr>
+static void
+copyLayout(DstPtr dst, SrcPtr src, const pimHostLayout& layout, uint64_t numElements, unsigned bytesPerElement, bool isGather)
+{
+  switch (bytesPerElement) {
+  case 1: copyRowsOfLayout<uint8_t>(dst, src, layout, numElements, isGather); break;
+  case 2: copyRowsOfLayout<uint16_t>(dst, src, layout, numElements, isGather); break;
+  case 4: copyRowsOfLayout<uint32_t>(dst, src, layout, numElements, isGather); break;
+  case 8: copyRowsOfLayout<uint64_t>(dst, src, layout, numElements, isGather); break;
+  default: assert(0);
+  }
+}
+
+//! @brief  Gather elements from a strided host layout into a dense buffer
+void
+pimDataHolder::gatherFromHost(uint8_t* dense, const void* host, const pimHostLayout& layout, uint64_t numElements, unsigned bytesPerElement)
+{
+  copyLayout(dense, static_cast<const uint8_t*>(host), layout, numElements, bytesPerElement, true);
+}
+
+//! @brief  Scatter elements from a dense buffer to a strided host layout
+void
+pimDataHolder::scatterToHost(void* host, const uint8_t* dense, const pimHostLayout& layout, uint64_t numElements, unsigned bytesPerElement)
+{
+  copyLayout(static_cast<uint8_t*>(host), dense, layout, numElements, bytesPerElement, false);
+}
+
+//! @brief  pimObjInfo ctor. Data holder keeps no backing store in analysis mode
+pimObjInfo::pimObjInfo(PimObjId objId, PimDataType dataType, PimAllocEnum allocType, uint64_t numElements, unsigned bitsPerElementPadded, pimDevice* device, bool isBuffer)
+  : m_objId(objId),
+    m_assocObjId(objId),
+    m_dataType(dataType),
+    m_allocType(allocType),
+    m_data(dataType, numElements, device->isAnalysisMode()),
+    m_numElements(numElements),
+    m_bitsPerElementPadded(bitsPerElementPadded),
+    m_device(device),
+    m_isBuffer(isBuffer)
+{
+}
+
 //! @brief  Print info of a PIM object
 void
 pimObjInfo::print() const
@@ -26,30 +96,131 @@ pimObjInfo::print() const
   std::printf("----------------------------------------\n");
   std::printf("PIM-Object: ObjId = %d, AllocType = %d, Regions =\n",
               m_objId, static_cast<int>(m_allocType));
-  for (size_t i = 0; i < m_regions.size(); ++i) {
-    m_regions[i].print(i);
+  for (uint64_t i = 0; i < m_numRegions; ++i) {
+    getRegion(i).print(i);
   }
   std::printf("----------------------------------------\n");
 }
 
+//! @brief  Add a region. Regions stay implicit as long as they follow the regular pattern
+void
+pimObjInfo::addRegion(const pimRegion& region)
+{
+  if (m_isImplicitRegions) {
+    if (m_numRegions == 0) {
+      m_firstRegion = region;
+      m_roundCoreIds.push_back(region.getCoreId());
+      m_roundRowIdx.push_back(region.getRowIdx());
+    } else if (!isNextImplicitRegion(region)) {
+      materializeRegions();
+    }
+  }
+  if (m_isImplicitRegions) {
+    m_numAllocColsLast = region.getNumAllocCols();
+    m_numElemLast = region.getNumElemInRegion();
+  } else {
+    m_regions.push_back(region);
+  }
+  ++m_numRegions;
+}
+
+//! @brief  Check if a new region follows the regular pattern of implicit regions
+bool
+pimObjInfo::isNextImplicitRegion(const pimRegion& region)
+{
+  uint64_t regionIdx = m_numRegions;
+  uint64_t numElemPerRegion = m_firstRegion.getNumElemInRegion();
+  // only the last region can be partial
+  if (m_numAllocColsLast != m_firstRegion.getNumAllocCols() || m_numElemLast != numElemPerRegion) {
+    return false;
+  }
+  if (region.getColIdx() != m_firstRegion.getColIdx() ||
+      region.getNumAllocRows() != m_firstRegion.getNumAllocRows() ||
+      region.getNumColsPerElem() != m_firstRegion.getNumColsPerElem() ||
+      region.isBuffer() != m_firstRegion.isBuffer() ||
+      region.isValid() != m_firstRegion.isValid() ||
+      region.getElemIdxBegin() != m_firstRegion.getElemIdxBegin() + regionIdx * numElemPerRegion) {
+    return false;
+  }
+  // the first round of regions defines the core order and the base row of each core
+  if (!m_isRoundComplete) {
+    if (region.getCoreId() != m_roundCoreIds[0]) {
+      if (std::find(m_roundCoreIds.begin(), m_roundCoreIds.end(), region.getCoreId()) != m_roundCoreIds.end()) {
+        return false;
+      }
+      m_roundCoreIds.push_back(region.getCoreId());
+      m_roundRowIdx.push_back(region.getRowIdx());
+      return true;
+    }
+    m_isRoundComplete = true;
+  }
+  uint64_t numCores = m_roundCoreIds.size();
+  uint64_t pos = regionIdx % numCores;
+  return region.getCoreId() == m_roundCoreIds[pos] &&
+         region.getRowIdx() == m_roundRowIdx[pos] + (regionIdx / numCores) * m_firstRegion.getNumAllocRows();
+}
+
+//! @brief  Switch from implicit to explicit regions
+void
+pimObjInfo::materializeRegions()
+{
+  m_regions.reserve(m_numRegions + 1);
+  for (uint64_t i = 0; i < m_numRegions; ++i) {
+    m_regions.push_back(getRegion(i));
+  }
+  m_isImplicitRegions = false;
+  m_roundCoreIds.clear();
+  m_roundRowIdx.clear();
+}
+
+//! @brief  Get a region by index. Implicit regions are computed on the fly
+pimRegion
+pimObjInfo::getRegion(uint64_t regionIdx) const
+{
+  assert(regionIdx < m_numRegions);
+  if (!m_isImplicitRegions) {
+    return m_regions[regionIdx];
+  }
+  uint64_t numCores = m_roundCoreIds.size();
+  uint64_t pos = regionIdx % numCores;
+  uint64_t numElemPerRegion = m_firstRegion.getNumElemInRegion();
+  uint64_t elemIdxBegin = m_firstRegion.getElemIdxBegin() + regionIdx * numElemPerRegion;
+  bool isLast = (regionIdx == m_numRegions - 1);
+  pimRegion region = m_firstRegion;
+  region.setCoreId(m_roundCoreIds[pos]);
+  region.setRowIdx(m_roundRowIdx[pos] + (regionIdx / numCores) * m_firstRegion.getNumAllocRows());
+  region.setElemIdxBegin(elemIdxBegin);
+  region.setElemIdxEnd(elemIdxBegin + (isLast ? m_numElemLast : numElemPerRegion));
+  if (isLast) {
+    region.setNumAllocCols(m_numAllocColsLast);
+  }
+  return region;
+}
+
 //! @brief  Finalize obj info
 void
 pimObjInfo::finalize()
 {
-  std::unordered_map<PimCoreId, int> coreIdCnt;
-  for (const auto& region : m_regions) {
-    PimCoreId coreId = region.getCoreId();
-    coreIdCnt[coreId]++;
-    unsigned numRegionsPerCore = coreIdCnt[coreId];
-    if (m_maxNumRegionsPerCore < numRegionsPerCore) {
-      m_maxNumRegionsPerCore = numRegionsPerCore;
+  if (m_isImplicitRegions) {
+    uint64_t numCores = m_roundCoreIds.size();
+    m_maxNumRegionsPerCore = (m_numRegions - 1) / numCores + 1;
+    m_numCoresUsed = numCores;
+  } else {
+    std::unordered_map<PimCoreId, int> coreIdCnt;
+    for (const auto& region : m_regions) {
+      PimCoreId coreId = region.getCoreId();
+      coreIdCnt[coreId]++;
+      unsigned numRegionsPerCore = coreIdCnt[coreId];
+      if (m_maxNumRegionsPerCore < numRegionsPerCore) {
+        m_maxNumRegionsPerCore = numRegionsPerCore;
+      }
     }
+    m_numCoresUsed = coreIdCnt.size();
   }
-  m_numCoresUsed = coreIdCnt.size();
   m_numCoreAvailable = m_device->getNumCores();
   m_isLoadBalanced = m_device->getConfig().isLoadBalanced();
 
-  const pimRegion& region = m_regions[0];
+  const pimRegion& region = m_firstRegion;
   m_maxElementsPerRegion = (uint64_t)region.getNumAllocRows() * region.getNumAllocCols() / m_bitsPerElementPadded;
   m_numColsPerElem = region.getNumColsPerElem();
 }
@@ -76,6 +247,16 @@ std::vector<pimRegion>
 pimObjInfo::getRegionsOfCore(PimCoreId coreId) const
 {
   std::vector<pimRegion> regions;
+  if (m_isImplicitRegions) {
+    auto it = std::find(m_roundCoreIds.begin(), m_roundCoreIds.end(), coreId);
+    if (it != m_roundCoreIds.end()) {
+      uint64_t numCores = m_roundCoreIds.size();
+      for (uint64_t i = it - m_roundCoreIds.begin(); i < m_numRegions; i += numCores) {
+        regions.push_back(getRegion(i));
+      }
+    }
+    return regions;
+  }
   for (const auto& region : m_regions) {
     if (region.getCoreId() == coreId) {
       regions.push_back(region);
@@ -84,6 +265,24 @@ pimObjInfo::getRegionsOfCore(PimCoreId coreId) const
   return regions;
 }
 
+//! @brief  Get distinct core IDs of all regions in ascending order
+std::vector<PimCoreId>
+pimObjInfo::getCoreIds() const
+{
+  std::vector<PimCoreId> result;
+  if (m_isImplicitRegions) {
+    result = m_roundCoreIds;
+  } else {
+    result.reserve(m_regions.size());
+    for (const pimRegion& region : m_regions) {
+      result.push_back(region.getCoreId());
+    }
+  }
+  std::sort(result.begin(), result.end());
+  result.erase(std::unique(result.begin(), result.end()), result.end());
+  return result;
+}
+
 //! @brief  Copy data from host memory to PIM object data holder, with ref support
 void
 pimObjInfo::copyFromHost(void* src, uint64_t idxBegin, uint64_t idxEnd)
@@ -147,6 +346,47 @@ pimObjInfo::copyToObj(pimObjInfo& destObj, uint64_t idxBegin, uint64_t idxEnd) c
   m_data.copyToObj(destObj.m_data, idxBegin, idxEnd);
 }
 
+//! @brief  Copy data from a strided host layout to PIM object data holder, with ref support
+void
+pimObjInfo::copyFromHost2D(void* src, const pimHostLayout& layout, uint64_t idxBegin, uint64_t idxEnd)
+{
+  // handle reference by gathering into a dense buffer first
+  if (m_refObjId != -1) {
+    uint64_t numBytes = m_data.getNumBytes(idxBegin, idxEnd);
+    std::vector<uint8_t> buffer(numBytes);
+    pimDataHolder::gatherFromHost(buffer.data(), src, layout, numBytes / m_data.getBytesPerElement(), m_data.getBytesPerElement());
+    copyFromHost(buffer.data(), idxBegin, idxEnd);
+    return;
+  }
+  m_data.copyFromHost2D(src, layout, idxBegin, idxEnd);
+}
+
+//! @brief  Copy data from PIM object data holder to a strided host layout, with ref support
+void
+pimObjInfo::copyToHost2D(void* dest, const pimHostLayout& layout, uint64_t idxBegin, uint64_t idxEnd) const
+{
+  // handle reference by scattering from a dense buffer
+  if (m_refObjId != -1) {
+    uint64_t numBytes = m_data.getNumBytes(idxBegin, idxEnd);
+    std::vector<uint8_t> buffer(numBytes);
+    copyToHost(buffer.data(), idxBegin, idxEnd);
+    pimDataHolder::scatterToHost(dest, buffer.data(), layout, numBytes / m_data.getBytesPerElement(), m_data.getBytesPerElement());
+    return;
+  }
+  m_data.copyToHost2D(dest, layout, idxBegin, idxEnd);
+}
+
+//! @brief  Use a host buffer as zero-copy backing store of this PIM object
+bool
+pimObjInfo::registerHostBuffer(void* hostBuffer)
+{
+  if (m_refObjId != -1) {
+    std::printf("PIM-Error: Cannot register host buffer for reference PIM object ID %d\n", m_objId);
+    return false;
+  }
+  return m_data.registerHostBuffer(hostBuffer);
+}
+
 //! @brief  Set an element at index with bit presentation, with ref support
 void
 pimObjInfo::setElementBits(uint64_t index, uint64_t bits)
@@ -187,62 +427,163 @@ pimObjInfo::getElementBits(uint64_t index) const
   return bits;
 }
 
+//! @brief  Skip pending zero-fill of data holder before all elements are overwritten, with ref support
+void
+pimObjInfo::discardDataForOverwrite()
+{
+  pimObjInfo &obj = (m_refObjId != -1 ? m_device->getResMgr()->getObjInfo(m_refObjId) : *this);
+  obj.m_data.discardForOverwrite();
+}
+
+//! @brief  Mark data holder as modified by a functional API, with ref support
+void
+pimObjInfo::markDataHolderModified()
+{
+  pimObjInfo &obj = (m_refObjId != -1 ? m_device->getResMgr()->getObjInfo(m_refObjId) : *this);
+  ++obj.m_dataGen;
+}
+
 //! @brief  Sync PIM object data from simulated memory
+//!         Only regions whose core memory changed since last sync are read
 void
 pimObjInfo::syncFromSimulatedMem()
 {
+  if (!m_device->hasSimulatedMem()) {
+    return;
+  }
+  PIM_PROBE_SCOPE("sync");
   pimObjInfo &obj = (m_refObjId != -1 ? m_device->getResMgr()->getObjInfo(m_refObjId) : *this);
+  // sync generations are tracked per region of the root object, so a ref must share its regions
+  assert(m_numRegions == obj.m_numRegions);
+  bool isFirstSync = obj.m_syncedMemGens.empty();
+  if (isFirstSync) {
+    obj.m_syncedMemGens.resize(m_numRegions);
+  }
   unsigned numBits = getBitsPerElement(PimBitWidth::SIM);
-  for (size_t i = 0; i < m_regions.size(); ++i) {
-    pimRegion& region = m_regions[i];
+  for (uint64_t i = 0; i < m_numRegions; ++i) {
+    const pimRegion region = getRegion(i);
     PimCoreId coreId = region.getCoreId();
     pimCore& core = m_device->getCore(coreId);
+    if (!isFirstSync && obj.m_syncedMemGens[i] == core.getMemGen()) {
+      continue;
+    }
     uint64_t elemIdxBegin = region.getElemIdxBegin();
     uint64_t numElemInRegion = region.getNumElemInRegion();
-    for (uint64_t j = 0; j < numElemInRegion; ++j) {
-      auto [rowLoc, colLoc] = region.locateIthElemInRegion(j);
-      uint64_t bits = isVLayout() ? core.getBitsV(rowLoc, colLoc, numBits)
-                                  : core.getBitsH(rowLoc, colLoc, numBits);
-      obj.m_data.setElementBits(elemIdxBegin + j, bits);
+    if (isVLayout() && region.getNumColsPerElem() == 1) {
+      // transpose blocks of 64 elements in consecutive columns
+      uint64_t block[64];
+      for (uint64_t j = 0; j < numElemInRegion; j += 64) {
+        unsigned numVals = std::min<uint64_t>(64, numElemInRegion - j);
+        auto [rowLoc, colLoc] = region.locateIthElemInRegion(j);
+        core.getBitsVBlock(rowLoc, colLoc, block, numVals, numBits);
+        for (unsigned k = 0; k < numVals; ++k) {
+          obj.m_data.setElementBits(elemIdxBegin + j + k, block[k]);
+        }
+      }
+    } else {
+      for (uint64_t j = 0; j < numElemInRegion; ++j) {
+        auto [rowLoc, colLoc] = region.locateIthElemInRegion(j);
+        uint64_t bits = isVLayout() ? core.getBitsV(rowLoc, colLoc, numBits)
+                                    : core.getBitsH(rowLoc, colLoc, numBits);
+        obj.m_data.setElementBits(elemIdxBegin + j, bits);
+      }
     }
+    obj.m_syncedMemGens[i] = core.getMemGen();
   }
+  obj.m_syncedDataGen = obj.m_dataGen;
 }
 
 //! @brief  Sync PIM object data to simulated memory
+//!         Skipped if data holder is not modified since last sync
 void
-pimObjInfo::syncToSimulatedMem() const
+pimObjInfo::syncToSimulatedMem()
 {
-  const pimObjInfo &obj = (m_refObjId != -1 ? m_device->getResMgr()->getObjInfo(m_refObjId) : *this);
+  if (!m_device->hasSimulatedMem()) {
+    return;
+  }
+  PIM_PROBE_SCOPE("sync");
+  pimObjInfo &obj = (m_refObjId != -1 ? m_device->getResMgr()->getObjInfo(m_refObjId) : *this);
+  assert(m_numRegions == obj.m_numRegions);  // see syncFromSimulatedMem
+  if (!obj.m_syncedMemGens.empty() && obj.m_syncedDataGen == obj.m_dataGen) {
+    return;
+  }
+  obj.m_syncedMemGens.resize(m_numRegions);
   unsigned numBits = getBitsPerElement(PimBitWidth::SIM);
-  for (size_t i = 0; i < m_regions.size(); ++i) {
-    const pimRegion& region = m_regions[i];
+  for (uint64_t i = 0; i < m_numRegions; ++i) {
+    const pimRegion region = getRegion(i);
     PimCoreId coreId = region.getCoreId();
     pimCore& core = m_device->getCore(coreId);
     uint64_t elemIdxBegin = region.getElemIdxBegin();
     uint64_t numElemInRegion = region.getNumElemInRegion();
-    for (uint64_t j = 0; j < numElemInRegion; ++j) {
-      uint64_t bits = 0;
-      obj.m_data.getElementBits(elemIdxBegin + j, bits);
-      auto [rowLoc, colLoc] = region.locateIthElemInRegion(j);
-      if (isVLayout()) {
-        core.setBitsV(rowLoc, colLoc, bits, numBits);
-      } else {
-        core.setBitsH(rowLoc, colLoc, bits, numBits);
+    if (isVLayout() && region.getNumColsPerElem() == 1) {
+      // transpose blocks of 64 elements in consecutive columns
+      uint64_t block[64];
+      for (uint64_t j = 0; j < numElemInRegion; j += 64) {
+        unsigned numVals = std::min<uint64_t>(64, numElemInRegion - j);
+        for (unsigned k = 0; k < numVals; ++k) {
+          obj.m_data.getElementBits(elemIdxBegin + j + k, block[k]);
+        }
+        auto [rowLoc, colLoc] = region.locateIthElemInRegion(j);
+        core.setBitsVBlock(rowLoc, colLoc, block, numVals, numBits);
+      }
+    } else {
+      for (uint64_t j = 0; j < numElemInRegion; ++j) {
+        uint64_t bits = 0;
+        obj.m_data.getElementBits(elemIdxBegin + j, bits);
+        auto [rowLoc, colLoc] = region.locateIthElemInRegion(j);
+        if (isVLayout()) {
+          core.setBitsV(rowLoc, colLoc, bits, numBits);
+        } else {
+          core.setBitsH(rowLoc, colLoc, bits, numBits);
+        }
       }
     }
+    obj.m_syncedMemGens[i] = core.getMemGen();
   }
+  obj.m_syncedDataGen = obj.m_dataGen;
 }
 
 
+//! @brief  Get the object ID to be taken by next emplace. Return -1 if out of slots
+PimObjId
+pimObjTable::getNextObjId() const
+{
+  if (!m_freeSlots.empty()) {
+    size_t slotIdx = m_freeSlots.back();
+    return makeObjId(slotIdx, m_slots[slotIdx].m_generation);
+  }
+  if (m_slots.size() >= (1u << s_numSlotBits)) {
+    std::printf("PIM-Error: Exceeded max number of %u live PIM objects\n", 1u << s_numSlotBits);
+    return -1;
+  }
+  return makeObjId(m_slots.size(), 0);
+}
+
+//! @brief  Destroy an object. No-op for stale IDs
+void
+pimObjTable::erase(PimObjId objId)
+{
+  if (!contains(objId)) {
+    return;
+  }
+  size_t slotIdx = getSlotIdx(objId);
+  objSlot& slot = m_slots[slotIdx];
+  slot.m_obj.reset();
+  // retire the slot when its generation is exhausted, so that an ID is never reissued
+  if (slot.m_generation < s_maxGeneration) {
+    ++slot.m_generation;
+    m_freeSlots.push_back(slotIdx);
+  }
+}
+
 //! @brief  pimResMgr ctor
 pimResMgr::pimResMgr(pimDevice* device)
-  : m_device(device),
-    m_availObjId(0)
+  : m_device(device)
 {
   unsigned numCores = m_device->getNumCores();
   unsigned numRowsPerCore = m_device->getNumRows();
   for (unsigned i = 0; i < numCores; ++i) {
-    m_coreUsage[i] = std::make_unique<coreUsage>(numRowsPerCore);
+    m_coreUsage[i] = std::make_unique<coreUsage>(i, numRowsPerCore, m_coreUsageIndex);
   }
   m_debugAlloc = (m_device->getConfig().getDebug() & pimSimConfig::DEBUG_ALLOC);
 }
@@ -258,6 +599,7 @@ pimResMgr::~pimResMgr()
 PimObjId
 pimResMgr::pimAlloc(PimAllocEnum allocType, uint64_t numElements, PimDataType dataType)
 {
+  PIM_PROBE_SCOPE("resMgr");
   if (m_debugAlloc) {
     printf("PIM-Debug: pimAlloc: Request: %s %lu elements of type %s\n",
            pimUtils::pimAllocEnumToStr(allocType).c_str(), numElements,
@@ -271,9 +613,11 @@ pimResMgr::pimAlloc(PimAllocEnum allocType, uint64_t numElements, PimDataType da
 
   unsigned bitsPerElement = pimUtils::getNumBitsOfDataType(dataType, PimBitWidth::SIM);
 
-  std::vector<PimCoreId> sortedCoreId = getCoreIdsSortedByLeastUsage();
-  pimObjInfo newObj(m_availObjId, dataType, allocType, numElements, bitsPerElement, m_device);
-  m_availObjId++;
+  PimObjId newObjId = m_objTable.getNextObjId();
+  if (newObjId < 0) {
+    return -1;
+  }
+  pimObjInfo newObj(newObjId, dataType, allocType, numElements, bitsPerElement, m_device);
 
   unsigned numCores = m_device->getNumCores();
   unsigned numCols = m_device->getNumCols();
@@ -329,14 +673,16 @@ pimResMgr::pimAlloc(PimAllocEnum allocType, uint64_t numElements, PimDataType da
   }
 
   // create new regions
+  // regions are distributed round-robin among cores ordered by least usage before this allocation
+  std::vector<PimCoreId> sortedCoreId = getCoreIdsSortedByLeastUsage(numRegions);
   bool success = true;
-  for (unsigned i = 0; i < numCores; ++i) {
-    m_coreUsage.at(i)->newAllocStart();
+  for (PimCoreId coreId : sortedCoreId) {
+    m_coreUsage.at(coreId)->newAllocStart();
   }
   if (allocType == PIM_ALLOC_V || allocType == PIM_ALLOC_V1 || allocType == PIM_ALLOC_H || allocType == PIM_ALLOC_H1) {
     uint64_t elemIdx = 0;
     for (uint64_t i = 0; i < numRegions; ++i) {
-      PimCoreId coreId = sortedCoreId[i % numCores];
+      PimCoreId coreId = sortedCoreId[i % sortedCoreId.size()];
       unsigned numColsToAlloc = (i == numRegions - 1 ? numColsToAllocLast : numCols);
       unsigned numElemInRegion = (i == numRegions - 1 ? numElemPerRegionLast : numElemPerRegion);
       pimRegion newRegion = findAvailRegionOnCore(coreId, numRowsToAlloc, numColsToAlloc);
@@ -356,8 +702,8 @@ pimResMgr::pimAlloc(PimAllocEnum allocType, uint64_t numElements, PimDataType da
       m_coreUsage.at(coreId)->addRange(alloc, newObj.getObjId());
     }
   }
-  for (unsigned i = 0; i < numCores; ++i) {
-    m_coreUsage.at(i)->newAllocEnd(success); // rollback if failed
+  for (PimCoreId coreId : sortedCoreId) {
+    m_coreUsage.at(coreId)->newAllocEnd(success); // rollback if failed
   }
 
   if (!success) {
@@ -368,8 +714,6 @@ pimResMgr::pimAlloc(PimAllocEnum allocType, uint64_t numElements, PimDataType da
   if (newObj.isValid()) {
     objId = newObj.getObjId();
     newObj.finalize();
-    // update new object to resource mgr
-    m_objMap.insert(std::make_pair(newObj.getObjId(), newObj));
   }
 
   if (m_debugAlloc) {
@@ -380,6 +724,11 @@ pimResMgr::pimAlloc(PimAllocEnum allocType, uint64_t numElements, PimDataType da
       printf("PIM-Debug: pimAlloc: Failed\n");
     }
   }
+
+  // move new object into the object table without copying its data
+  if (objId != -1) {
+    m_objTable.emplace(objId, std::move(newObj));
+  }
   return objId;
 }
 
@@ -405,8 +754,11 @@ pimResMgr::pimAllocBuffer(uint32_t numElements, PimDataType dataType)
     return -1;
   }
 
-  pimObjInfo newObj(m_availObjId, dataType, PIM_ALLOC_H, numElements, bitsPerElement, m_device, true);
-  m_availObjId++;
+  PimObjId newObjId = m_objTable.getNextObjId();
+  if (newObjId < 0) {
+    return -1;
+  }
+  pimObjInfo newObj(newObjId, dataType, PIM_ALLOC_H, numElements, bitsPerElement, m_device, true);
 
   unsigned numCols = m_device->getNumCols();
   unsigned numRowsToAlloc = 1;
@@ -458,8 +810,6 @@ pimResMgr::pimAllocBuffer(uint32_t numElements, PimDataType dataType)
   if (newObj.isValid()) {
     objId = newObj.getObjId();
     newObj.finalize();
-    // update new object to resource mgr
-    m_objMap.insert(std::make_pair(newObj.getObjId(), newObj));
   }
 
   if (m_debugAlloc) {
@@ -470,6 +820,11 @@ pimResMgr::pimAllocBuffer(uint32_t numElements, PimDataType dataType)
       printf("PIM-Debug: pimAlloc: Failed\n");
     }
   }
+
+  // move new object into the object table without copying its data
+  if (objId != -1) {
+    m_objTable.emplace(objId, std::move(newObj));
+  }
   return objId;
 }
 
@@ -480,19 +835,20 @@ pimResMgr::pimAllocBuffer(uint32_t numElements, PimDataType dataType)
 PimObjId
 pimResMgr::pimAllocAssociated(PimObjId assocId, PimDataType dataType)
 {
+  PIM_PROBE_SCOPE("resMgr");
   if (m_debugAlloc) {
     printf("PIM-Debug: pimAllocAssociated: Request: Data type %s associated with PIM object ID %d\n",
            pimUtils::pimDataTypeEnumToStr(dataType).c_str(), assocId);
   }
 
   // check if assoc obj is valid
-  if (m_objMap.find(assocId) == m_objMap.end()) {
+  if (!m_objTable.contains(assocId)) {
     printf("PIM-Error: pimAllocAssociated: Invalid associated PIM object ID %d\n", assocId);
     return -1;
   }
 
   // associated object must not be a buffer
-  const pimObjInfo& assocObj = m_objMap.at(assocId);
+  const pimObjInfo& assocObj = m_objTable.at(assocId);
   if (assocObj.isBuffer()) {
     printf("PIM-Error: pimAllocAssociated: Associated PIM object ID %d is a buffer, which is not allowed.\n", assocId);
     return -1;
@@ -536,8 +892,11 @@ pimResMgr::pimAllocAssociated(PimObjId assocId, PimDataType dataType)
   }
 
   // allocate associated regions
-  pimObjInfo newObj(m_availObjId, dataType, allocType, numElements, bitsPerElement, m_device);
-  m_availObjId++;
+  PimObjId newObjId = m_objTable.getNextObjId();
+  if (newObjId < 0) {
+    return -1;
+  }
+  pimObjInfo newObj(newObjId, dataType, allocType, numElements, bitsPerElement, m_device);
 
   unsigned numCols = m_device->getNumCols();
   uint64_t numRegions = 0;
@@ -555,9 +914,9 @@ pimResMgr::pimAllocAssociated(PimObjId assocId, PimDataType dataType)
 
     // This is a controversial design decision. I am not fully sold on this
     // TODO: discuss with professor before implementing the `non-controversial` design 
-    if (numRegions > assocObj.getRegions().size()) {
+    if (numRegions > assocObj.getNumRegions()) {
       printf("PIM-Error: pimAllocAssociated: Allocation type %s does not allow to allocate more regions (%lu) than associated object (%lu)\n",
-             pimUtils::pimAllocEnumToStr(allocType).c_str(), numRegions, assocObj.getRegions().size());
+             pimUtils::pimAllocEnumToStr(allocType).c_str(), numRegions, assocObj.getNumRegions());
       return -1;
     }
 
@@ -577,13 +936,15 @@ pimResMgr::pimAllocAssociated(PimObjId assocId, PimDataType dataType)
   }    
 
   bool success = true;
-  for (unsigned i = 0; i < numCores; ++i) {
-    m_coreUsage.at(i)->newAllocStart();
+  std::vector<PimCoreId> assocCoreIds = getCoreIdsOfObj(assocObj);
+  for (PimCoreId coreId : assocCoreIds) {
+    m_coreUsage.at(coreId)->newAllocStart();
   }
 
   unsigned regionIdx = 0;
   uint64_t elemIdx = 0;
-  for (const pimRegion& region : assocObj.getRegions()) {
+  for (uint64_t assocRegionIdx = 0; assocRegionIdx < assocObj.getNumRegions(); ++assocRegionIdx) {
+    const pimRegion region = assocObj.getRegion(assocRegionIdx);
     if ((bitsPerElement > bitsPerElementAssoc) && (allocType == PIM_ALLOC_H || allocType == PIM_ALLOC_H1) && (0/*m_device->getSimTarget() == PIM_DEVICE_BANK_LEVEL*/)) {
       PimCoreId coreId = region.getCoreId();
       unsigned numAllocRows = region.getNumAllocRows() * bitsPerElement / bitsPerElementAssoc;
@@ -633,8 +994,8 @@ pimResMgr::pimAllocAssociated(PimObjId assocId, PimDataType dataType)
     }
     regionIdx++;
   }
-  for (unsigned i = 0; i < numCores; ++i) {
-    m_coreUsage.at(i)->newAllocEnd(success); // rollback if failed
+  for (PimCoreId coreId : assocCoreIds) {
+    m_coreUsage.at(coreId)->newAllocEnd(success); // rollback if failed
   }
 
   if (!success) {
@@ -646,8 +1007,6 @@ pimResMgr::pimAllocAssociated(PimObjId assocId, PimDataType dataType)
     objId = newObj.getObjId();
     newObj.finalize();
     newObj.setAssocObjId(assocObj.getAssocObjId());
-    // update new object to resource mgr
-    m_objMap.insert(std::make_pair(newObj.getObjId(), newObj));
   }
 
   if (m_debugAlloc) {
@@ -658,6 +1017,11 @@ pimResMgr::pimAllocAssociated(PimObjId assocId, PimDataType dataType)
       printf("PIM-Debug: pimAllocAssociated: Failed\n");
     }
   }
+
+  // move new object into the object table without copying its data
+  if (objId != -1) {
+    m_objTable.emplace(objId, std::move(newObj));
+  }
   return objId;
 }
 
@@ -665,25 +1029,31 @@ pimResMgr::pimAllocAssociated(PimObjId assocId, PimDataType dataType)
 bool
 pimResMgr::pimFree(PimObjId objId)
 {
-  if (m_objMap.find(objId) == m_objMap.end()) {
+  PIM_PROBE_SCOPE("resMgr");
+  if (!m_objTable.contains(objId)) {
     printf("PIM-Error: pimFree: Invalid PIM object ID %d\n", objId);
     return false;
   }
-  unsigned numCores = m_device->getNumCores();
-  const pimObjInfo& obj = m_objMap.at(objId);
+  const pimObjInfo& obj = m_objTable.at(objId);
 
+  // only cores holding regions of the object are visited
   if (!obj.isDualContactRef()) {
-    for (unsigned i = 0; i < numCores; ++i) {
-      m_coreUsage.at(i)->deleteObj(objId);
+    std::vector<std::pair<unsigned, unsigned>> freedRanges;
+    for (PimCoreId coreId : getCoreIdsOfObj(obj)) {
+      freedRanges.clear();
+      m_coreUsage.at(coreId)->deleteObj(objId, freedRanges);
+      releaseSimulatedMem(coreId, freedRanges);
     }
   }
-  m_objMap.erase(objId);
+  m_objTable.erase(objId);
 
   // free all reference as well
-  if (m_refMap.find(objId) != m_refMap.end()) {
-    for (auto refId : m_refMap.at(objId)) {
-      m_objMap.erase(refId);
+  auto it = m_refMap.find(objId);
+  if (it != m_refMap.end()) {
+    for (auto refId : it->second) {
+      m_objTable.erase(refId);
     }
+    m_refMap.erase(it);
   }
 
   if (m_debugAlloc) {
@@ -705,12 +1075,12 @@ PimObjId
 pimResMgr::pimCreateDualContactRef(PimObjId refId)
 {
   // check if ref obj is valid
-  if (m_objMap.find(refId) == m_objMap.end()) {
+  if (!m_objTable.contains(refId)) {
     std::printf("PIM-Error: Invalid ref object ID %d for PIM dual contact ref\n", refId);
     return -1;
   }
 
-  const pimObjInfo& refObj = m_objMap.at(refId);
+  const pimObjInfo& refObj = m_objTable.at(refId);
   if (refObj.isDualContactRef()) {
     std::printf("PIM-Error: Cannot create dual contact ref of dual contact ref %d\n", refId);
     return -1;
@@ -719,13 +1089,15 @@ pimResMgr::pimCreateDualContactRef(PimObjId refId)
   // The dual-contact ref has exactly same regions as the ref object.
   // The refObjId field points to the ref object.
   // The isDualContactRef field indicates that values need to be negated during read/write.
-  pimObjInfo newObj = refObj;
-  PimObjId objId = m_availObjId++;
+  PimObjId objId = m_objTable.getNextObjId();
+  if (objId < 0) {
+    return -1;
+  }
+  m_refMap[refId].insert(objId);
+  pimObjInfo& newObj = m_objTable.emplace(objId, refObj);
   newObj.setObjId(objId);
-  newObj.setRefObjId(refObj.getObjId());
-  m_refMap[refObj.getObjId()].insert(objId);
+  newObj.setRefObjId(refId);
   newObj.setIsDualContactRef(true);
-  m_objMap.insert(std::make_pair(newObj.getObjId(), newObj));
 
   return objId;
 }
@@ -751,37 +1123,58 @@ pimResMgr::findAvailRegionOnCore(PimCoreId coreId, unsigned numAllocRows, unsign
   return region;
 }
 
-//! @brief  Get a list of core IDs sorted by least usage
+//! @brief  Get up to maxNumCores core IDs sorted by least usage, with ties broken by core ID
+//!         The usage index is maintained incrementally, so the cost depends on the number of cores returned
 std::vector<PimCoreId>
-pimResMgr::getCoreIdsSortedByLeastUsage() const
+pimResMgr::getCoreIdsSortedByLeastUsage(uint64_t maxNumCores) const
 {
-  std::vector<std::pair<unsigned, unsigned>> usages;
-  for (unsigned coreId = 0; coreId < m_device->getNumCores(); ++coreId) {
-    unsigned usage = m_coreUsage.at(coreId)->getTotRowsInUse();
-    usages.emplace_back(usage, coreId);
-  }
-  std::sort(usages.begin(), usages.end());
   std::vector<PimCoreId> result;
-  for (const auto& it : usages) {
-    result.push_back(it.second);
+  result.reserve(std::min<uint64_t>(maxNumCores, m_coreUsageIndex.size()));
+  for (auto it = m_coreUsageIndex.begin(); it != m_coreUsageIndex.end() && result.size() < maxNumCores; ++it) {
+    result.push_back(it->second);
   }
   return result;
 }
 
-//! @brief  Find next available range of rows with a given size
-unsigned
-pimResMgr::coreUsage::findAvailRange(unsigned numRowsToAlloc)
+//! @brief  Get distinct core IDs of all regions of a PIM object
+std::vector<PimCoreId>
+pimResMgr::getCoreIdsOfObj(const pimObjInfo& obj) const
 {
-  unsigned prevAvail = 0;
-  for (const auto& it : m_rangesInUse) {
-    unsigned rowIdx = it.first.first;
-    unsigned numRows = it.first.second;
-    if (rowIdx - prevAvail >= numRowsToAlloc) {
-      return prevAvail;
+  return obj.getCoreIds();
+}
+
+//! @brief  Release simulated memory pages that are no longer used by any PIM object
+void
+pimResMgr::releaseSimulatedMem(PimCoreId coreId, const std::vector<std::pair<unsigned, unsigned>>& freedRanges)
+{
+  if (!m_device->hasSimulatedMem() || freedRanges.empty()) {
+    return;
+  }
+  pimCore& core = m_device->getCore(coreId);
+  const coreUsage& usage = *m_coreUsage.at(coreId);
+  unsigned numRowsPerPage = core.getNumRowsPerPage();
+  for (const auto& [rowIdx, numRows] : freedRanges) {
+    unsigned pageBegin = rowIdx / numRowsPerPage;
+    unsigned pageEnd = (rowIdx + numRows - 1) / numRowsPerPage;
+    for (unsigned page = pageBegin; page <= pageEnd; ++page) {
+      if (!usage.isRangeInUse(page * numRowsPerPage, numRowsPerPage)) {
+        core.releasePage(page);
+      }
     }
-    prevAvail = rowIdx + numRows;
   }
-  return prevAvail;
+}
+
+//! @brief  Find an available range of rows with a given size
+//!         Best fit: the smallest free extent that fits, with ties broken by lowest row index
+//!         Return number of rows per core if no free extent fits
+unsigned
+pimResMgr::coreUsage::findAvailRange(unsigned numRowsToAlloc) const
+{
+  auto it = m_freeByNumRows.lower_bound(std::make_pair(numRowsToAlloc, 0u));
+  if (it == m_freeByNumRows.end()) {
+    return m_numRowsPerCore;
+  }
+  return it->second;
 }
 
 //! @brief  Add a new range to core usage.
@@ -790,6 +1183,9 @@ pimResMgr::coreUsage::findAvailRange(unsigned numRowsToAlloc)
 void
 pimResMgr::coreUsage::addRange(std::pair<unsigned, unsigned> range, PimObjId objId)
 {
+  reserveRows(range.first, range.second);
+  setTotRowsInUse(m_totRowsInUse + range.second);
+
   // aggregate with the prev range
   if (!m_rangesInUse.empty()) {
     auto it = std::prev(m_rangesInUse.end());
@@ -798,27 +1194,46 @@ pimResMgr::coreUsage::addRange(std::pair<unsigned, unsigned> range, PimObjId obj
     PimObjId lastObjId = it->second;
     if (lastIdx + lastSize == range.first && lastObjId == objId) {
       m_newAlloc.erase(it->first);
+      eraseObjRange(objId, it->first);
       m_rangesInUse.erase(it);
       range = std::make_pair(lastIdx, lastSize + range.second);
     }
   }
   m_rangesInUse.insert(std::make_pair(range, objId));
+  m_objRanges[objId].push_back(range);
   m_newAlloc.insert(range);
-  m_totRowsInUse += range.second;
 }
 
-//! @brief  Delete an object from core usage
+//! @brief  Delete an object from core usage. Return the row ranges that are freed
 void
-pimResMgr::coreUsage::deleteObj(PimObjId objId)
+pimResMgr::coreUsage::deleteObj(PimObjId objId, std::vector<std::pair<unsigned, unsigned>>& freedRanges)
 {
-  for (auto it = m_rangesInUse.begin(); it != m_rangesInUse.end();) {
-    if (it->second == objId) {
-      m_totRowsInUse -= it->first.second;
-      it = m_rangesInUse.erase(it);
-    } else {
-      ++it;
-    }
+  auto objIt = m_objRanges.find(objId);
+  if (objIt == m_objRanges.end()) {
+    return;
+  }
+  unsigned totRowsInUse = m_totRowsInUse;
+  for (const auto& range : objIt->second) {
+    m_rangesInUse.erase(range);
+    releaseRows(range.first, range.second);
+    totRowsInUse -= range.second;
+    freedRanges.push_back(range);
+  }
+  m_objRanges.erase(objIt);
+  setTotRowsInUse(totRowsInUse);
+}
+
+//! @brief  Check if any row within a range is used by a PIM object
+bool
+pimResMgr::coreUsage::isRangeInUse(unsigned rowIdx, unsigned numRows) const
+{
+  // Ranges in use do not overlap, so only the last range starting before the end can overlap
+  auto it = m_rangesInUse.lower_bound(std::make_pair(rowIdx + numRows, 0u));
+  if (it == m_rangesInUse.begin()) {
+    return false;
   }
+  --it;
+  return it->first.first + it->first.second > rowIdx;
 }
 
 //! @brief  Start a new allocation. This is preparing for rollback
@@ -833,14 +1248,110 @@ void
 pimResMgr::coreUsage::newAllocEnd(bool success)
 {
   if (!success) {
+    unsigned totRowsInUse = m_totRowsInUse;
     for (const auto &range : m_newAlloc) {
-      m_rangesInUse.erase(range);
-      m_totRowsInUse -= range.second;
+      // each newly allocated range is in use until rolled back here
+      auto it = m_rangesInUse.find(range);
+      assert(it != m_rangesInUse.end());
+      if (it == m_rangesInUse.end()) {
+        continue;
+      }
+      eraseObjRange(it->second, range);
+      m_rangesInUse.erase(it);
+      releaseRows(range.first, range.second);
+      totRowsInUse -= range.second;
     }
+    setTotRowsInUse(totRowsInUse);
   }
   m_newAlloc.clear();
 }
 
+//! @brief  Insert a free extent into both free extent indexes
+void
+pimResMgr::coreUsage::insertFreeExtent(unsigned rowIdx, unsigned numRows)
+{
+  m_freeByRowIdx.emplace(rowIdx, numRows);
+  m_freeByNumRows.emplace(numRows, rowIdx);
+}
+
+//! @brief  Erase a free extent from both free extent indexes
+void
+pimResMgr::coreUsage::eraseFreeExtent(std::map<unsigned, unsigned>::iterator it)
+{
+  m_freeByNumRows.erase(std::make_pair(it->second, it->first));
+  m_freeByRowIdx.erase(it);
+}
+
+//! @brief  Carve a range of rows out of the free extent containing it
+void
+pimResMgr::coreUsage::reserveRows(unsigned rowIdx, unsigned numRows)
+{
+  auto it = m_freeByRowIdx.upper_bound(rowIdx);
+  assert(it != m_freeByRowIdx.begin());
+  --it;
+  unsigned freeIdx = it->first;
+  unsigned freeEnd = it->first + it->second;
+  assert(rowIdx + numRows <= freeEnd);
+  eraseFreeExtent(it);
+  if (freeIdx < rowIdx) {
+    insertFreeExtent(freeIdx, rowIdx - freeIdx);
+  }
+  if (rowIdx + numRows < freeEnd) {
+    insertFreeExtent(rowIdx + numRows, freeEnd - rowIdx - numRows);
+  }
+}
+
+//! @brief  Return a range of rows to free extents, coalescing with adjacent free extents
+void
+pimResMgr::coreUsage::releaseRows(unsigned rowIdx, unsigned numRows)
+{
+  auto next = m_freeByRowIdx.lower_bound(rowIdx);
+  if (next != m_freeByRowIdx.begin()) {
+    auto prev = std::prev(next);
+    if (prev->first + prev->second == rowIdx) {
+      rowIdx = prev->first;
+      numRows += prev->second;
+      eraseFreeExtent(prev);
+    }
+  }
+  if (next != m_freeByRowIdx.end() && next->first == rowIdx + numRows) {
+    numRows += next->second;
+    eraseFreeExtent(next);
+  }
+  insertFreeExtent(rowIdx, numRows);
+}
+
+//! @brief  Erase a range from the ranges of an object
+void
+pimResMgr::coreUsage::eraseObjRange(PimObjId objId, std::pair<unsigned, unsigned> range)
+{
+  auto it = m_objRanges.find(objId);
+  if (it == m_objRanges.end()) {
+    return;
+  }
+  std::vector<std::pair<unsigned, unsigned>>& ranges = it->second;
+  auto pos = std::find(ranges.begin(), ranges.end(), range);
+  if (pos != ranges.end()) {
+    *pos = ranges.back();
+    ranges.pop_back();
+  }
+  if (ranges.empty()) {
+    m_objRanges.erase(it);
+  }
+}
+
+//! @brief  Update total rows in use, and re-position this core in the usage index
+void
+pimResMgr::coreUsage::setTotRowsInUse(unsigned numRows)
+{
+  if (numRows == m_totRowsInUse) {
+    return;
+  }
+  m_usageIndex.erase(std::make_pair(m_totRowsInUse, m_coreId));
+  m_totRowsInUse = numRows;
+  m_usageIndex.emplace(m_totRowsInUse, m_coreId);
+}
+
 //! @brief  If a PIM object uses vertical data layout
 bool
 pimResMgr::isVLayoutObj(PimObjId objId) const
@@ -6,13 +6,19 @@
 
 #include "libpimeval.h"      // for PimObjId, PimDataType
 #include "pimUtils.h"        // for getNumBitsOfDataType, signExt, pimDataTypeEnumToStr, castTypeToBits
+#include "pimMemPool.h"      // for pimPooledBuffer
 #include <vector>            // for vector
 #include <unordered_map>     // for unordered_map
 #include <set>               // for set
 #include <map>               // for map
 #include <string>            // for string
 #include <memory>            // for unique_ptr
+#include <utility>           // for forward
+#include <deque>             // for deque
+#include <optional>          // for optional
+#include <stdexcept>         // for out_of_range
 #include <cassert>           // for assert
+#include <cstdint>           // for uintptr_t
 
 class pimDevice;
 
@@ -71,23 +77,42 @@ private:
   bool m_isBuffer = false;  // true if this region is a buffer region
 };
 
+//! @struct pimHostLayout
+//! @brief  Strided layout of a copy range in host memory, e.g., a sub-matrix or a column of a row-major matrix
+//! Element k of the range is at host byte offset (k / m_numElementsPerRow) * m_rowPitch + (k % m_numElementsPerRow) * m_elemStride
+//! An element stride of 0 means dense elements. A row pitch of 0 means dense rows
+struct pimHostLayout
+{
+  uint64_t m_numElementsPerRow = 0;
+  uint64_t m_rowPitch = 0;   // bytes
+  uint64_t m_elemStride = 0; // bytes
+};
+
 //! @class  pimDataHolder
-//! @brief  A container holding raw data vector of a PIM object as a byte array
+//! @brief  A container holding raw data of a PIM object as a byte array
+//! Data is stored in a pooled buffer, which reads as zero until written
 //! Assumption: Caller gurantees correct range and indices
 class pimDataHolder
 {
 public:
-  pimDataHolder(PimDataType dataType, uint64_t numElements)
+  pimDataHolder(PimDataType dataType, uint64_t numElements, bool isMetadataOnly = false)
     : m_dataType(dataType),
-      m_numElements(numElements)
+      m_numElements(numElements),
+      m_isMetadataOnly(isMetadataOnly)
   {
     unsigned numBitsOfDataType = pimUtils::getNumBitsOfDataType(m_dataType, PimBitWidth::HOST);
     // Note: Each data element is stored as m_bytesPerElement bytes in this data holder.
     // This aligns with the number of bytes per element in the host void* ptr for memcpy.
     m_bytesPerElement = (numBitsOfDataType + 7) / 8;  // round up, e.g. 1 byte per bool
-    m_data.resize(m_numElements * m_bytesPerElement);
+    if (!m_isMetadataOnly) {
+      m_data = pimPooledBuffer(m_numElements * m_bytesPerElement);
+    }
   }
   ~pimDataHolder() {}
+  pimDataHolder(const pimDataHolder&) = default;
+  pimDataHolder(pimDataHolder&&) = default;  // move data buffer without copying
+  pimDataHolder& operator=(const pimDataHolder&) = default;
+  pimDataHolder& operator=(pimDataHolder&&) = default;
 
   // return the number of bytes within a given range
   uint64_t getNumBytes(uint64_t idxBegin, uint64_t idxEnd) const {
@@ -95,37 +120,83 @@ public:
     return numElements * m_bytesPerElement;
   }
 
+  // check if range [idxBegin, idxEnd) covers all elements
+  bool isFullRange(uint64_t idxBegin, uint64_t idxEnd) const {
+    return idxBegin == 0 && (idxEnd == 0 || idxEnd == m_numElements);
+  }
+
+  // skip pending zero-fill of owned memory when all elements are about to be overwritten
+  void discardForOverwrite() { m_data.discardForOverwrite(); }
+
   // copy data of range [idxBegin, idxEnd) from host ptr into holder
   // use full range if idxEnd is default 0
+  // no bytes are moved if host ptr is already the backing store of the range
   bool copyFromHost(void* src, uint64_t idxBegin = 0, uint64_t idxEnd = 0) {
     uint64_t byteIndex = idxBegin * m_bytesPerElement;
     uint64_t numBytes = getNumBytes(idxBegin, idxEnd);
-    std::memcpy(m_data.data() + byteIndex, src, numBytes);
+    if (isFullRange(idxBegin, idxEnd)) {
+      discardForOverwrite();
+    }
+    if (getData() + byteIndex != src) {
+      std::memcpy(getData() + byteIndex, src, numBytes);
+    }
     return true;
   }
 
   // copy data of range [idxBegin, idxEnd) from holder to host ptr
   // use full range if idxEnd is default 0
+  // no bytes are moved if host ptr is already the backing store of the range
   bool copyToHost(void* dest, uint64_t idxBegin = 0, uint64_t idxEnd = 0) const {
     uint64_t byteIndex = idxBegin * m_bytesPerElement;
     uint64_t numBytes = getNumBytes(idxBegin, idxEnd);
-    std::memcpy(dest, m_data.data() + byteIndex, numBytes);
+    if (getData() + byteIndex != dest) {
+      std::memcpy(dest, getData() + byteIndex, numBytes);
+    }
+    return true;
+  }
+
+  // copy data of range [idxBegin, idxEnd) from a strided host layout into holder
+  // use full range if idxEnd is default 0
+  bool copyFromHost2D(void* src, const pimHostLayout& layout, uint64_t idxBegin = 0, uint64_t idxEnd = 0) {
+    uint64_t numElements = getNumBytes(idxBegin, idxEnd) / m_bytesPerElement;
+    if (isFullRange(idxBegin, idxEnd)) {
+      discardForOverwrite();
+    }
+    gatherFromHost(getData() + idxBegin * m_bytesPerElement, src, layout, numElements, m_bytesPerElement);
+    return true;
+  }
+
+  // copy data of range [idxBegin, idxEnd) from holder to a strided host layout
+  // use full range if idxEnd is default 0
+  bool copyToHost2D(void* dest, const pimHostLayout& layout, uint64_t idxBegin = 0, uint64_t idxEnd = 0) const {
+    uint64_t numElements = getNumBytes(idxBegin, idxEnd) / m_bytesPerElement;
+    scatterToHost(dest, getData() + idxBegin * m_bytesPerElement, layout, numElements, m_bytesPerElement);
     return true;
   }
 
+  // gather elements from a strided host layout into a dense buffer, or scatter them back
+  static void gatherFromHost(uint8_t* dense, const void* host, const pimHostLayout& layout, uint64_t numElements, unsigned bytesPerElement);
+  static void scatterToHost(void* host, const uint8_t* dense, const pimHostLayout& layout, uint64_t numElements, unsigned bytesPerElement);
+
   // copy data of range [idxBegin, idxEnd) from this holder to another holder
   // use full range if idxEnd is default 0
   bool copyToObj(pimDataHolder& dest, uint64_t idxBegin = 0, uint64_t idxEnd = 0) const {
     uint64_t byteIndex = idxBegin * m_bytesPerElement;
     uint64_t numBytes = getNumBytes(idxBegin, idxEnd);
-    std::memcpy(dest.m_data.data() + byteIndex, m_data.data() + byteIndex, numBytes);
+    if (&dest != this && dest.m_bytesPerElement == m_bytesPerElement &&
+        dest.isFullRange(idxBegin, idxEnd == 0 ? m_numElements : idxEnd)) {
+      dest.discardForOverwrite();
+    }
+    if (dest.getData() != getData()) {
+      std::memcpy(dest.getData() + byteIndex, getData() + byteIndex, numBytes);
+    }
     return true;
   }
 
   // set an element at index from bit representation
   bool setElementBits(uint64_t index, uint64_t bits) {
     uint64_t byteIndex = index * m_bytesPerElement;
-    std::memcpy(m_data.data() + byteIndex, &bits, m_bytesPerElement);
+    std::memcpy(getData() + byteIndex, &bits, m_bytesPerElement);
     return true;
   }
 
@@ -133,27 +204,64 @@ public:
   bool getElementBits(uint64_t index, uint64_t &bits) const {
     bits = 0;
     uint64_t byteIndex = index * m_bytesPerElement;
-    std::memcpy(&bits, m_data.data() + byteIndex, m_bytesPerElement);
+    std::memcpy(&bits, getData() + byteIndex, m_bytesPerElement);
     bits = pimUtils::signExt(bits, m_dataType);
     return true;
   }
 
+  // get a typed contiguous span of all elements, where T must match the host element size
+  template <typename T> T* getTypedData() {
+    assert(sizeof(T) == m_bytesPerElement);
+    return reinterpret_cast<T*>(getData());
+  }
+  template <typename T> const T* getTypedData() const {
+    assert(sizeof(T) == m_bytesPerElement);
+    return reinterpret_cast<const T*>(getData());
+  }
+
+  // use a host buffer of all elements as backing store instead of owned memory
+  // the host buffer is not owned, and must outlive the holder or a re-registration
+  // the host buffer must be aligned to the host element size, as elements are accessed through typed pointers
+  bool registerHostBuffer(void* hostBuffer) {
+    if (reinterpret_cast<uintptr_t>(hostBuffer) % m_bytesPerElement != 0) {
+      std::printf("PIM-Error: Host buffer %p is not aligned to %u-byte elements of data type %s\n",
+                  hostBuffer, m_bytesPerElement, pimUtils::pimDataTypeEnumToStr(m_dataType).c_str());
+      return false;
+    }
+    m_hostBuffer = static_cast<uint8_t*>(hostBuffer);
+    m_data.reset();
+    return true;
+  }
+  bool isHostBuffer() const { return m_hostBuffer != nullptr; }
+  void* getHostBuffer() const { return m_hostBuffer; }
+
+  // a metadata-only holder has no backing store, e.g. in analysis mode where no data is computed
+  bool isMetadataOnly() const { return m_isMetadataOnly; }
+
+  unsigned getBytesPerElement() const { return m_bytesPerElement; }
+
   // print all bytes for debugging
   void print() const {
     printf("PIM obj data holder: data-type = %s, num-elements = %lu, bytes-per-element = %u\n",
            pimUtils::pimDataTypeEnumToStr(m_dataType).c_str(), m_numElements, m_bytesPerElement);
-    for (size_t i = 0; i < m_data.size(); ++i) {
-      std::printf(" %02x", m_data[i]);
+    uint64_t numBytes = m_numElements * m_bytesPerElement;
+    for (uint64_t i = 0; i < numBytes; ++i) {
+      std::printf(" %02x", getData()[i]);
       if ((i + 1) % 64 == 0) { std::printf("\n"); }
     }
     std::printf("\n");
   }
 
 private:
-  std::vector<uint8_t> m_data;
+  uint8_t* getData() { return m_hostBuffer ? m_hostBuffer : m_data.data(); }
+  const uint8_t* getData() const { return m_hostBuffer ? m_hostBuffer : m_data.data(); }
+
+  pimPooledBuffer m_data;
+  uint8_t* m_hostBuffer = nullptr;  // registered host buffer as zero-copy backing store
   PimDataType m_dataType;
   uint64_t m_numElements;
   unsigned m_bytesPerElement;
+  bool m_isMetadataOnly = false;
 };
 
 //! @class  pimObjInfo
@@ -161,33 +269,21 @@ private:
 //!         - PIM object ID
 //!         - One or more rectangle regions allocated in one or more PIM cores
 //!         - Allocation type which specifies how data is stored in a region
+//! Regions of a regular allocation are described arithmetically instead of stored one by one:
+//! regions are distributed round-robin among a list of cores, each core holds consecutive row blocks
+//! from a base row, and all regions have same shape and number of elements except the last one.
+//! Regions are stored explicitly only after addRegion breaks the pattern.
 class pimObjInfo
 {
 public:
-  pimObjInfo(PimObjId objId, PimDataType dataType, PimAllocEnum allocType, uint64_t numElements, unsigned bitsPerElementPadded, pimDevice* device)
-    : m_objId(objId),
-      m_assocObjId(objId),
-      m_dataType(dataType),
-      m_allocType(allocType),
-      m_data(dataType, numElements),
-      m_numElements(numElements),
-      m_bitsPerElementPadded(bitsPerElementPadded),
-      m_device(device)
-  {}
-  pimObjInfo(PimObjId objId, PimDataType dataType, PimAllocEnum allocType, uint64_t numElements, unsigned bitsPerElementPadded, pimDevice* device, bool isBuffer)
-    : m_objId(objId),
-      m_assocObjId(objId),
-      m_dataType(dataType),
-      m_allocType(allocType),
-      m_data(dataType, numElements),
-      m_numElements(numElements),
-      m_bitsPerElementPadded(bitsPerElementPadded),
-      m_device(device),
-      m_isBuffer(isBuffer)
-  {}
+  pimObjInfo(PimObjId objId, PimDataType dataType, PimAllocEnum allocType, uint64_t numElements, unsigned bitsPerElementPadded, pimDevice* device, bool isBuffer = false);
   ~pimObjInfo() {}
+  pimObjInfo(const pimObjInfo&) = default;
+  pimObjInfo(pimObjInfo&&) = default;
+  pimObjInfo& operator=(const pimObjInfo&) = default;
+  pimObjInfo& operator=(pimObjInfo&&) = default;
 
-  void addRegion(pimRegion region) { m_regions.push_back(region); }
+  void addRegion(const pimRegion& region);
   void setObjId(PimObjId objId) { m_objId = objId; }
   void setAssocObjId(PimObjId assocObjId) { m_assocObjId = assocObjId; }
   void setRefObjId(PimObjId refObjId) { m_refObjId = refObjId; }
@@ -204,14 +300,17 @@ public:
   uint64_t getNumElements() const { return m_numElements; }
   unsigned getBitsPerElement(PimBitWidth bitWidthType) const;
   pimDevice* getDevice() { return m_device; }
-  bool isValid() const { return m_numElements > 0 && m_bitsPerElementPadded > 0 && !m_regions.empty(); }
+  bool isValid() const { return m_numElements > 0 && m_bitsPerElementPadded > 0 && m_numRegions > 0; }
   bool isVLayout() const { return m_allocType == PIM_ALLOC_V || m_allocType == PIM_ALLOC_V1; }
   bool isHLayout() const { return m_allocType == PIM_ALLOC_H || m_allocType == PIM_ALLOC_H1; }
   bool isLoadBalanced() const { return m_isLoadBalanced; }
   bool isBuffer() const { return m_isBuffer; }
 
-  const std::vector<pimRegion>& getRegions() const { return m_regions; }
+  uint64_t getNumRegions() const { return m_numRegions; }
+  pimRegion getRegion(uint64_t regionIdx) const;
   std::vector<pimRegion> getRegionsOfCore(PimCoreId coreId) const;
+  std::vector<PimCoreId> getCoreIds() const;
+  bool hasImplicitRegions() const { return m_isImplicitRegions; }
   unsigned getMaxNumRegionsPerCore() const { return m_maxNumRegionsPerCore; }
   unsigned getNumCoresUsed() const { return m_numCoresUsed; }
   unsigned getNumCoreAvailable() const { return m_numCoreAvailable; }
@@ -231,21 +330,43 @@ public:
   void copyFromHost(void* src, uint64_t idxBegin = 0, uint64_t idxEnd = 0);
   void copyToHost(void* dest, uint64_t idxBegin = 0, uint64_t idxEnd = 0) const;
   void copyToObj(pimObjInfo& destObj, uint64_t idxBegin = 0, uint64_t idxEnd = 0) const;
+  void copyFromHost2D(void* src, const pimHostLayout& layout, uint64_t idxBegin = 0, uint64_t idxEnd = 0);
+  void copyToHost2D(void* dest, const pimHostLayout& layout, uint64_t idxBegin = 0, uint64_t idxEnd = 0) const;
+  bool registerHostBuffer(void* hostBuffer);
+  bool isHostBuffer() const { return m_data.isHostBuffer(); }
+  void* getHostBuffer() const { return m_data.getHostBuffer(); }
+  bool isMetadataOnly() const { return m_data.isMetadataOnly(); }
+  void discardDataForOverwrite();
   void setElementBits(uint64_t index, uint64_t bits);
   uint64_t getElementBits(uint64_t index) const;
   template <typename T> void setElement(uint64_t index, T val) {
     setElementBits(index, pimUtils::castTypeToBits(val));
   }
+  // Typed span access for type-specialized kernels. Returns nullptr for reference objects,
+  // which need per-element bit handling through the ref-to object
+  template <typename T> T* getTypedData() {
+    return m_refObjId == -1 ? m_data.getTypedData<T>() : nullptr;
+  }
+  template <typename T> const T* getTypedData() const {
+    return m_refObjId == -1 ? m_data.getTypedData<T>() : nullptr;
+  }
 
   // Note: Below two functions are for supporting mixed functional and micro-ops level simulation.
   // Functional simulation purely uses this PIM data holder for simulation speed,
   // while micro-ops level simulation uses simulated 2D memory arrays.
   // When a functional API is called during micro-ops level simulation, call below two functions
   // to sync the data between this PIM data holder and simulated memory arrays.
+  // Both sides are versioned to skip redundant syncs. The data holder generation is bumped by
+  // markDataHolderModified() after a functional API writes an object, and each core bumps its
+  // memory generation on micro-op writes. A sync only walks regions whose other side changed.
+  void markDataHolderModified();
   void syncFromSimulatedMem();
-  void syncToSimulatedMem() const;
+  void syncToSimulatedMem();
 
 private:
+  bool isNextImplicitRegion(const pimRegion& region);
+  void materializeRegions();
+
   PimObjId m_objId = -1;
   PimObjId m_assocObjId = -1;
   PimObjId m_refObjId = -1;
@@ -255,6 +376,16 @@ private:
   uint64_t m_numElements = 0;
   unsigned m_bitsPerElementPadded = 0;
   unsigned m_numCoreAvailable = 0;
+  uint64_t m_numRegions = 0;
+  bool m_isImplicitRegions = true;
+  // Implicit regions: region i is on core m_roundCoreIds[i % C] at row m_roundRowIdx[i % C] + (i / C) * rows
+  pimRegion m_firstRegion;                 // shape of all regions except the last one
+  std::vector<PimCoreId> m_roundCoreIds;   // cores of the first round of regions
+  std::vector<unsigned> m_roundRowIdx;     // base row index of each core in the first round
+  bool m_isRoundComplete = false;          // true once the first round of regions wraps around
+  unsigned m_numAllocColsLast = 0;         // number of cols of the last region
+  uint64_t m_numElemLast = 0;              // number of elements of the last region
+  // Explicit regions of an irregular allocation
   std::vector<pimRegion> m_regions;  // a list of core ID and regions
   unsigned m_maxNumRegionsPerCore = 0;
   unsigned m_numCoresUsed = 0;
@@ -264,6 +395,73 @@ private:
   pimDevice* m_device = nullptr; // for accessing simulated memory
   bool m_isLoadBalanced = true;
   bool m_isBuffer = false; // true if this is a global buffer
+  // Sync tracking between data holder and simulated memory. Refs use the ref-to object
+  uint64_t m_dataGen = 0;                 // generation of data holder contents
+  uint64_t m_syncedDataGen = 0;           // data holder generation at last sync
+  std::vector<uint64_t> m_syncedMemGens;  // per-region core memory generation at last sync, empty if never synced
+};
+
+
+//! @class  pimObjTable
+//! @brief  Generational slot map of PIM objects
+//! An object ID encodes a slot index in the low bits and the slot generation in the high bits.
+//! Objects are constructed in place and keep stable addresses until erased. Lookup is array indexing.
+//! A freed slot is reused with a new generation, so that stale IDs of freed objects are detected
+class pimObjTable
+{
+public:
+  pimObjTable() {}
+  ~pimObjTable() {}
+
+  //! @brief  Get the object ID to be taken by next emplace. Return -1 if out of slots
+  PimObjId getNextObjId() const;
+  //! @brief  Construct an object in place with the ID from getNextObjId, which is passed as objId
+  template <typename... Args> pimObjInfo& emplace(PimObjId objId, Args&&... args) {
+    size_t slotIdx = m_slots.size();
+    if (!m_freeSlots.empty()) {
+      slotIdx = m_freeSlots.back();
+      m_freeSlots.pop_back();
+    } else {
+      m_slots.emplace_back();
+    }
+    assert(getSlotIdx(objId) == slotIdx && getGeneration(objId) == m_slots[slotIdx].m_generation);
+    return m_slots[slotIdx].m_obj.emplace(std::forward<Args>(args)...);
+  }
+  //! @brief  Destroy an object. No-op for stale IDs
+  void erase(PimObjId objId);
+
+  bool contains(PimObjId objId) const {
+    if (objId < 0) { return false; }
+    size_t slotIdx = getSlotIdx(objId);
+    return slotIdx < m_slots.size() && m_slots[slotIdx].m_generation == getGeneration(objId) && m_slots[slotIdx].m_obj;
+  }
+  const pimObjInfo& at(PimObjId objId) const {
+    if (!contains(objId)) { throw std::out_of_range("pimObjTable::at"); }
+    return *m_slots[getSlotIdx(objId)].m_obj;
+  }
+  pimObjInfo& at(PimObjId objId) {
+    if (!contains(objId)) { throw std::out_of_range("pimObjTable::at"); }
+    return *m_slots[getSlotIdx(objId)].m_obj;
+  }
+
+private:
+  //! @brief  A slot of the object table
+  struct objSlot
+  {
+    std::optional<pimObjInfo> m_obj;
+    unsigned m_generation = 0;
+  };
+
+  static constexpr unsigned s_numSlotBits = 22;  // up to 4M live objects
+  static constexpr unsigned s_maxGeneration = (1u << (31 - s_numSlotBits)) - 1;  // keep IDs positive
+  static size_t getSlotIdx(PimObjId objId) { return static_cast<unsigned>(objId) & ((1u << s_numSlotBits) - 1); }
+  static unsigned getGeneration(PimObjId objId) { return static_cast<unsigned>(objId) >> s_numSlotBits; }
+  static PimObjId makeObjId(size_t slotIdx, unsigned generation) {
+    return static_cast<PimObjId>((generation << s_numSlotBits) | static_cast<unsigned>(slotIdx));
+  }
+
+  std::deque<objSlot> m_slots;  // deque keeps element addresses stable when growing
+  std::vector<size_t> m_freeSlots;
 };
 
 
@@ -282,9 +480,9 @@ public:
   PimObjId pimCreateRangedRef(PimObjId refId, uint64_t idxBegin, uint64_t idxEnd);
   PimObjId pimCreateDualContactRef(PimObjId refId);
 
-  bool isValidObjId(PimObjId objId) const { return m_objMap.find(objId) != m_objMap.end(); }
-  const pimObjInfo& getObjInfo(PimObjId objId) const { assert(objId != -1); return m_objMap.at(objId); }
-  pimObjInfo& getObjInfo(PimObjId objId) { assert(objId != -1); return m_objMap.at(objId); }
+  bool isValidObjId(PimObjId objId) const { return m_objTable.contains(objId); }
+  const pimObjInfo& getObjInfo(PimObjId objId) const { assert(objId != -1); return m_objTable.at(objId); }
+  pimObjInfo& getObjInfo(PimObjId objId) { assert(objId != -1); return m_objTable.at(objId); }
 
   bool isVLayoutObj(PimObjId objId) const;
   bool isHLayoutObj(PimObjId objId) const;
@@ -292,31 +490,58 @@ public:
 
 private:
   pimRegion findAvailRegionOnCore(PimCoreId coreId, unsigned numAllocRows, unsigned numAllocCols) const;
-  std::vector<PimCoreId> getCoreIdsSortedByLeastUsage() const;
-  
+  std::vector<PimCoreId> getCoreIdsSortedByLeastUsage(uint64_t maxNumCores) const;
+  std::vector<PimCoreId> getCoreIdsOfObj(const pimObjInfo& obj) const;
+  void releaseSimulatedMem(PimCoreId coreId, const std::vector<std::pair<unsigned, unsigned>>& freedRanges);
+
+  //! @brief  Index of cores ordered by number of rows in use, then by core ID
+  typedef std::set<std::pair<unsigned, PimCoreId>> coreUsageIndex;
+
   //! @class  coreUsage
   //! @brief  Track row usage for allocation
+  //! Total rows in use of each core is kept up to date in the core usage index
+  //! Free rows are kept as coalesced extents indexed by start and by size for best-fit allocation,
+  //! and ranges in use are indexed by object, so that allocation and free are logarithmic
   class coreUsage {
   public:
-    coreUsage(unsigned numRowsPerCore) : m_numRowsPerCore(numRowsPerCore) {}
+    coreUsage(PimCoreId coreId, unsigned numRowsPerCore, coreUsageIndex& usageIndex)
+      : m_coreId(coreId), m_numRowsPerCore(numRowsPerCore), m_usageIndex(usageIndex) {
+      m_usageIndex.emplace(m_totRowsInUse, m_coreId);
+      if (m_numRowsPerCore > 0) {
+        insertFreeExtent(0, m_numRowsPerCore);
+      }
+    }
     ~coreUsage() {}
     unsigned getNumRowsPerCore() const { return m_numRowsPerCore; }
     unsigned getTotRowsInUse() const { return m_totRowsInUse; }
-    unsigned findAvailRange(unsigned numRowsToAlloc);
+    unsigned findAvailRange(unsigned numRowsToAlloc) const;
     void addRange(std::pair<unsigned, unsigned> range, PimObjId objId);
-    void deleteObj(PimObjId objId);
+    void deleteObj(PimObjId objId, std::vector<std::pair<unsigned, unsigned>>& freedRanges);
+    bool isRangeInUse(unsigned rowIdx, unsigned numRows) const;
     void newAllocStart();
     void newAllocEnd(bool success);
   private:
+    void setTotRowsInUse(unsigned numRows);
+    void insertFreeExtent(unsigned rowIdx, unsigned numRows);
+    void eraseFreeExtent(std::map<unsigned, unsigned>::iterator it);
+    void reserveRows(unsigned rowIdx, unsigned numRows);
+    void releaseRows(unsigned rowIdx, unsigned numRows);
+    void eraseObjRange(PimObjId objId, std::pair<unsigned, unsigned> range);
+
+    PimCoreId m_coreId = -1;
     unsigned m_numRowsPerCore = 0;
     unsigned m_totRowsInUse = 0;
     std::map<std::pair<unsigned, unsigned>, PimObjId> m_rangesInUse;
+    std::unordered_map<PimObjId, std::vector<std::pair<unsigned, unsigned>>> m_objRanges;  // ranges in use of each object
+    std::map<unsigned, unsigned> m_freeByRowIdx;                // free extents: row index -> number of rows
+    std::set<std::pair<unsigned, unsigned>> m_freeByNumRows;    // free extents: (number of rows, row index)
     std::set<std::pair<unsigned, unsigned>> m_newAlloc;
+    coreUsageIndex& m_usageIndex;
   };
 
   pimDevice* m_device;
-  PimObjId m_availObjId;
-  std::unordered_map<PimObjId, pimObjInfo> m_objMap;
+  pimObjTable m_objTable;
+  coreUsageIndex m_coreUsageIndex;
   std::unordered_map<PimCoreId, std::unique_ptr<pimResMgr::coreUsage>> m_coreUsage;
   std::unordered_map<PimObjId, std::set<PimObjId>> m_refMap;
   bool m_debugAlloc = 0;
@@ -6,12 +6,19 @@
 #include "pimCmdFuse.h"
 #include "pimParamsDram.h"
 #include "pimStats.h"
+#include "pimProbe.h"
+#include "pimMemPool.h"
 #include "pimUtils.h"
 #include <cstdio>
 #include <memory>
 #include <algorithm>
 #include <string>
 
+// Monitor an API call for API stats, and probe it as a root scope of hot-path instrumentation
+#define PIM_API_SCOPE(tag) \
+  pimPerfMon perfMon(tag); \
+  PIM_PROBE_SCOPE_TAG(tag)
+
 // The pimSim singleton
 pimSim* pimSim::s_instance = nullptr;
 
@@ -50,7 +57,9 @@ pimSim::~pimSim()
 void
 pimSim::uninit()
 {
+  pimProbeMgr::setEnabled(false);
   m_device.reset();
+  pimMemPool::get().trim();
   m_threadPool.reset();
   m_statsMgr.reset();
   m_paramsDram.reset();
@@ -61,13 +70,18 @@ pimSim::uninit()
 bool
 pimSim::createDeviceFromConfig(PimDeviceEnum deviceType, const char* configFilePath)
 {
-  pimPerfMon perfMon("createDeviceFromConfig");
+  PIM_API_SCOPE("createDeviceFromConfig");
   uninit();
   bool success = m_config.init(deviceType, configFilePath);
-  if (!success) {
+  if (!success || !createDeviceCommon()) {
     return false;
   }
-  return createDeviceCommon();
+  // Start recording API trace. A trace may cover multiple device lifetimes
+  if (!m_traceWriter && !m_config.getTraceFile().empty()) {
+    m_traceWriter = std::make_unique<pimTraceWriter>(m_config.getTraceFile());
+  }
+  trace(pimTraceOp::CREATE_DEVICE, { static_cast<uint64_t>(deviceType) });
+  return true;
 }
 
 //! @brief  Common code to create a PIM device
@@ -81,6 +95,9 @@ pimSim::createDeviceCommon()
     m_paramsDram = pimParamsDram::create(m_config.getMemoryProtocol());
   }
 
+  // Configure host memory pool of PIM object data before any allocation
+  pimMemPool::get().configure(m_config.getMemPoolSize(), m_config.getHugePageMode());
+
   // Create PIM device
   m_device = std::make_unique<pimDevice>(m_config);
 
@@ -92,6 +109,8 @@ pimSim::createDeviceCommon()
 
   // Create stats mgr
   m_statsMgr = std::make_unique<pimStatsMgr>();
+  pimProbeMgr::resetStats();
+  pimProbeMgr::setEnabled(isDebug(pimSimConfig::DEBUG_PROBES));
 
   // Create thread pool
   if (getNumThreads() > 1) {
@@ -104,14 +123,19 @@ pimSim::createDeviceCommon()
 bool
 pimSim::deleteDevice()
 {
+  trace(pimTraceOp::DELETE_DEVICE);
   uninit();
+  // after pending stream commands are drained, so that their trace segments are complete
+  if (m_traceWriter) {
+    m_traceWriter->flush();
+  }
   return true;
 }
 
 //! @brief  Get device properties
 bool
 pimSim::getDeviceProperties(PimDeviceProperties* deviceProperties) {
-  pimPerfMon perfMon("getDeviceProperties");
+  PIM_API_SCOPE("getDeviceProperties");
   if (!m_device) {
     std::printf("PIM-Error: No PIM device exists.\n");
     return false;
@@ -184,6 +208,7 @@ pimSim::getPerfEnergyModel()
 void
 pimSim::startKernelTimer() const
 {
+  trace(pimTraceOp::START_TIMER);
   m_statsMgr->startKernelTimer();
 }
 
@@ -191,6 +216,13 @@ pimSim::startKernelTimer() const
 void
 pimSim::endKernelTimer() const
 {
+  if (m_traceWriter) {
+    trace(pimTraceOp::END_TIMER);
+    m_traceWriter->flush();
+  }
+  if (m_device) {
+    m_device->getStreamMgr()->syncAll();
+  }
   m_statsMgr->endKernelTimer();
 }
 
@@ -198,6 +230,13 @@ pimSim::endKernelTimer() const
 void
 pimSim::showStats() const
 {
+  if (m_traceWriter) {
+    trace(pimTraceOp::SHOW_STATS);
+    m_traceWriter->flush();
+  }
+  if (m_device) {
+    m_device->getStreamMgr()->syncAll();
+  }
   m_statsMgr->showStats();
 }
 
@@ -205,6 +244,10 @@ pimSim::showStats() const
 void
 pimSim::resetStats() const
 {
+  trace(pimTraceOp::RESET_STATS);
+  if (m_device) {
+    m_device->getStreamMgr()->syncAll();
+  }
   m_statsMgr->resetStats();
 }
 
@@ -212,34 +255,41 @@ pimSim::resetStats() const
 PimObjId
 pimSim::pimAlloc(PimAllocEnum allocType, uint64_t numElements, PimDataType dataType)
 {
-  pimPerfMon perfMon("pimAlloc");
+  PIM_API_SCOPE("pimAlloc");
   if (!isValidDevice()) { return -1; }
-  return m_device->pimAlloc(allocType, numElements, dataType);
+  PimObjId obj = m_device->pimAlloc(allocType, numElements, dataType);
+  trace(pimTraceOp::ALLOC, traceArgs(allocType, numElements, dataType, obj));
+  return obj;
 }
 
 //! @brief  Allocate a PIM object that is associated with an existing ojbect
 PimObjId
 pimSim::pimAllocAssociated(PimObjId assocId, PimDataType dataType)
 {
-  pimPerfMon perfMon("pimAllocAssociated");
+  PIM_API_SCOPE("pimAllocAssociated");
   if (!isValidDevice()) { return -1; }
-  return m_device->pimAllocAssociated(assocId, dataType);
+  PimObjId obj = m_device->pimAllocAssociated(assocId, dataType);
+  trace(pimTraceOp::ALLOC_ASSOCIATED, traceArgs(assocId, dataType, obj));
+  return obj;
 }
 
 PimObjId
 pimSim::pimAllocBuffer(uint32_t numElements, PimDataType dataType)
 {
-  pimPerfMon perfMon("pimAllocBuffer");
+  PIM_API_SCOPE("pimAllocBuffer");
   if (!isValidDevice()) { return -1; }
-  return m_device->pimAllocBuffer(numElements, dataType);
+  PimObjId obj = m_device->pimAllocBuffer(numElements, dataType);
+  trace(pimTraceOp::ALLOC_BUFFER, traceArgs(numElements, dataType, obj));
+  return obj;
 }
 
 // @brief  Free a PIM object
 bool
 pimSim::pimFree(PimObjId obj)
 {
-  pimPerfMon perfMon("pimFree");
+  PIM_API_SCOPE("pimFree");
   if (!isValidDevice()) { return false; }
+  trace(pimTraceOp::FREE, traceArgs(obj));
   return m_device->pimFree(obj);
 }
 
@@ -247,26 +297,63 @@ pimSim::pimFree(PimObjId obj)
 PimObjId
 pimSim::pimCreateRangedRef(PimObjId refId, uint64_t idxBegin, uint64_t idxEnd)
 {
-  pimPerfMon perfMon("pimCreateRangedRef");
+  PIM_API_SCOPE("pimCreateRangedRef");
   if (!isValidDevice()) { return -1; }
-  return m_device->pimCreateRangedRef(refId, idxBegin, idxEnd);
+  PimObjId obj = m_device->pimCreateRangedRef(refId, idxBegin, idxEnd);
+  trace(pimTraceOp::CREATE_RANGED_REF, traceArgs(refId, idxBegin, idxEnd, obj));
+  return obj;
 }
 
 //! @brief  Create an obj referencing to negation of an existing obj based on dual-contact memory cells
 PimObjId
 pimSim::pimCreateDualContactRef(PimObjId refId)
 {
-  pimPerfMon perfMon("pimCreateDualContactRef");
+  PIM_API_SCOPE("pimCreateDualContactRef");
   if (!isValidDevice()) { return -1; }
-  return m_device->pimCreateDualContactRef(refId);
+  PimObjId obj = m_device->pimCreateDualContactRef(refId);
+  trace(pimTraceOp::CREATE_DUAL_CONTACT_REF, traceArgs(refId, obj));
+  return obj;
+}
+
+//! @brief  Allocate a PIM object that uses a host buffer as zero-copy backing store
+PimObjId
+pimSim::pimAllocFromHostBuffer(PimAllocEnum allocType, uint64_t numElements, PimDataType dataType, void* hostBuffer)
+{
+  PIM_API_SCOPE("pimAllocFromHostBuffer");
+  if (!isValidDevice()) { return -1; }
+  PimObjId obj = m_device->pimAllocFromHostBuffer(allocType, numElements, dataType, hostBuffer);
+  trace(pimTraceOp::ALLOC_FROM_HOST_BUFFER, traceArgs(allocType, numElements, dataType, obj));
+  return obj;
+}
+
+//! @brief  Register a host buffer as zero-copy backing store of a PIM object
+bool
+pimSim::pimRegisterHostBuffer(PimObjId obj, void* hostBuffer)
+{
+  PIM_API_SCOPE("pimRegisterHostBuffer");
+  if (!isValidDevice()) { return false; }
+  trace(pimTraceOp::REGISTER_HOST_BUFFER, traceArgs(obj));
+  return m_device->pimRegisterHostBuffer(obj, hostBuffer);
+}
+
+//! @brief  Notify that the host wrote the registered host buffer of a PIM object
+//!         Traced as a full host-to-device copy, which replays from the replayer's own host buffer
+bool
+pimSim::pimMarkHostBufferModified(PimObjId obj)
+{
+  PIM_API_SCOPE("pimMarkHostBufferModified");
+  if (!isValidDevice()) { return false; }
+  traceCmd(PimCmdEnum::COPY_H2D, -1, obj, 0ULL, 0ULL);
+  return m_device->pimMarkHostBufferModified(obj);
 }
 
 // @brief  Copy data from main memory to PIM device within a range
 bool
 pimSim::pimCopyMainToDevice(void* src, PimObjId dest, uint64_t idxBegin, uint64_t idxEnd)
 {
-  pimPerfMon perfMon("pimCopyMainToDevice");
+  PIM_API_SCOPE("pimCopyMainToDevice");
   if (!isValidDevice()) { return false; }
+  traceCmd(PimCmdEnum::COPY_H2D, -1, dest, idxBegin, idxEnd);
   return m_device->pimCopyMainToDevice(src, dest, idxBegin, idxEnd);
 }
 
@@ -274,8 +361,9 @@ pimSim::pimCopyMainToDevice(void* src, PimObjId dest, uint64_t idxBegin, uint64_
 bool
 pimSim::pimCopyDeviceToMain(PimObjId src, void* dest, uint64_t idxBegin, uint64_t idxEnd)
 {
-  pimPerfMon perfMon("pimCopyDeviceToMain");
+  PIM_API_SCOPE("pimCopyDeviceToMain");
   if (!isValidDevice()) { return false; }
+  traceCmd(PimCmdEnum::COPY_D2H, -1, src, idxBegin, idxEnd);
   return m_device->pimCopyDeviceToMain(src, dest, idxBegin, idxEnd);
 }
 
@@ -283,8 +371,9 @@ pimSim::pimCopyDeviceToMain(PimObjId src, void* dest, uint64_t idxBegin, uint64_
 bool
 pimSim::pimCopyMainToDeviceWithType(PimCopyEnum copyType, void* src, PimObjId dest, uint64_t idxBegin, uint64_t idxEnd)
 {
-  pimPerfMon perfMon("pimCopyMainToDevice");
+  PIM_API_SCOPE("pimCopyMainToDevice");
   if (!isValidDevice()) { return false; }
+  traceCmd(PimCmdEnum::COPY_H2D, copyType, dest, idxBegin, idxEnd);
   return m_device->pimCopyMainToDeviceWithType(copyType, src, dest, idxBegin, idxEnd);
 }
 
@@ -292,24 +381,69 @@ pimSim::pimCopyMainToDeviceWithType(PimCopyEnum copyType, void* src, PimObjId de
 bool
 pimSim::pimCopyDeviceToMainWithType(PimCopyEnum copyType, PimObjId src, void* dest, uint64_t idxBegin, uint64_t idxEnd)
 {
-  pimPerfMon perfMon("pimCopyDeviceToMain");
+  PIM_API_SCOPE("pimCopyDeviceToMain");
   if (!isValidDevice()) { return false; }
+  traceCmd(PimCmdEnum::COPY_D2H, copyType, src, idxBegin, idxEnd);
   return m_device->pimCopyDeviceToMainWithType(copyType, src, dest, idxBegin, idxEnd);
 }
 
+// @brief  Copy data from a strided layout in main memory to PIM device within a range
+bool
+pimSim::pimCopyMainToDevice2D(void* src, PimObjId dest, uint64_t numElementsPerRow, uint64_t rowPitch, uint64_t elemStride, uint64_t idxBegin, uint64_t idxEnd)
+{
+  PIM_API_SCOPE("pimCopyMainToDevice2D");
+  if (!isValidDevice()) { return false; }
+  traceCmd(PimCmdEnum::COPY_H2D, -1, dest, idxBegin, idxEnd, numElementsPerRow, rowPitch, elemStride);
+  pimHostLayout srcLayout = { numElementsPerRow, rowPitch, elemStride };
+  return m_device->pimCopyMainToDevice2D(src, dest, srcLayout, idxBegin, idxEnd);
+}
+
+// @brief  Copy data from PIM device to a strided layout in main memory within a range
+bool
+pimSim::pimCopyDeviceToMain2D(PimObjId src, void* dest, uint64_t numElementsPerRow, uint64_t rowPitch, uint64_t elemStride, uint64_t idxBegin, uint64_t idxEnd)
+{
+  PIM_API_SCOPE("pimCopyDeviceToMain2D");
+  if (!isValidDevice()) { return false; }
+  traceCmd(PimCmdEnum::COPY_D2H, -1, src, idxBegin, idxEnd, numElementsPerRow, rowPitch, elemStride);
+  pimHostLayout destLayout = { numElementsPerRow, rowPitch, elemStride };
+  return m_device->pimCopyDeviceToMain2D(src, dest, destLayout, idxBegin, idxEnd);
+}
+
+// @brief  Copy data from main memory to PIM device for a batch of ranges
+bool
+pimSim::pimCopyMainToDeviceBatch(const PimCopyDesc* descs, uint64_t numDescs)
+{
+  PIM_API_SCOPE("pimCopyMainToDeviceBatch");
+  if (!isValidDevice()) { return false; }
+  traceCopyBatch(PimCmdEnum::COPY_H2D, descs, numDescs);
+  return m_device->pimCopyMainToDeviceBatch(descs, numDescs);
+}
+
+// @brief  Copy data from PIM device to main memory for a batch of ranges
+bool
+pimSim::pimCopyDeviceToMainBatch(const PimCopyDesc* descs, uint64_t numDescs)
+{
+  PIM_API_SCOPE("pimCopyDeviceToMainBatch");
+  if (!isValidDevice()) { return false; }
+  traceCopyBatch(PimCmdEnum::COPY_D2H, descs, numDescs);
+  return m_device->pimCopyDeviceToMainBatch(descs, numDescs);
+}
+
 // @brief  Copy data from PIM device to device within a range
 bool
 pimSim::pimCopyDeviceToDevice(PimObjId src, PimObjId dest, uint64_t idxBegin, uint64_t idxEnd)
 {
-  pimPerfMon perfMon("pimCopyDeviceToDevice");
+  PIM_API_SCOPE("pimCopyDeviceToDevice");
   if (!isValidDevice()) { return false; }
+  traceCmd(PimCmdEnum::COPY_D2D, src, dest, idxBegin, idxEnd);
   return m_device->pimCopyDeviceToDevice(src, dest, idxBegin, idxEnd);
 }
 
 bool pimSim::pimCopyObjectToObject(PimObjId src, PimObjId dest)
 {
-  pimPerfMon perfMon("pimCopyObjectToObject");
+  PIM_API_SCOPE("pimCopyObjectToObject");
   if (!isValidDevice()) { return false; }
+  traceCmd(PimCmdEnum::COPY_O2O, src, dest);
   std::unique_ptr<pimCmd> cmd = std::make_unique<pimCmdFunc1>(PimCmdEnum::COPY_O2O, src, dest);
   return m_device->executeCmd(std::move(cmd));
 }
@@ -317,8 +451,9 @@ bool pimSim::pimCopyObjectToObject(PimObjId src, PimObjId dest)
 bool
 pimSim::pimConvertType(PimObjId src, PimObjId dest)
 {
-  pimPerfMon perfMon("pimConvertType");
+  PIM_API_SCOPE("pimConvertType");
   if (!isValidDevice()) { return false; }
+  traceCmd(PimCmdEnum::CONVERT_TYPE, src, dest);
   std::unique_ptr<pimCmd> cmd = std::make_unique<pimCmdFunc1>(PimCmdEnum::CONVERT_TYPE, src, dest);
   return m_device->executeCmd(std::move(cmd));
 }
@@ -327,9 +462,10 @@ pimSim::pimConvertType(PimObjId src, PimObjId dest)
 template <typename T> bool
 pimSim::pimBroadcast(PimObjId dest, T value)
 {
-  pimPerfMon perfMon("pimBroadcast");
+  PIM_API_SCOPE("pimBroadcast");
   if (!isValidDevice()) { return false; }
   uint64_t signExtBits = pimUtils::castTypeToBits(value);
+  traceCmd(PimCmdEnum::BROADCAST, dest, signExtBits);
   std::unique_ptr<pimCmd> cmd = std::make_unique<pimCmdBroadcast>(PimCmdEnum::BROADCAST, dest, signExtBits);
   return m_device->executeCmd(std::move(cmd));
 }
@@ -338,8 +474,9 @@ pimSim::pimBroadcast(PimObjId dest, T value)
 bool
 pimSim::pimDiv(PimObjId src1, PimObjId src2, PimObjId dest)
 {
-  pimPerfMon perfMon("pimDiv");
+  PIM_API_SCOPE("pimDiv");
   if (!isValidDevice()) { return false; }
+  traceCmd(PimCmdEnum::DIV, src1, src2, dest);
   std::unique_ptr<pimCmd> cmd = std::make_unique<pimCmdFunc2>(PimCmdEnum::DIV, src1, src2, dest);
   return m_device->executeCmd(std::move(cmd));
 }
@@ -348,8 +485,9 @@ pimSim::pimDiv(PimObjId src1, PimObjId src2, PimObjId dest)
 bool
 pimSim::pimAbs(PimObjId src, PimObjId dest)
 {
-  pimPerfMon perfMon("pimAbs");
+  PIM_API_SCOPE("pimAbs");
   if (!isValidDevice()) { return false; }
+  traceCmd(PimCmdEnum::ABS, src, dest);
   std::unique_ptr<pimCmd> cmd = std::make_unique<pimCmdFunc1>(PimCmdEnum::ABS, src, dest);
   return m_device->executeCmd(std::move(cmd));
 }
@@ -358,8 +496,9 @@ pimSim::pimAbs(PimObjId src, PimObjId dest)
 bool
 pimSim::pimMul(PimObjId src1, PimObjId src2, PimObjId dest)
 {
-  pimPerfMon perfMon("pimMul");
+  PIM_API_SCOPE("pimMul");
   if (!isValidDevice()) { return false; }
+  traceCmd(PimCmdEnum::MUL, src1, src2, dest);
   std::unique_ptr<pimCmd> cmd = std::make_unique<pimCmdFunc2>(PimCmdEnum::MUL, src1, src2, dest);
   return m_device->executeCmd(std::move(cmd));
 }
@@ -368,8 +507,9 @@ pimSim::pimMul(PimObjId src1, PimObjId src2, PimObjId dest)
 bool
 pimSim::pimNot(PimObjId src, PimObjId dest)
 {
-  pimPerfMon perfMon("pimNot");
+  PIM_API_SCOPE("pimNot");
   if (!isValidDevice()) { return false; }
+  traceCmd(PimCmdEnum::NOT, src, dest);
   std::unique_ptr<pimCmd> cmd = std::make_unique<pimCmdFunc1>(PimCmdEnum::NOT, src, dest);
   return m_device->executeCmd(std::move(cmd));
 }
@@ -378,8 +518,9 @@ pimSim::pimNot(PimObjId src, PimObjId dest)
 bool
 pimSim::pimAnd(PimObjId src1, PimObjId src2, PimObjId dest)
 {
-  pimPerfMon perfMon("pimAnd");
+  PIM_API_SCOPE("pimAnd");
   if (!isValidDevice()) { return false; }
+  traceCmd(PimCmdEnum::AND, src1, src2, dest);
   std::unique_ptr<pimCmd> cmd = std::make_unique<pimCmdFunc2>(PimCmdEnum::AND, src1, src2, dest);
   return m_device->executeCmd(std::move(cmd));
 }
@@ -388,8 +529,9 @@ pimSim::pimAnd(PimObjId src1, PimObjId src2, PimObjId dest)
 bool
 pimSim::pimOr(PimObjId src1, PimObjId src2, PimObjId dest)
 {
-  pimPerfMon perfMon("pimOr");
+  PIM_API_SCOPE("pimOr");
   if (!isValidDevice()) { return false; }
+  traceCmd(PimCmdEnum::OR, src1, src2, dest);
   std::unique_ptr<pimCmd> cmd = std::make_unique<pimCmdFunc2>(PimCmdEnum::OR, src1, src2, dest);
   return m_device->executeCmd(std::move(cmd));
 }
@@ -398,8 +540,9 @@ pimSim::pimOr(PimObjId src1, PimObjId src2, PimObjId dest)
 bool
 pimSim::pimXor(PimObjId src1, PimObjId src2, PimObjId dest)
 {
-  pimPerfMon perfMon("pimXor");
+  PIM_API_SCOPE("pimXor");
   if (!isValidDevice()) { return false; }
+  traceCmd(PimCmdEnum::XOR, src1, src2, dest);
   std::unique_ptr<pimCmd> cmd = std::make_unique<pimCmdFunc2>(PimCmdEnum::XOR, src1, src2, dest);
   return m_device->executeCmd(std::move(cmd));
 }
@@ -408,8 +551,9 @@ pimSim::pimXor(PimObjId src1, PimObjId src2, PimObjId dest)
 bool
 pimSim::pimXnor(PimObjId src1, PimObjId src2, PimObjId dest)
 {
-  pimPerfMon perfMon("pimXnor");
+  PIM_API_SCOPE("pimXnor");
   if (!isValidDevice()) { return false; }
+  traceCmd(PimCmdEnum::XNOR, src1, src2, dest);
   std::unique_ptr<pimCmd> cmd = std::make_unique<pimCmdFunc2>(PimCmdEnum::XNOR, src1, src2, dest);
   return m_device->executeCmd(std::move(cmd));
 }
@@ -418,8 +562,9 @@ pimSim::pimXnor(PimObjId src1, PimObjId src2, PimObjId dest)
 bool
 pimSim::pimGT(PimObjId src1, PimObjId src2, PimObjId dest)
 {
-  pimPerfMon perfMon("pimGT");
+  PIM_API_SCOPE("pimGT");
   if (!isValidDevice()) { return false; }
+  traceCmd(PimCmdEnum::GT, src1, src2, dest);
   std::unique_ptr<pimCmd> cmd = std::make_unique<pimCmdFunc2>(PimCmdEnum::GT, src1, src2, dest);
   return m_device->executeCmd(std::move(cmd));
 }
@@ -428,8 +573,9 @@ pimSim::pimGT(PimObjId src1, PimObjId src2, PimObjId dest)
 bool
 pimSim::pimLT(PimObjId src1, PimObjId src2, PimObjId dest)
 {
-  pimPerfMon perfMon("pimLT");
+  PIM_API_SCOPE("pimLT");
   if (!isValidDevice()) { return false; }
+  traceCmd(PimCmdEnum::LT, src1, src2, dest);
   std::unique_ptr<pimCmd> cmd = std::make_unique<pimCmdFunc2>(PimCmdEnum::LT, src1, src2, dest);
   return m_device->executeCmd(std::move(cmd));
 }
@@ -438,8 +584,9 @@ pimSim::pimLT(PimObjId src1, PimObjId src2, PimObjId dest)
 bool
 pimSim::pimEQ(PimObjId src1, PimObjId src2, PimObjId dest)
 {
-  pimPerfMon perfMon("pimEQ");
+  PIM_API_SCOPE("pimEQ");
   if (!isValidDevice()) { return false; }
+  traceCmd(PimCmdEnum::EQ, src1, src2, dest);
   std::unique_ptr<pimCmd> cmd = std::make_unique<pimCmdFunc2>(PimCmdEnum::EQ, src1, src2, dest);
   return m_device->executeCmd(std::move(cmd));
 }
@@ -448,8 +595,9 @@ pimSim::pimEQ(PimObjId src1, PimObjId src2, PimObjId dest)
 bool
 pimSim::pimNE(PimObjId src1, PimObjId src2, PimObjId dest)
 {
-  pimPerfMon perfMon("pimNE");
+  PIM_API_SCOPE("pimNE");
   if (!isValidDevice()) { return false; }
+  traceCmd(PimCmdEnum::NE, src1, src2, dest);
   std::unique_ptr<pimCmd> cmd = std::make_unique<pimCmdFunc2>(PimCmdEnum::NE, src1, src2, dest);
   return m_device->executeCmd(std::move(cmd));
 }
@@ -458,8 +606,9 @@ pimSim::pimNE(PimObjId src1, PimObjId src2, PimObjId dest)
 bool
 pimSim::pimMin(PimObjId src1, PimObjId src2, PimObjId dest)
 {
-  pimPerfMon perfMon("pimMin");
+  PIM_API_SCOPE("pimMin");
   if (!isValidDevice()) { return false; }
+  traceCmd(PimCmdEnum::MIN, src1, src2, dest);
   std::unique_ptr<pimCmd> cmd = std::make_unique<pimCmdFunc2>(PimCmdEnum::MIN, src1, src2, dest);
   return m_device->executeCmd(std::move(cmd));
 }
@@ -468,111 +617,125 @@ pimSim::pimMin(PimObjId src1, PimObjId src2, PimObjId dest)
 bool
 pimSim::pimMax(PimObjId src1, PimObjId src2, PimObjId dest)
 {
-  pimPerfMon perfMon("pimMax");
+  PIM_API_SCOPE("pimMax");
   if (!isValidDevice()) { return false; }
+  traceCmd(PimCmdEnum::MAX, src1, src2, dest);
   std::unique_ptr<pimCmd> cmd = std::make_unique<pimCmdFunc2>(PimCmdEnum::MAX, src1, src2, dest);
   return m_device->executeCmd(std::move(cmd));
 }
 
 bool pimSim::pimMul(PimObjId src, PimObjId dest, uint64_t scalarValue)
 {
-  pimPerfMon perfMon("pimMulScalar");
+  PIM_API_SCOPE("pimMulScalar");
   if (!isValidDevice()) { return false; }
+  traceCmd(PimCmdEnum::MUL_SCALAR, src, dest, scalarValue);
   std::unique_ptr<pimCmd> cmd = std::make_unique<pimCmdFunc1>(PimCmdEnum::MUL_SCALAR, src, dest, scalarValue);
   return m_device->executeCmd(std::move(cmd));
 }
 
 bool pimSim::pimDiv(PimObjId src, PimObjId dest, uint64_t scalarValue)
 {
-  pimPerfMon perfMon("pimDivScalar");
+  PIM_API_SCOPE("pimDivScalar");
   if (!isValidDevice()) { return false; }
+  traceCmd(PimCmdEnum::DIV_SCALAR, src, dest, scalarValue);
   std::unique_ptr<pimCmd> cmd = std::make_unique<pimCmdFunc1>(PimCmdEnum::DIV_SCALAR, src, dest, scalarValue);
   return m_device->executeCmd(std::move(cmd));
 }
 
 bool pimSim::pimAnd(PimObjId src, PimObjId dest, uint64_t scalarValue)
 {
-  pimPerfMon perfMon("pimAndScalar");
+  PIM_API_SCOPE("pimAndScalar");
   if (!isValidDevice()) { return false; }
+  traceCmd(PimCmdEnum::AND_SCALAR, src, dest, scalarValue);
   std::unique_ptr<pimCmd> cmd = std::make_unique<pimCmdFunc1>(PimCmdEnum::AND_SCALAR, src, dest, scalarValue);
   return m_device->executeCmd(std::move(cmd));
 }
 
 bool pimSim::pimOr(PimObjId src, PimObjId dest, uint64_t scalarValue)
 {
-  pimPerfMon perfMon("pimOrScalar");
+  PIM_API_SCOPE("pimOrScalar");
   if (!isValidDevice()) { return false; }
+  traceCmd(PimCmdEnum::OR_SCALAR, src, dest, scalarValue);
   std::unique_ptr<pimCmd> cmd = std::make_unique<pimCmdFunc1>(PimCmdEnum::OR_SCALAR, src, dest, scalarValue);
   return m_device->executeCmd(std::move(cmd));
 }
 
 bool pimSim::pimXor(PimObjId src, PimObjId dest, uint64_t scalarValue)
 {
-  pimPerfMon perfMon("pimXorScalar");
+  PIM_API_SCOPE("pimXorScalar");
   if (!isValidDevice()) { return false; }
+  traceCmd(PimCmdEnum::XOR_SCALAR, src, dest, scalarValue);
   std::unique_ptr<pimCmd> cmd = std::make_unique<pimCmdFunc1>(PimCmdEnum::XOR_SCALAR, src, dest, scalarValue);
   return m_device->executeCmd(std::move(cmd));
 }
 
 bool pimSim::pimXnor(PimObjId src, PimObjId dest, uint64_t scalarValue)
 {
-  pimPerfMon perfMon("pimXnorScalar");
+  PIM_API_SCOPE("pimXnorScalar");
   if (!isValidDevice()) { return false; }
+  traceCmd(PimCmdEnum::XNOR_SCALAR, src, dest, scalarValue);
   std::unique_ptr<pimCmd> cmd = std::make_unique<pimCmdFunc1>(PimCmdEnum::XNOR_SCALAR, src, dest, scalarValue);
   return m_device->executeCmd(std::move(cmd));
 }
 
 bool pimSim::pimGT(PimObjId src, PimObjId dest, uint64_t scalarValue)
 {
-  pimPerfMon perfMon("pimGTScalar");
+  PIM_API_SCOPE("pimGTScalar");
   if (!isValidDevice()) { return false; }
+  traceCmd(PimCmdEnum::GT_SCALAR, src, dest, scalarValue);
   std::unique_ptr<pimCmd> cmd = std::make_unique<pimCmdFunc1>(PimCmdEnum::GT_SCALAR, src, dest, scalarValue);
   return m_device->executeCmd(std::move(cmd));
 }
 
 bool pimSim::pimLT(PimObjId src, PimObjId dest, uint64_t scalarValue)
 {
-  pimPerfMon perfMon("pimLTScalar");
+  PIM_API_SCOPE("pimLTScalar");
   if (!isValidDevice()) { return false; }
+  traceCmd(PimCmdEnum::LT_SCALAR, src, dest, scalarValue);
   std::unique_ptr<pimCmd> cmd = std::make_unique<pimCmdFunc1>(PimCmdEnum::LT_SCALAR, src, dest, scalarValue);
   return m_device->executeCmd(std::move(cmd));
 }
 
 bool pimSim::pimEQ(PimObjId src, PimObjId dest, uint64_t scalarValue)
 {
-  pimPerfMon perfMon("pimEQScalar");
+  PIM_API_SCOPE("pimEQScalar");
   if (!isValidDevice()) { return false; }
+  traceCmd(PimCmdEnum::EQ_SCALAR, src, dest, scalarValue);
   std::unique_ptr<pimCmd> cmd = std::make_unique<pimCmdFunc1>(PimCmdEnum::EQ_SCALAR, src, dest, scalarValue);
   return m_device->executeCmd(std::move(cmd));
 }
 
 bool pimSim::pimNE(PimObjId src, PimObjId dest, uint64_t scalarValue)
 {
-  pimPerfMon perfMon("pimNEScalar");
+  PIM_API_SCOPE("pimNEScalar");
   if (!isValidDevice()) { return false; }
+  traceCmd(PimCmdEnum::NE_SCALAR, src, dest, scalarValue);
   std::unique_ptr<pimCmd> cmd = std::make_unique<pimCmdFunc1>(PimCmdEnum::NE_SCALAR, src, dest, scalarValue);
   return m_device->executeCmd(std::move(cmd));
 }
 
 bool pimSim::pimMin(PimObjId src, PimObjId dest, uint64_t scalarValue)
 {
-  pimPerfMon perfMon("pimMinScalar");
+  PIM_API_SCOPE("pimMinScalar");
   if (!isValidDevice()) { return false; }
+  traceCmd(PimCmdEnum::MIN_SCALAR, src, dest, scalarValue);
   std::unique_ptr<pimCmd> cmd = std::make_unique<pimCmdFunc1>(PimCmdEnum::MIN_SCALAR, src, dest, scalarValue);
   return m_device->executeCmd(std::move(cmd));
 }
 
 bool pimSim::pimMax(PimObjId src, PimObjId dest, uint64_t scalarValue)
 {
-  pimPerfMon perfMon("pimMaxScalar");
+  PIM_API_SCOPE("pimMaxScalar");
   if (!isValidDevice()) { return false; }
+  traceCmd(PimCmdEnum::MAX_SCALAR, src, dest, scalarValue);
   std::unique_ptr<pimCmd> cmd = std::make_unique<pimCmdFunc1>(PimCmdEnum::MAX_SCALAR, src, dest, scalarValue);
   return m_device->executeCmd(std::move(cmd));
 }
 
 bool pimSim::pimScaledAdd(PimObjId src1, PimObjId src2, PimObjId dest, uint64_t scalarValue) {
-  pimPerfMon perfMon("pimScaledAdd");
+  PIM_API_SCOPE("pimScaledAdd");
   if (!isValidDevice()) { return false; }
+  traceCmd(PimCmdEnum::SCALED_ADD, src1, src2, dest, scalarValue);
   std::unique_ptr<pimCmd> cmd = std::make_unique<pimCmdFunc2>(PimCmdEnum::SCALED_ADD, src1, src2, dest, scalarValue);
   return m_device->executeCmd(std::move(cmd));
 }
@@ -581,8 +744,9 @@ bool pimSim::pimScaledAdd(PimObjId src1, PimObjId src2, PimObjId dest, uint64_t
 bool
 pimSim::pimPopCount(PimObjId src, PimObjId dest)
 {
-  pimPerfMon perfMon("pimPopCount");
+  PIM_API_SCOPE("pimPopCount");
   if (!isValidDevice()) { return false; }
+  traceCmd(PimCmdEnum::POPCOUNT, src, dest);
   std::unique_ptr<pimCmd> cmd = std::make_unique<pimCmdFunc1>(PimCmdEnum::POPCOUNT, src, dest);
   return m_device->executeCmd(std::move(cmd));
 }
@@ -590,8 +754,9 @@ pimSim::pimPopCount(PimObjId src, PimObjId dest)
  //! @brief  PIM OP: multiply-accumulate
 bool pimSim::pimMAC(PimObjId src1, PimObjId src2, void* dest)
 {
-  pimPerfMon perfMon("pimMAC");
+  PIM_API_SCOPE("pimMAC");
   if (!isValidDevice()) { return false; }
+  traceCmd(PimCmdEnum::MAC, src1, src2);
   const PimDataType dataType = m_device->getResMgr()->getObjInfo(src1).getDataType();
   std::unique_ptr<pimCmd> cmd;
   PimCmdEnum cmdType = PimCmdEnum::MAC;
@@ -636,10 +801,11 @@ bool pimSim::pimMAC(PimObjId src1, PimObjId src2, void* dest)
 
 //! @brief  Min reduction operation
 bool pimSim::pimRedMin(PimObjId src, void* min, uint64_t idxBegin, uint64_t idxEnd) {
-  std::string tag = (idxBegin != idxEnd && idxBegin < idxEnd) ? "pimRedMinRanged" : "pimRedMin";
-  pimPerfMon perfMon(tag);
+  const char* tag = (idxBegin != idxEnd && idxBegin < idxEnd) ? "pimRedMinRanged" : "pimRedMin";
+  PIM_API_SCOPE(tag);
   if (!isValidDevice()) { return false; }
   if (!min) { return false; }
+  traceCmd(PimCmdEnum::REDMIN, src, idxBegin, idxEnd);
 
   // Create the reduction command for Min operation
   const PimDataType dataType = m_device->getResMgr()->getObjInfo(src).getDataType();
@@ -685,10 +851,11 @@ bool pimSim::pimRedMin(PimObjId src, void* min, uint64_t idxBegin, uint64_t idxE
 
 //! @brief  Max reduction operation
 bool pimSim::pimRedMax(PimObjId src, void* max, uint64_t idxBegin, uint64_t idxEnd) {
-  std::string tag = (idxBegin != idxEnd && idxBegin < idxEnd) ? "pimRedMaxRanged" : "pimRedMax";
-  pimPerfMon perfMon(tag);
+  const char* tag = (idxBegin != idxEnd && idxBegin < idxEnd) ? "pimRedMaxRanged" : "pimRedMax";
+  PIM_API_SCOPE(tag);
   if (!isValidDevice()) { return false; }
   if (!max) { return false; }
+  traceCmd(PimCmdEnum::REDMAX, src, idxBegin, idxEnd);
 
   // Create the reduction command for Max operation
   const PimDataType dataType = m_device->getResMgr()->getObjInfo(src).getDataType();
@@ -735,10 +902,11 @@ bool pimSim::pimRedMax(PimObjId src, void* max, uint64_t idxBegin, uint64_t idxE
 bool
 pimSim::pimRedSum(PimObjId src, void* sum, uint64_t idxBegin, uint64_t idxEnd)
 {
-  std::string tag = (idxBegin != idxEnd && idxBegin < idxEnd) ? "pimRedSumRanged" : "pimRedSum";
-  pimPerfMon perfMon(tag);
+  const char* tag = (idxBegin != idxEnd && idxBegin < idxEnd) ? "pimRedSumRanged" : "pimRedSum";
+  PIM_API_SCOPE(tag);
   if (!isValidDevice()) { return false; }
   if (!sum) { return false; }
+  traceCmd(PimCmdEnum::REDSUM, src, idxBegin, idxEnd);
 
   const PimDataType dataType = m_device->getResMgr()->getObjInfo(src).getDataType();
   std::unique_ptr<pimCmd> cmd;
@@ -774,8 +942,9 @@ pimSim::pimRedSum(PimObjId src, void* sum, uint64_t idxBegin, uint64_t idxEnd)
 bool
 pimSim::pimBitSliceExtract(PimObjId src, PimObjId destBool, unsigned bitIdx)
 {
-  pimPerfMon perfMon("pimBitSliceExtract");
+  PIM_API_SCOPE("pimBitSliceExtract");
   if (!isValidDevice()) { return false; }
+  traceCmd(PimCmdEnum::BIT_SLICE_EXTRACT, src, destBool, bitIdx);
   std::unique_ptr<pimCmd> cmd = std::make_unique<pimCmdFunc1>(PimCmdEnum::BIT_SLICE_EXTRACT, src, destBool, bitIdx);
   return m_device->executeCmd(std::move(cmd));
 }
@@ -784,8 +953,9 @@ pimSim::pimBitSliceExtract(PimObjId src, PimObjId destBool, unsigned bitIdx)
 bool
 pimSim::pimBitSliceInsert(PimObjId srcBool, PimObjId dest, unsigned bitIdx)
 {
-  pimPerfMon perfMon("pimBitSliceInsert");
+  PIM_API_SCOPE("pimBitSliceInsert");
   if (!isValidDevice()) { return false; }
+  traceCmd(PimCmdEnum::BIT_SLICE_INSERT, srcBool, dest, bitIdx);
   std::unique_ptr<pimCmd> cmd = std::make_unique<pimCmdFunc1>(PimCmdEnum::BIT_SLICE_INSERT, srcBool, dest, bitIdx);
   return m_device->executeCmd(std::move(cmd));
 }
@@ -793,8 +963,9 @@ pimSim::pimBitSliceInsert(PimObjId srcBool, PimObjId dest, unsigned bitIdx)
 bool
 pimSim::pimCondCopy(PimObjId condBool, PimObjId src, PimObjId dest)
 {
-  pimPerfMon perfMon("pimCondCopy");
+  PIM_API_SCOPE("pimCondCopy");
   if (!isValidDevice()) { return false; }
+  traceCmd(PimCmdEnum::COND_COPY, condBool, src, dest);
   std::unique_ptr<pimCmd> cmd = std::make_unique<pimCmdCond>(PimCmdEnum::COND_COPY, condBool, src, dest);
   return m_device->executeCmd(std::move(cmd));
 }
@@ -802,8 +973,9 @@ pimSim::pimCondCopy(PimObjId condBool, PimObjId src, PimObjId dest)
 bool
 pimSim::pimCondBroadcast(PimObjId condBool, uint64_t scalarBits, PimObjId dest)
 {
-  pimPerfMon perfMon("pimCondBroadcast");
+  PIM_API_SCOPE("pimCondBroadcast");
   if (!isValidDevice()) { return false; }
+  traceCmd(PimCmdEnum::COND_BROADCAST, condBool, scalarBits, dest);
   std::unique_ptr<pimCmd> cmd = std::make_unique<pimCmdCond>(PimCmdEnum::COND_BROADCAST, condBool, scalarBits, dest);
   return m_device->executeCmd(std::move(cmd));
 }
@@ -811,8 +983,9 @@ pimSim::pimCondBroadcast(PimObjId condBool, uint64_t scalarBits, PimObjId dest)
 bool
 pimSim::pimCondSelect(PimObjId condBool, PimObjId src1, PimObjId src2, PimObjId dest)
 {
-  pimPerfMon perfMon("pimCondSelect");
+  PIM_API_SCOPE("pimCondSelect");
   if (!isValidDevice()) { return false; }
+  traceCmd(PimCmdEnum::COND_SELECT, condBool, src1, src2, dest);
   std::unique_ptr<pimCmd> cmd = std::make_unique<pimCmdCond>(PimCmdEnum::COND_SELECT, condBool, src1, src2, dest);
   return m_device->executeCmd(std::move(cmd));
 }
@@ -820,8 +993,9 @@ pimSim::pimCondSelect(PimObjId condBool, PimObjId src1, PimObjId src2, PimObjId
 bool
 pimSim::pimCondSelectScalar(PimObjId condBool, PimObjId src1, uint64_t scalarBits, PimObjId dest)
 {
-  pimPerfMon perfMon("pimCondSelectScalar");
+  PIM_API_SCOPE("pimCondSelectScalar");
   if (!isValidDevice()) { return false; }
+  traceCmd(PimCmdEnum::COND_SELECT_SCALAR, condBool, src1, scalarBits, dest);
   std::unique_ptr<pimCmd> cmd = std::make_unique<pimCmdCond>(PimCmdEnum::COND_SELECT_SCALAR, condBool, src1, scalarBits, dest);
   return m_device->executeCmd(std::move(cmd));
 }
@@ -829,8 +1003,9 @@ pimSim::pimCondSelectScalar(PimObjId condBool, PimObjId src1, uint64_t scalarBit
 bool
 pimSim::pimRotateElementsRight(PimObjId src)
 {
-  pimPerfMon perfMon("pimRotateElementsRight");
+  PIM_API_SCOPE("pimRotateElementsRight");
   if (!isValidDevice()) { return false; }
+  traceCmd(PimCmdEnum::ROTATE_ELEM_R, src);
   std::unique_ptr<pimCmd> cmd = std::make_unique<pimCmdRotate>(PimCmdEnum::ROTATE_ELEM_R, src);
   return m_device->executeCmd(std::move(cmd));
 }
@@ -838,8 +1013,9 @@ pimSim::pimRotateElementsRight(PimObjId src)
 bool
 pimSim::pimRotateElementsLeft(PimObjId src)
 {
-  pimPerfMon perfMon("pimRotateElementsLeft");
+  PIM_API_SCOPE("pimRotateElementsLeft");
   if (!isValidDevice()) { return false; }
+  traceCmd(PimCmdEnum::ROTATE_ELEM_L, src);
   std::unique_ptr<pimCmd> cmd = std::make_unique<pimCmdRotate>(PimCmdEnum::ROTATE_ELEM_L, src);
   return m_device->executeCmd(std::move(cmd));
 }
@@ -847,8 +1023,9 @@ pimSim::pimRotateElementsLeft(PimObjId src)
 bool
 pimSim::pimShiftElementsRight(PimObjId src)
 {
-  pimPerfMon perfMon("pimShiftElementsRight");
+  PIM_API_SCOPE("pimShiftElementsRight");
   if (!isValidDevice()) { return false; }
+  traceCmd(PimCmdEnum::SHIFT_ELEM_R, src);
   std::unique_ptr<pimCmd> cmd = std::make_unique<pimCmdRotate>(PimCmdEnum::SHIFT_ELEM_R, src);
   return m_device->executeCmd(std::move(cmd));
 }
@@ -856,8 +1033,9 @@ pimSim::pimShiftElementsRight(PimObjId src)
 bool
 pimSim::pimShiftElementsLeft(PimObjId src)
 {
-  pimPerfMon perfMon("pimShiftElementsLeft");
+  PIM_API_SCOPE("pimShiftElementsLeft");
   if (!isValidDevice()) { return false; }
+  traceCmd(PimCmdEnum::SHIFT_ELEM_L, src);
   std::unique_ptr<pimCmd> cmd = std::make_unique<pimCmdRotate>(PimCmdEnum::SHIFT_ELEM_L, src);
   return m_device->executeCmd(std::move(cmd));
 }
@@ -865,8 +1043,9 @@ pimSim::pimShiftElementsLeft(PimObjId src)
 bool
 pimSim::pimShiftBitsRight(PimObjId src, PimObjId dest, unsigned shiftAmount)
 {
-  pimPerfMon perfMon("pimShiftBitsRight");
+  PIM_API_SCOPE("pimShiftBitsRight");
   if (!isValidDevice()) { return false; }
+  traceCmd(PimCmdEnum::SHIFT_BITS_R, src, dest, shiftAmount);
   std::unique_ptr<pimCmd> cmd = std::make_unique<pimCmdFunc1>(PimCmdEnum::SHIFT_BITS_R, src, dest, shiftAmount);
   return m_device->executeCmd(std::move(cmd));
 }
@@ -874,8 +1053,9 @@ pimSim::pimShiftBitsRight(PimObjId src, PimObjId dest, unsigned shiftAmount)
 bool
 pimSim::pimShiftBitsLeft(PimObjId src, PimObjId dest, unsigned shiftAmount)
 {
-  pimPerfMon perfMon("pimShiftBitsLeft");
+  PIM_API_SCOPE("pimShiftBitsLeft");
   if (!isValidDevice()) { return false; }
+  traceCmd(PimCmdEnum::SHIFT_BITS_L, src, dest, shiftAmount);
   std::unique_ptr<pimCmd> cmd = std::make_unique<pimCmdFunc1>(PimCmdEnum::SHIFT_BITS_L, src, dest, shiftAmount);
   return m_device->executeCmd(std::move(cmd));
 }
@@ -883,8 +1063,13 @@ pimSim::pimShiftBitsLeft(PimObjId src, PimObjId dest, unsigned shiftAmount)
 bool 
 pimSim::pimAesSbox(PimObjId src, PimObjId dest, const std::vector<uint8_t>& lut)
 {
-  pimPerfMon perfMon("pimAesSbox");
+  PIM_API_SCOPE("pimAesSbox");
   if (!isValidDevice()) { return false; }
+  if (m_traceWriter) {
+    std::vector<uint64_t> args = { static_cast<uint64_t>(PimCmdEnum::AES_SBOX), static_cast<uint64_t>(src), static_cast<uint64_t>(dest) };
+    args.insert(args.end(), lut.begin(), lut.end());
+    trace(pimTraceOp::CMD, args);
+  }
   std::unique_ptr<pimCmd> cmd = std::make_unique<pimCmdFunc1>(PimCmdEnum::AES_SBOX, src, dest, lut);
   return m_device->executeCmd(std::move(cmd));
 }
@@ -892,8 +1077,13 @@ pimSim::pimAesSbox(PimObjId src, PimObjId dest, const std::vector<uint8_t>& lut)
 bool 
 pimSim::pimAesInverseSbox(PimObjId src, PimObjId dest, const std::vector<uint8_t>& lut)
 {
-  pimPerfMon perfMon("pimAesInverseSbox");
+  PIM_API_SCOPE("pimAesInverseSbox");
   if (!isValidDevice()) { return false; }
+  if (m_traceWriter) {
+    std::vector<uint64_t> args = { static_cast<uint64_t>(PimCmdEnum::AES_INVERSE_SBOX), static_cast<uint64_t>(src), static_cast<uint64_t>(dest) };
+    args.insert(args.end(), lut.begin(), lut.end());
+    trace(pimTraceOp::CMD, args);
+  }
   std::unique_ptr<pimCmd> cmd = std::make_unique<pimCmdFunc1>(PimCmdEnum::AES_INVERSE_SBOX, src, dest, lut);
   return m_device->executeCmd(std::move(cmd));
 }
@@ -901,12 +1091,79 @@ pimSim::pimAesInverseSbox(PimObjId src, PimObjId dest, const std::vector<uint8_t
 bool
 pimSim::pimFuse(PimProg prog)
 {
-  pimPerfMon perfMon("pimFuse");
+  PIM_API_SCOPE("pimFuse");
   if (!isValidDevice()) { return false; }
-  std::unique_ptr<pimCmd> cmd = std::make_unique<pimCmdFuse>(prog);
+  std::unique_ptr<pimCmdFuse> cmd = std::make_unique<pimCmdFuse>(prog);
+  // APIs of the program are recorded while they run, into a segment at the position of this call.
+  // APIs of a fused program within another one are recorded into the segment of the outer program
+  if (m_traceWriter && !pimTraceWriter::isInSegment()) {
+    cmd->setTraceSegment(m_traceWriter.get(), m_traceWriter->openSegment(pimTraceOp::FUSE_BEGIN));
+  }
   return m_device->executeCmd(std::move(cmd));
 }
 
+//! @brief  Create an asynchronous command stream
+PimStreamId
+pimSim::pimStreamCreate()
+{
+  PIM_API_SCOPE("pimStreamCreate");
+  if (!isValidDevice()) { return -1; }
+  PimStreamId stream = m_device->getStreamMgr()->createStream();
+  trace(pimTraceOp::STREAM_CREATE, traceArgs(stream));
+  return stream;
+}
+
+//! @brief  Destroy an asynchronous command stream after its pending commands complete
+bool
+pimSim::pimStreamDestroy(PimStreamId stream)
+{
+  PIM_API_SCOPE("pimStreamDestroy");
+  if (!isValidDevice()) { return false; }
+  trace(pimTraceOp::STREAM_DESTROY, traceArgs(stream));
+  return m_device->getStreamMgr()->destroyStream(stream);
+}
+
+//! @brief  Set the stream that PIM commands of the calling host thread are enqueued to, or -1 for synchronous execution
+bool
+pimSim::pimSetStream(PimStreamId stream)
+{
+  PIM_API_SCOPE("pimSetStream");
+  if (!isValidDevice()) { return false; }
+  trace(pimTraceOp::SET_STREAM, traceArgs(stream));
+  return m_device->getStreamMgr()->setCurrentStream(stream);
+}
+
+//! @brief  Wait for all commands enqueued to a stream
+bool
+pimSim::pimStreamSync(PimStreamId stream)
+{
+  PIM_API_SCOPE("pimStreamSync");
+  if (!isValidDevice()) { return false; }
+  trace(pimTraceOp::STREAM_SYNC, traceArgs(stream));
+  return m_device->getStreamMgr()->syncStream(stream);
+}
+
+//! @brief  Record an event at the current end of a stream
+PimEventId
+pimSim::pimEventRecord(PimStreamId stream)
+{
+  PIM_API_SCOPE("pimEventRecord");
+  if (!isValidDevice()) { return -1; }
+  PimEventId event = m_device->getStreamMgr()->recordEvent(stream);
+  trace(pimTraceOp::EVENT_RECORD, traceArgs(stream, event));
+  return event;
+}
+
+//! @brief  Wait for commands enqueued before an event
+bool
+pimSim::pimEventWait(PimEventId event)
+{
+  PIM_API_SCOPE("pimEventWait");
+  if (!isValidDevice()) { return false; }
+  trace(pimTraceOp::EVENT_WAIT, traceArgs(event));
+  return m_device->getStreamMgr()->waitEvent(event);
+}
+
 // Explicit template instantiations
 template bool pimSim::pimBroadcast<uint64_t>(PimObjId dest, uint64_t value);
 template bool pimSim::pimBroadcast<int64_t>(PimObjId dest, int64_t value);
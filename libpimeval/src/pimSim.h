@@ -10,8 +10,10 @@
 #include "pimParamsDram.h"
 #include "pimPerfEnergyBase.h"
 #include "pimStats.h"
+#include "pimTrace.h"
 #include <cstdarg>
 #include <memory>
+#include <mutex>
 
 
 //! @class  pimSim
@@ -54,6 +56,7 @@ public:
   pimPerfEnergyBase* getPerfEnergyModel();
 
   pimUtils::threadPool* getThreadPool() { return m_threadPool.get(); }
+  std::recursive_mutex& getExecMutex() { return m_execMutex; }
 
   // Resource allocation and deletion
   PimObjId pimAlloc(PimAllocEnum allocType, uint64_t numElements, PimDataType dataType);
@@ -62,12 +65,19 @@ public:
   bool pimFree(PimObjId obj);
   PimObjId pimCreateRangedRef(PimObjId refId, uint64_t idxBegin, uint64_t idxEnd);
   PimObjId pimCreateDualContactRef(PimObjId refId);
+  PimObjId pimAllocFromHostBuffer(PimAllocEnum allocType, uint64_t numElements, PimDataType dataType, void* hostBuffer);
+  bool pimRegisterHostBuffer(PimObjId obj, void* hostBuffer);
+  bool pimMarkHostBufferModified(PimObjId obj);
 
   // Data transfer
   bool pimCopyMainToDevice(void* src, PimObjId dest, uint64_t idxBegin = 0, uint64_t idxEnd = 0);
   bool pimCopyDeviceToMain(PimObjId src, void* dest, uint64_t idxBegin = 0, uint64_t idxEnd = 0);
   bool pimCopyMainToDeviceWithType(PimCopyEnum copyType, void* src, PimObjId dest, uint64_t idxBegin = 0, uint64_t idxEnd = 0);
   bool pimCopyDeviceToMainWithType(PimCopyEnum copyType, PimObjId src, void* dest, uint64_t idxBegin = 0, uint64_t idxEnd = 0);
+  bool pimCopyMainToDevice2D(void* src, PimObjId dest, uint64_t numElementsPerRow, uint64_t rowPitch, uint64_t elemStride = 0, uint64_t idxBegin = 0, uint64_t idxEnd = 0);
+  bool pimCopyDeviceToMain2D(PimObjId src, void* dest, uint64_t numElementsPerRow, uint64_t rowPitch, uint64_t elemStride = 0, uint64_t idxBegin = 0, uint64_t idxEnd = 0);
+  bool pimCopyMainToDeviceBatch(const PimCopyDesc* descs, uint64_t numDescs);
+  bool pimCopyDeviceToMainBatch(const PimCopyDesc* descs, uint64_t numDescs);
   bool pimCopyDeviceToDevice(PimObjId src, PimObjId dest, uint64_t idxBegin = 0, uint64_t idxEnd = 0);
   bool pimCopyObjectToObject(PimObjId src, PimObjId dest);
   bool pimConvertType(PimObjId src, PimObjId dest);
@@ -124,6 +134,14 @@ public:
   // PIM API Fusion
   bool pimFuse(PimProg prog);
 
+  // Asynchronous streams
+  PimStreamId pimStreamCreate();
+  bool pimStreamDestroy(PimStreamId stream);
+  bool pimSetStream(PimStreamId stream);
+  bool pimStreamSync(PimStreamId stream);
+  PimEventId pimEventRecord(PimStreamId stream);
+  bool pimEventWait(PimEventId event);
+
 private:
   pimSim();
   ~pimSim();
@@ -132,6 +150,28 @@ private:
   bool createDeviceCommon();
   void uninit();
 
+  //! @brief  Record an API call if tracing
+  void trace(pimTraceOp op, const std::vector<uint64_t>& args = {}) const {
+    if (m_traceWriter) { m_traceWriter->record(op, args); }
+  }
+  //! @brief  Convert API arguments to trace arguments
+  template <typename... Args> static std::vector<uint64_t> traceArgs(Args... args) {
+    return { static_cast<uint64_t>(args)... };
+  }
+  //! @brief  Record a PIM command with its operand ids, scalars and ranges
+  template <typename... Args> void traceCmd(PimCmdEnum cmdType, Args... args) const {
+    if (m_traceWriter) { m_traceWriter->record(pimTraceOp::CMD, traceArgs(cmdType, args...)); }
+  }
+  //! @brief  Record a batch of host-device copies
+  void traceCopyBatch(PimCmdEnum cmdType, const PimCopyDesc* descs, uint64_t numDescs) const {
+    if (!m_traceWriter) { return; }
+    std::vector<uint64_t> args = traceArgs(cmdType, numDescs);
+    for (uint64_t i = 0; descs && i < numDescs; ++i) {
+      args.insert(args.end(), { static_cast<uint64_t>(descs[i].obj), descs[i].idxBegin, descs[i].idxEnd });
+    }
+    m_traceWriter->record(pimTraceOp::COPY_BATCH, args);
+  }
+
   static pimSim* s_instance;
   pimSimConfig m_config;
 
@@ -140,6 +180,8 @@ private:
   std::unique_ptr<pimParamsDram> m_paramsDram;
   std::unique_ptr<pimStatsMgr> m_statsMgr;
   std::unique_ptr<pimUtils::threadPool> m_threadPool;
+  std::unique_ptr<pimTraceWriter> m_traceWriter;
+  std::recursive_mutex m_execMutex;  // serialize command execution of host thread and stream executor
 
 };
 
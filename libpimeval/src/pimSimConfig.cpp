@@ -43,6 +43,13 @@ pimSimConfig::show() const
 
   std::printf("PIM-Config: Number of Threads = %u\n", m_numThreads);
   std::printf("PIM-Config: Load Balanced = %s\n", m_loadBalanced ? "1" : "0");
+  std::printf("PIM-Config: SIMD ISA = %s\n", pimUtils::pimSimdIsaToStr(m_simdIsa).c_str());
+  std::printf("PIM-Config: Task Chunk Size = %uKB\n", m_taskChunkSizeKB);
+  std::printf("PIM-Config: Memory Pool = %uMB, Huge Pages = %s\n", m_memPoolSizeMB,
+              pimUtils::pimHugePageModeToStr(m_hugePageMode).c_str());
+  if (!m_traceFile.empty()) {
+    std::printf("PIM-Config: Trace File = %s\n", m_traceFile.c_str());
+  }
   std::printf("----------------------------------------\n");
 }
 
@@ -76,6 +83,7 @@ pimSimConfig::deriveConfig(PimDeviceEnum deviceType,
   ok = ok & deriveNumThreads();
   ok = ok & deriveMiscEnvVars();
   ok = ok & deriveLoadBalance();
+  ok = ok & deriveTaskChunkSize();
 
   // Show summary
   show();
@@ -406,6 +414,54 @@ pimSimConfig::deriveMiscEnvVars()
     std::printf("PIM-Warning: Running analysis only mode. Ignoring computation for fast performance and energy analysis.\n");
   }
 
+  // SIMD ISA: use the highest level supported by host CPU unless capped by env var
+  m_simdIsa = pimUtils::detectSimdIsa();
+  valStr = pimUtils::getOptionalParam(m_envParams, m_envVarSimdIsa, hasVal);
+  if (hasVal) {
+    if (valStr != "scalar" && valStr != "avx2" && valStr != "avx512") {
+      std::printf("PIM-Error: Incorrect environment variable: %s=%s\n", m_envVarSimdIsa.c_str(), valStr.c_str());
+      return false;
+    }
+    m_simdIsa = std::min(m_simdIsa, pimUtils::strToPimSimdIsa(valStr));
+  }
+
+  // Benchmark Mode
+  m_benchmarkMode = false;  // off by default
+  valStr = pimUtils::getOptionalParam(m_envParams, m_envVarBenchmarkMode, hasVal);
+  if (hasVal) {
+    if (valStr != "0" && valStr != "1") {
+      std::printf("PIM-Error: Incorrect environment variable: %s=%s\n", m_envVarBenchmarkMode.c_str(), valStr.c_str());
+      return false;
+    }
+    m_benchmarkMode = (valStr == "1");
+  }
+
+  // API Trace File
+  m_traceFile = pimUtils::getOptionalParam(m_envParams, m_envVarTraceFile, hasVal);
+
+  // Memory Pool Size
+  m_memPoolSizeMB = DEFAULT_MEM_POOL_SIZE_MB;
+  valStr = pimUtils::getOptionalParam(m_envParams, m_envVarMemPoolSize, hasVal);
+  if (hasVal) {
+    unsigned val = 0;
+    if (!pimUtils::convertStringToUnsigned(valStr, val)) {
+      std::printf("PIM-Error: Incorrect environment variable: %s=%s\n", m_envVarMemPoolSize.c_str(), valStr.c_str());
+      return false;
+    }
+    m_memPoolSizeMB = val;
+  }
+
+  // Huge Pages
+  m_hugePageMode = DEFAULT_HUGE_PAGE_MODE;
+  valStr = pimUtils::getOptionalParam(m_envParams, m_envVarHugePages, hasVal);
+  if (hasVal) {
+    if (valStr != "none" && valStr != "thp" && valStr != "hugetlb") {
+      std::printf("PIM-Error: Incorrect environment variable: %s=%s\n", m_envVarHugePages.c_str(), valStr.c_str());
+      return false;
+    }
+    m_hugePageMode = pimUtils::strToPimHugePageMode(valStr);
+  }
+
   return true;
 }
 
@@ -436,3 +492,39 @@ pimSimConfig::deriveLoadBalance()
   }
   return true;
 }
+
+//! @brief  Derive Params: Target data size of a parallel task in functional simulation
+bool
+pimSimConfig::deriveTaskChunkSize()
+{
+  m_taskChunkSizeKB = DEFAULT_TASK_CHUNK_SIZE_KB;
+
+  // Check config file then env variable. Zero will be ignored
+  bool hasVal = false;
+  std::string valStr = pimUtils::getOptionalParam(m_cfgParams, m_cfgVarTaskChunkSize, hasVal);
+  if (hasVal) {
+    unsigned val = 0;
+    bool ok = pimUtils::convertStringToUnsigned(valStr, val);
+    if (!ok) {
+      std::printf("PIM-Error: Incorrect config file parameter: %s=%s\n", m_cfgVarTaskChunkSize.c_str(), valStr.c_str());
+      return false;
+    }
+    if (val > 0) {
+      m_taskChunkSizeKB = val;
+    }
+  } else {
+    valStr = pimUtils::getOptionalParam(m_envParams, m_envVarTaskChunkSize, hasVal);
+    if (hasVal) {
+      unsigned val = 0;
+      bool ok = pimUtils::convertStringToUnsigned(valStr, val);
+      if (!ok) {
+        std::printf("PIM-Error: Incorrect environment variable: %s=%s\n", m_envVarTaskChunkSize.c_str(), valStr.c_str());
+        return false;
+      }
+      if (val > 0) {
+        m_taskChunkSizeKB = val;
+      }
+    }
+  }
+  return true;
+}
@@ -5,6 +5,7 @@
 #define LAVA_PIM_SIM_CONFIG_H
 
 #include "libpimeval.h"
+#include "pimUtils.h"
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -25,6 +26,7 @@
 //!   num_col_per_subarray = <int>               // number of columns per subarray
 //!   max_num_threads = <int>                    // maximum number of threads used by simulation
 //!   should_load_balance = <0|1>                // distribute data evenly among all cores
+//!   task_chunk_size_kb = <int>                 // target data size of a parallel task in functional simulation
 //!
 //! Supported environment variables:
 //!   PIMEVAL_SIM_CONFIG <abs-path/cfg-file>     // PIMeval config file, e.g., abs-path/PIMeval_BitSimdV.cfg
@@ -39,6 +41,12 @@
 //!   PIMEVAL_ANALYSIS_MODE <0|1>                // PIMeval analysis mode
 //!   PIMEVAL_DEBUG <int>                        // PIMeval debug flags (see enum pimDebugFlags)
 //!   PIMEVAL_LOAD_BALANCE <0|1>                 // distribute data evenly among all cores
+//!   PIMEVAL_SIMD_ISA <scalar|avx2|avx512>      // highest SIMD ISA used by functional kernels, capped by host CPU
+//!   PIMEVAL_BENCHMARK_MODE <0|1>               // report host elements/s per functional command
+//!   PIMEVAL_TASK_CHUNK_SIZE_KB <int>           // target data size of a parallel task in functional simulation
+//!   PIMEVAL_TRACE_FILE <path/trace-file>       // record API calls into a binary trace for pimreplay
+//!   PIMEVAL_MEM_POOL_MB <int>                  // max freed host memory of PIM object data kept for reuse, 0 to disable
+//!   PIMEVAL_HUGE_PAGES <none|thp|hugetlb>      // huge page backing of host memory of PIM object data
 //!
 //! Precedence rules (highest to lowest priority):
 //! * Config file: Either from -c command-line argument or from PIMEVAL_SIM_CONFIG
@@ -88,6 +96,12 @@ public:
   bool isAnalysisMode() const { return m_analysisMode; }
   unsigned getDebug() const { return m_debug; }
   bool isLoadBalanced() const { return m_loadBalanced; }
+  PimSimdIsa getSimdIsa() const { return m_simdIsa; }
+  bool isBenchmarkMode() const { return m_benchmarkMode; }
+  uint64_t getTaskChunkSize() const { return static_cast<uint64_t>(m_taskChunkSizeKB) * 1024; }
+  const std::string& getTraceFile() const { return m_traceFile; }
+  uint64_t getMemPoolSize() const { return static_cast<uint64_t>(m_memPoolSizeMB) * 1024 * 1024; }
+  PimHugePageMode getHugePageMode() const { return m_hugePageMode; }
 
   enum pimDebugFlags
   {
@@ -96,6 +110,7 @@ public:
     DEBUG_CMDS        = 0x0004,
     DEBUG_ALLOC       = 0x0008,
     DEBUG_PERF        = 0x0010,
+    DEBUG_PROBES      = 0x0020,
   };
 
 private:
@@ -120,6 +135,7 @@ private:
   bool deriveNumThreads();
   bool deriveMiscEnvVars();
   bool deriveLoadBalance();
+  bool deriveTaskChunkSize();
 
   bool parseConfigFromFile(const std::string& config, unsigned& numRanks, unsigned& numBankPerRank, unsigned& numSubarrayPerBank, unsigned& numRows, unsigned& numCols);
 
@@ -134,6 +150,7 @@ private:
   inline static const std::string m_cfgVarMaxNumThreads = "max_num_threads";
   inline static const std::string m_cfgVarLoadBalance = "should_load_balance";
   inline static const std::string m_cfgVarBufferSize = "buffer_size";
+  inline static const std::string m_cfgVarTaskChunkSize = "task_chunk_size_kb";
 
   // Environment variables
   inline static const std::string m_envVarSimConfig = "PIMEVAL_SIM_CONFIG";
@@ -149,6 +166,12 @@ private:
   inline static const std::string m_envVarAnalysisMode = "PIMEVAL_ANALYSIS_MODE";
   inline static const std::string m_envVarDebug = "PIMEVAL_DEBUG";
   inline static const std::string m_envVarLoadBalance = "PIMEVAL_LOAD_BALANCE";
+  inline static const std::string m_envVarSimdIsa = "PIMEVAL_SIMD_ISA";
+  inline static const std::string m_envVarBenchmarkMode = "PIMEVAL_BENCHMARK_MODE";
+  inline static const std::string m_envVarTaskChunkSize = "PIMEVAL_TASK_CHUNK_SIZE_KB";
+  inline static const std::string m_envVarTraceFile = "PIMEVAL_TRACE_FILE";
+  inline static const std::string m_envVarMemPoolSize = "PIMEVAL_MEM_POOL_MB";
+  inline static const std::string m_envVarHugePages = "PIMEVAL_HUGE_PAGES";
 
   // Add env vars to this list for readEnvVars
   inline static const std::vector<std::string> m_envVarList = {
@@ -165,6 +188,12 @@ private:
     m_envVarDebug,
     m_envVarLoadBalance,
     m_envVarBufferSize,
+    m_envVarSimdIsa,
+    m_envVarBenchmarkMode,
+    m_envVarTaskChunkSize,
+    m_envVarTraceFile,
+    m_envVarMemPoolSize,
+    m_envVarHugePages,
   };
 
   // Default values if not specified during init
@@ -175,6 +204,9 @@ private:
   static constexpr int DEFAULT_NUM_COL_PER_SUBARRAY = 8192;
   static constexpr int DEFAULT_BUFFER_SIZE = 0;
   static constexpr PimDeviceEnum DEFAULT_SIM_TARGET = PIM_DEVICE_AQUABOLT;
+  static constexpr unsigned DEFAULT_TASK_CHUNK_SIZE_KB = 256; // fit per-core L2 share
+  static constexpr unsigned DEFAULT_MEM_POOL_SIZE_MB = 1024;
+  static constexpr PimHugePageMode DEFAULT_HUGE_PAGE_MODE = PimHugePageMode::THP;
 
   //! @brief  Reset all member variables to default status
   inline void reset() {
@@ -193,6 +225,12 @@ private:
     m_analysisMode = false;
     m_debug = 0;
     m_loadBalanced = false;
+    m_simdIsa = PimSimdIsa::SCALAR;
+    m_benchmarkMode = false;
+    m_taskChunkSizeKB = 0;
+    m_traceFile.clear();
+    m_memPoolSizeMB = 0;
+    m_hugePageMode = PimHugePageMode::NONE;
     m_envParams.clear();
     m_cfgParams.clear();
     m_isInit = false;
@@ -214,6 +252,12 @@ private:
   bool m_analysisMode;
   unsigned m_debug;
   bool m_loadBalanced;
+  PimSimdIsa m_simdIsa;
+  bool m_benchmarkMode;
+  unsigned m_taskChunkSizeKB;
+  std::string m_traceFile;
+  unsigned m_memPoolSizeMB;
+  PimHugePageMode m_hugePageMode;
 
   // Store original parameters for extension purpose
   std::unordered_map<std::string, std::string> m_envParams;
@@ -4,16 +4,23 @@
 #include "pimStats.h"
 #include "pimSim.h"
 #include "pimUtils.h"
+#include "pimProbe.h"
 #include <chrono>            // for chrono
 #include <cstdint>           // for uint64_t
 #include <cstdio>            // for printf
 #include <iomanip>           // for setw, fixed, setprecision
+#include <mutex>             // for lock_guard
 
+// Estimated runtime of the current PIM API scope of each thread
+static thread_local double s_curApiMsEstRuntime = 0.0;
+// Whether the thread is running an asynchronous command of a stream
+static thread_local bool s_isAsyncScope = false;
 
 //! @brief  Show PIM stats
 void
 pimStatsMgr::showStats() const
 {
+  std::lock_guard<std::mutex> lock(m_mutex);
   std::printf("----------------------------------------\n");
   if (pimSim::get()->isDebug(pimSimConfig::DEBUG_API_CALLS)) {
     showApiStats();
@@ -21,6 +28,12 @@ pimStatsMgr::showStats() const
   showDeviceParams();
   showCopyStats();
   showCmdStats();
+  if (pimSim::get()->getConfig().isBenchmarkMode()) {
+    showKernelThroughputStats();
+  }
+  if (pimSim::get()->isDebug(pimSimConfig::DEBUG_PROBES)) {
+    pimProbeMgr::showStats();
+  }
   std::printf("----------------------------------------\n");
 }
 
@@ -40,7 +53,14 @@ pimStatsMgr::showApiStats() const
   double msTotalElapsedAlloc = 0.0;
   double msTotalElapsedCopy = 0.0;
   double msTotalElapsedCompute = 0.0;
-  for (const auto& it : m_msElapsed) {
+  // merge by name in alphabetical order
+  std::map<std::string, std::pair<int, double>> msElapsed;
+  for (const auto& [tag, item] : m_msElapsed) {
+    auto& merged = msElapsed[tag];
+    merged.first += item.first;
+    merged.second += item.second;
+  }
+  for (const auto& it : msElapsed) {
     std::printf(" %30s : %10d %14f\n", it.first.c_str(), it.second.first, it.second.second);
     totCalls += it.second.first;
     msTotalElapsed += it.second.second;
@@ -50,7 +70,7 @@ pimStatsMgr::showApiStats() const
     } else if (it.first.find("pimAlloc") == 0 || it.first.find("pimFree") == 0) {
       totCallsAlloc += it.second.first;
       msTotalElapsedAlloc += it.second.second;
-    } else if (it.first.find("pimCopy") == 0) {
+    } else if (it.first.find("pimCopy") == 0 || it.first.find("pimRegisterHostBuffer") == 0) {
       totCallsCopy += it.second.first;
       msTotalElapsedCopy += it.second.second;
     } else {
@@ -123,7 +143,13 @@ pimStatsMgr::showCmdStats() const
   double totalMsWrite = 0.0;
   double totalMsCompute = 0.0;
   uint64_t totalOp = 0;
-  for (const auto& it : m_cmdPerf) {
+  std::map<std::string, std::pair<int, pimeval::perfEnergy>> cmdPerf = m_cmdPerf;
+  for (unsigned id = 0; id < s_numCmdStatsIds; ++id) {
+    if (m_cmdPerfById[id].first > 0) {
+      cmdPerf[getCmdStatsName(id)] = m_cmdPerfById[id];
+    }
+  }
+  for (const auto& it : cmdPerf) {
     double cmdRuntime = it.second.second.m_msRuntime;
     double percentRead = cmdRuntime == 0.0 ? 0.0 : (it.second.second.m_msRead * 100 / cmdRuntime);
     double percentWrite = cmdRuntime == 0.0 ? 0.0 : (it.second.second.m_msWrite * 100 / cmdRuntime);
@@ -140,13 +166,22 @@ pimStatsMgr::showCmdStats() const
     totalOp += it.second.second.m_totalOp;
   }
   std::printf(" %44s : %10d %14f %14f %14f %7.2f %7.2f %7.2f\n", "TOTAL ---------", totalCmd, totalMsRuntime, totalMjEnergy, (totalOp * 1.0 / totalMjEnergy * 1e-6), (totalMsRead / totalCmd), (totalMsWrite / totalCmd), (totalMsCompute / totalCmd) );
+  // hit rate of memoized perf energy model evaluation
+  const pimPerfEnergyBase* model = pimSim::get()->getPerfEnergyModel();
+  if (model && model->isMemoized()) {
+    uint64_t numHits = model->getNumCacheHits();
+    uint64_t numLookups = numHits + model->getNumCacheMisses();
+    double hitRate = numLookups == 0 ? 0.0 : (numHits * 100.0 / numLookups);
+    std::printf(" %44s : %llu hits, %llu lookups, %.2f%% hit rate\n", "Perf Energy Model Cache",
+                (unsigned long long)numHits, (unsigned long long)numLookups, hitRate);
+  }
   // analyze micro-ops
   int numR = 0;
   int numW = 0;
   int numL = 0;
   int numActivate = 0;
   int numPrecharge = 0;
-  for (const auto& it : m_cmdPerf) {
+  for (const auto& it : cmdPerf) {
     if (it.first == "row_r") {
       numR += it.second.first;
       numActivate += it.second.first;
@@ -165,25 +200,108 @@ pimStatsMgr::showCmdStats() const
   }
 }
 
+//! @brief  Show host throughput of functional computation in benchmark mode
+void
+pimStatsMgr::showKernelThroughputStats() const
+{
+  std::printf("Functional Kernel Throughput (SIMD ISA = %s, %u threads):\n",
+              pimUtils::pimSimdIsaToStr(pimSim::get()->getConfig().getSimdIsa()).c_str(), pimSim::get()->getNumThreads());
+  std::printf(" %44s : %14s %14s %14s\n", "PIM-CMD", "Elements", "Elapsed(ms)", "MElements/s");
+  std::map<std::string, std::pair<uint64_t, double>> kernelThroughput = m_kernelThroughput;
+  for (unsigned id = 0; id < s_numCmdStatsIds; ++id) {
+    if (m_kernelThroughputById[id].first > 0) {
+      kernelThroughput[getCmdStatsName(id)] = m_kernelThroughputById[id];
+    }
+  }
+  for (const auto& it : kernelThroughput) {
+    double msElapsed = it.second.second;
+    double melemPerSec = msElapsed == 0.0 ? 0.0 : (it.second.first / msElapsed * 1e-3);
+    std::printf(" %44s : %14llu %14f %14f\n", it.first.c_str(), (unsigned long long)it.second.first, msElapsed, melemPerSec);
+  }
+}
+
+//! @brief  Get performance and energy summed over all recorded PIM commands
+pimeval::perfEnergy
+pimStatsMgr::getTotalCmdPerfEnergy() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  pimeval::perfEnergy total;
+  auto add = [&total](const pimeval::perfEnergy& pe) {
+    total.m_msRuntime += pe.m_msRuntime;
+    total.m_mjEnergy += pe.m_mjEnergy;
+    total.m_msRead += pe.m_msRead;
+    total.m_msWrite += pe.m_msWrite;
+    total.m_msCompute += pe.m_msCompute;
+    total.m_totalOp += pe.m_totalOp;
+  };
+  for (const auto& it : m_cmdPerf) {
+    add(it.second.second);
+  }
+  for (const auto& item : m_cmdPerfById) {
+    add(item.second);
+  }
+  return total;
+}
+
 //! @brief  Reset PIM stats
 void
 pimStatsMgr::resetStats()
 {
+  std::lock_guard<std::mutex> lock(m_mutex);
   m_cmdPerf.clear();
+  m_cmdPerfById.assign(s_numCmdStatsIds, {});
   m_msElapsed.clear();
+  m_kernelThroughput.clear();
+  m_kernelThroughputById.assign(s_numCmdStatsIds, {});
+  pimProbeMgr::resetStats();
   m_bitsCopiedMainToDevice = 0;
   m_bitsCopiedDeviceToMain = 0;
   m_bitsCopiedDeviceToDevice = 0;
+  pimPerfEnergyBase* model = pimSim::get()->getPerfEnergyModel();
+  if (model) {
+    model->resetCacheStats();
+  }
+}
+
+//! @brief  Get command name of a compact stats ID
+std::string
+pimStatsMgr::getCmdStatsName(unsigned id)
+{
+  bool isVLayout = (id % 2 == 1);
+  PimDataType dataType = static_cast<PimDataType>((id / 2) % s_numDataTypes);
+  PimCmdEnum cmdType = static_cast<PimCmdEnum>(id / 2 / s_numDataTypes);
+  std::string suffix = "." + pimUtils::pimDataTypeEnumToStr(dataType);
+  suffix += isVLayout ? ".v" : ".h";
+  return pimCmd::getName(cmdType, suffix);
+}
+
+//! @brief  Record estimated runtime and energy of a PIM command, without building its name
+void
+pimStatsMgr::recordCmd(PimCmdEnum cmdType, PimDataType dataType, bool isVLayout, pimeval::perfEnergy mPerfEnergy)
+{
+  PIM_PROBE_SCOPE("stats");
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto& item = m_cmdPerfById[getCmdStatsId(cmdType, dataType, isVLayout)];
+  item.first++;
+  item.second.m_msRuntime += mPerfEnergy.m_msRuntime;
+  s_curApiMsEstRuntime += mPerfEnergy.m_msRuntime;
+  item.second.m_mjEnergy += mPerfEnergy.m_mjEnergy;
+  item.second.m_msRead += mPerfEnergy.m_msRead;
+  item.second.m_msWrite += mPerfEnergy.m_msWrite;
+  item.second.m_msCompute += mPerfEnergy.m_msCompute;
+  item.second.m_totalOp += mPerfEnergy.m_totalOp;
 }
 
-//! @brief  Record estimated runtime and energy of a PIM command
+//! @brief  Record estimated runtime and energy of a PIM command with a composed name
 void
 pimStatsMgr::recordCmd(const std::string& cmdName, pimeval::perfEnergy mPerfEnergy)
 {
+  PIM_PROBE_SCOPE("stats");
+  std::lock_guard<std::mutex> lock(m_mutex);
   auto& item = m_cmdPerf[cmdName];
   item.first++;
   item.second.m_msRuntime += mPerfEnergy.m_msRuntime;
-  m_curApiMsEstRuntime += mPerfEnergy.m_msRuntime;
+  s_curApiMsEstRuntime += mPerfEnergy.m_msRuntime;
   item.second.m_mjEnergy += mPerfEnergy.m_mjEnergy;
   item.second.m_msRead += mPerfEnergy.m_msRead;
   item.second.m_msWrite += mPerfEnergy.m_msWrite;
@@ -191,13 +309,37 @@ pimStatsMgr::recordCmd(const std::string& cmdName, pimeval::perfEnergy mPerfEner
   item.second.m_totalOp += mPerfEnergy.m_totalOp;
 }
 
+//! @brief  Record host elapsed time of functional computation in benchmark mode
+void
+pimStatsMgr::recordKernelThroughput(PimCmdEnum cmdType, PimDataType dataType, bool isVLayout, uint64_t numElements, double msElapsed)
+{
+  PIM_PROBE_SCOPE("stats");
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto& item = m_kernelThroughputById[getCmdStatsId(cmdType, dataType, isVLayout)];
+  item.first += numElements;
+  item.second += msElapsed;
+}
+
+//! @brief  Record host elapsed time of functional computation with a composed command name
+void
+pimStatsMgr::recordKernelThroughput(const std::string& cmdName, uint64_t numElements, double msElapsed)
+{
+  PIM_PROBE_SCOPE("stats");
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto& item = m_kernelThroughput[cmdName];
+  item.first += numElements;
+  item.second += msElapsed;
+}
+
 //! @brief  Record estimated runtime and energy of data copy
 void
 pimStatsMgr::recordCopyMainToDevice(uint64_t numBits, pimeval::perfEnergy mPerfEnergy)
 {
+  PIM_PROBE_SCOPE("stats");
+  std::lock_guard<std::mutex> lock(m_mutex);
   m_bitsCopiedMainToDevice += numBits;
   m_elapsedTimeCopiedMainToDevice += mPerfEnergy.m_msRuntime;
-  m_curApiMsEstRuntime += mPerfEnergy.m_msRuntime;
+  s_curApiMsEstRuntime += mPerfEnergy.m_msRuntime;
   m_mJCopiedMainToDevice += mPerfEnergy.m_mjEnergy;
 }
 
@@ -205,9 +347,11 @@ pimStatsMgr::recordCopyMainToDevice(uint64_t numBits, pimeval::perfEnergy mPerfE
 void
 pimStatsMgr::recordCopyDeviceToMain(uint64_t numBits, pimeval::perfEnergy mPerfEnergy)
 {
+  PIM_PROBE_SCOPE("stats");
+  std::lock_guard<std::mutex> lock(m_mutex);
   m_bitsCopiedDeviceToMain += numBits;
   m_elapsedTimeCopiedDeviceToMain += mPerfEnergy.m_msRuntime;
-  m_curApiMsEstRuntime += mPerfEnergy.m_msRuntime;
+  s_curApiMsEstRuntime += mPerfEnergy.m_msRuntime;
   m_mJCopiedDeviceToMain += mPerfEnergy.m_mjEnergy;
 }
 
@@ -215,9 +359,11 @@ pimStatsMgr::recordCopyDeviceToMain(uint64_t numBits, pimeval::perfEnergy mPerfE
 void
 pimStatsMgr::recordCopyDeviceToDevice(uint64_t numBits, pimeval::perfEnergy mPerfEnergy)
 {
+  PIM_PROBE_SCOPE("stats");
+  std::lock_guard<std::mutex> lock(m_mutex);
   m_bitsCopiedDeviceToDevice += numBits;
   m_elapsedTimeCopiedDeviceToDevice += mPerfEnergy.m_msRuntime;
-  m_curApiMsEstRuntime += mPerfEnergy.m_msRuntime;
+  s_curApiMsEstRuntime += mPerfEnergy.m_msRuntime;
   m_mJCopiedDeviceToDevice += mPerfEnergy.m_mjEnergy;
 }
 
@@ -225,23 +371,55 @@ pimStatsMgr::recordCopyDeviceToDevice(uint64_t numBits, pimeval::perfEnergy mPer
 void
 pimStatsMgr::pimApiScopeStart()
 {
+  // APIs called by an asynchronous command, e.g., APIs of a fused program, belong to the command
+  if (s_isAsyncScope) {
+    return;
+  }
   // Restart for current PIM API call
-  m_curApiMsEstRuntime = 0.0;
+  s_curApiMsEstRuntime = 0.0;
 }
 
 //! @brief  Postprocessing at the end of a PIM API scope
 void
-pimStatsMgr::pimApiScopeEnd(const std::string& tag, double elapsed)
+pimStatsMgr::pimApiScopeEnd(const char* tag, double elapsed)
 {
+  std::lock_guard<std::mutex> lock(m_mutex);
   // Record API stats
   auto& item = m_msElapsed[tag];
   item.first++;
   item.second += elapsed;
 
   // Update kernel stats
-  if (m_isKernelTimerOn) {
+  if (m_isKernelTimerOn && !s_isAsyncScope) {
     m_kernelMsElapsedSim += elapsed;
-    m_kernelMsEstRuntime += m_curApiMsEstRuntime;
+    m_kernelMsEstRuntime += s_curApiMsEstRuntime;
+  }
+}
+
+//! @brief  Start the scope of an asynchronous command on a stream executor thread
+void
+pimStatsMgr::asyncScopeStart()
+{
+  s_isAsyncScope = true;
+  s_curApiMsEstRuntime = 0.0;
+}
+
+//! @brief  End the scope of an asynchronous command. Return its estimated runtime
+double
+pimStatsMgr::asyncScopeEnd()
+{
+  s_isAsyncScope = false;
+  return s_curApiMsEstRuntime;
+}
+
+//! @brief  Record estimated runtime that asynchronous commands add to the kernel
+//!         Host time of asynchronous commands is not counted, as it overlaps with the host thread
+void
+pimStatsMgr::recordAsyncRuntime(double msRuntime)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (m_isKernelTimerOn) {
+    m_kernelMsEstRuntime += msRuntime;
   }
 }
 
@@ -249,6 +427,7 @@ pimStatsMgr::pimApiScopeEnd(const std::string& tag, double elapsed)
 void
 pimStatsMgr::startKernelTimer()
 {
+  std::lock_guard<std::mutex> lock(m_mutex);
   if (m_isKernelTimerOn) {
     std::printf("PIM-Warning: Kernel timer has already started\n");
     return;
@@ -262,6 +441,7 @@ pimStatsMgr::startKernelTimer()
 void
 pimStatsMgr::endKernelTimer()
 {
+  std::lock_guard<std::mutex> lock(m_mutex);
   if (!m_isKernelTimerOn) {
     std::printf("PIM-Warning: Kernel timer has not started\n");
     return;
@@ -276,10 +456,10 @@ pimStatsMgr::endKernelTimer()
 }
 
 //! @brief pimPerfMon ctor
-pimPerfMon::pimPerfMon(const std::string& tag)
+pimPerfMon::pimPerfMon(const char* tag)
+  : m_tag(tag)
 {
   m_startTime = std::chrono::high_resolution_clock::now();
-  m_tag = tag;
   // assumption: pimPerfMon is not nested
   if (pimSim::get()->getStatsMgr()) {
     pimSim::get()->getStatsMgr()->pimApiScopeStart();
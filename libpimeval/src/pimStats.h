@@ -10,19 +10,22 @@
 #include <cstdint>
 #include <string>
 #include <map>
+#include <vector>
+#include <unordered_map>
 #include <chrono>
+#include <mutex>
 
 //! @class  pimPerfMon
 //! @brief  PIM performance monitor
 class pimPerfMon
 {
 public:
-  pimPerfMon(const std::string& tag);
+  pimPerfMon(const char* tag);
   ~pimPerfMon();
 
 private:
   std::chrono::time_point<std::chrono::high_resolution_clock> m_startTime;
-  std::string m_tag;
+  const char* m_tag;  // API name with static storage
 };
 
 
@@ -31,7 +34,9 @@ private:
 class pimStatsMgr
 {
 public:
-  pimStatsMgr() {}
+  pimStatsMgr()
+    : m_cmdPerfById(s_numCmdStatsIds),
+      m_kernelThroughputById(s_numCmdStatsIds) {}
   ~pimStatsMgr() {}
 
   void startKernelTimer();
@@ -39,24 +44,47 @@ public:
 
   void showStats() const;
   void resetStats();
+  pimeval::perfEnergy getTotalCmdPerfEnergy() const;
 
+  // Scope of a command run by a stream executor thread
+  void asyncScopeStart();
+  double asyncScopeEnd();
+  void recordAsyncRuntime(double msRuntime);
+
+  void recordCmd(PimCmdEnum cmdType, PimDataType dataType, bool isVLayout, pimeval::perfEnergy mPerfEnergy);
   void recordCmd(const std::string& cmdName, pimeval::perfEnergy mPerfEnergy);
   void recordCopyMainToDevice(uint64_t numBits, pimeval::perfEnergy mPerfEnergy);
   void recordCopyDeviceToMain(uint64_t numBits, pimeval::perfEnergy mPerfEnergy);
   void recordCopyDeviceToDevice(uint64_t numBits, pimeval::perfEnergy mPerfEnergy);
+  void recordKernelThroughput(PimCmdEnum cmdType, PimDataType dataType, bool isVLayout, uint64_t numElements, double msElapsed);
+  void recordKernelThroughput(const std::string& cmdName, uint64_t numElements, double msElapsed);
 
 private:
   friend class pimPerfMon;
   void pimApiScopeStart();
-  void pimApiScopeEnd(const std::string& tag, double elapsed);
+  void pimApiScopeEnd(const char* tag, double elapsed);
+
+  // Stats of regular commands are indexed by a compact ID of (command type, data type, layout),
+  // and command names are only built when showing stats
+  static constexpr unsigned s_numCmdTypes = static_cast<unsigned>(PimCmdEnum::CMD_ENUM_MAX);
+  static constexpr unsigned s_numDataTypes = static_cast<unsigned>(PIM_DATA_TYPE_MAX);
+  static constexpr unsigned s_numCmdStatsIds = s_numCmdTypes * s_numDataTypes * 2;
+  static unsigned getCmdStatsId(PimCmdEnum cmdType, PimDataType dataType, bool isVLayout) {
+    return (static_cast<unsigned>(cmdType) * s_numDataTypes + static_cast<unsigned>(dataType)) * 2 + (isVLayout ? 1 : 0);
+  }
+  static std::string getCmdStatsName(unsigned id);
 
   void showApiStats() const;
   void showDeviceParams() const;
   void showCopyStats() const;
   void showCmdStats() const;
+  void showKernelThroughputStats() const;
 
-  std::map<std::string, std::pair<int, pimeval::perfEnergy>> m_cmdPerf;
-  std::map<std::string, std::pair<int, double>> m_msElapsed;
+  std::map<std::string, std::pair<int, pimeval::perfEnergy>> m_cmdPerf;  // commands with composed names, e.g., fused
+  std::vector<std::pair<int, pimeval::perfEnergy>> m_cmdPerfById;
+  std::unordered_map<const char*, std::pair<int, double>> m_msElapsed;  // keyed by API name pointer
+  std::map<std::string, std::pair<uint64_t, double>> m_kernelThroughput;  // elements and host ms in benchmark mode
+  std::vector<std::pair<uint64_t, double>> m_kernelThroughputById;
 
   uint64_t m_bitsCopiedMainToDevice = 0;
   uint64_t m_bitsCopiedDeviceToMain = 0;
@@ -69,10 +97,10 @@ private:
   double m_mJCopiedDeviceToDevice = 0.0;
 
   bool m_isKernelTimerOn = false;
-  double m_curApiMsEstRuntime = 0.0;
   double m_kernelMsElapsedSim = 0.0;
   double m_kernelMsEstRuntime = 0.0;
   std::chrono::time_point<std::chrono::high_resolution_clock> m_kernelStart{};
+  mutable std::mutex m_mutex;  // stats are updated by host threads and stream executor
 };
 
 #endif
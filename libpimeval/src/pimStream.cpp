@@ -0,0 +1,385 @@
+// File: pimStream.cpp
+// PIMeval Simulator - Asynchronous Command Streams
+
+#include "pimStream.h"
+#include "pimSim.h"          // for pimSim
+#include "pimStats.h"        // for pimStatsMgr
+#include "pimDevice.h"       // for pimDevice
+#include "pimProbe.h"        // for PIM_PROBE_SCOPE_ID
+#include <algorithm>         // for find, max
+#include <cstdio>            // for printf
+#include <cstdint>           // for UINT64_MAX
+
+// Current stream of each host thread, -1 for synchronous execution. A stream set for a previous
+// stream manager, e.g., of a deleted device, is identified by its generation and ignored
+struct currentStream
+{
+  uint64_t m_generation = 0;
+  PimStreamId m_stream = -1;
+};
+static thread_local currentStream s_currentStream;
+static std::atomic<uint64_t> s_nextGeneration(1);
+
+//! @brief  pimStreamMgr ctor
+pimStreamMgr::pimStreamMgr(pimDevice* device)
+  : m_device(device),
+    m_generation(s_nextGeneration.fetch_add(1))
+{
+}
+
+//! @brief  pimStreamMgr dtor. Pending commands are drained before the executor exits
+pimStreamMgr::~pimStreamMgr()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_terminate = true;
+  }
+  m_taskCond.notify_all();
+  if (m_executor.joinable()) {
+    m_executor.join();
+  }
+}
+
+//! @brief  Create a stream. The executor thread is started with the first stream
+PimStreamId
+pimStreamMgr::createStream()
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (!m_executor.joinable()) {
+    m_executor = std::thread(&pimStreamMgr::executorThread, this);
+  }
+  PimStreamId stream = m_nextStreamId++;
+  m_streams[stream] = streamInfo();
+  return stream;
+}
+
+//! @brief  Destroy a stream after its pending commands complete
+bool
+pimStreamMgr::destroyStream(PimStreamId stream)
+{
+  bool ok = syncStream(stream);
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (m_streams.erase(stream) == 0) {
+    return false;
+  }
+  eraseEvents(stream, UINT64_MAX);
+  return ok;
+}
+
+//! @brief  Set current stream of the calling host thread. Use -1 for synchronous execution
+bool
+pimStreamMgr::setCurrentStream(PimStreamId stream)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (stream != -1 && m_streams.find(stream) == m_streams.end()) {
+    std::printf("PIM-Error: Invalid PIM stream ID %d\n", stream);
+    return false;
+  }
+  s_currentStream.m_generation = m_generation;
+  s_currentStream.m_stream = stream;
+  return true;
+}
+
+//! @brief  Get current stream of the calling host thread, or -1 if commands run synchronously
+//!         A stream set for another stream manager, or destroyed by any thread, is not current
+PimStreamId
+pimStreamMgr::getCurrentStream() const
+{
+  // commands issued by the executor, e.g., APIs of a fused program, run synchronously
+  if (isExecutorThread() || s_currentStream.m_stream == -1 || s_currentStream.m_generation != m_generation) {
+    return -1;
+  }
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (m_streams.find(s_currentStream.m_stream) == m_streams.end()) {
+    return -1;
+  }
+  return s_currentStream.m_stream;
+}
+
+//! @brief  Wait for all commands enqueued to a stream. Report and clear errors of the stream
+bool
+pimStreamMgr::syncStream(PimStreamId stream)
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+  auto it = m_streams.find(stream);
+  if (it == m_streams.end()) {
+    std::printf("PIM-Error: Invalid PIM stream ID %d\n", stream);
+    return false;
+  }
+  waitUntil(lock, it->second.m_lastSeq);
+  it = m_streams.find(stream);
+  if (it == m_streams.end()) {
+    return true;
+  }
+  bool ok = !it->second.m_hasError;
+  it->second.m_hasError = false;
+  // errors up to here are reported by this sync, so waiting for events of the stream is no longer needed
+  eraseEvents(stream, it->second.m_lastSeq);
+  return ok;
+}
+
+//! @brief  Wait for all enqueued commands
+void
+pimStreamMgr::syncAll()
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+  waitUntil(lock, m_nextSeq - 1);
+}
+
+//! @brief  Record an event at the current end of a stream
+PimEventId
+pimStreamMgr::recordEvent(PimStreamId stream)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto it = m_streams.find(stream);
+  if (it == m_streams.end()) {
+    std::printf("PIM-Error: Invalid PIM stream ID %d\n", stream);
+    return -1;
+  }
+  PimEventId event = m_nextEventId++;
+  m_events[event] = std::make_pair(stream, it->second.m_lastSeq);
+  return event;
+}
+
+//! @brief  Wait for commands enqueued to the stream of an event before the event was recorded
+//!         Events are forgotten once their stream is synced or destroyed, and they have completed by then
+bool
+pimStreamMgr::waitEvent(PimEventId event)
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+  if (event < 0 || event >= m_nextEventId) {
+    std::printf("PIM-Error: Invalid PIM event ID %d\n", event);
+    return false;
+  }
+  auto eventIt = m_events.find(event);
+  if (eventIt == m_events.end()) {
+    return true;
+  }
+  PimStreamId stream = eventIt->second.first;
+  waitUntil(lock, eventIt->second.second);
+  auto it = m_streams.find(stream);
+  return it == m_streams.end() || !it->second.m_hasError;
+}
+
+//! @brief  Forget events of a stream recorded up to a sequence number. Caller holds m_mutex
+void
+pimStreamMgr::eraseEvents(PimStreamId stream, uint64_t seq)
+{
+  for (auto it = m_events.begin(); it != m_events.end();) {
+    if (it->second.first == stream && it->second.second <= seq) {
+      it = m_events.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+//! @brief  Enqueue a command to a stream
+bool
+pimStreamMgr::enqueue(PimStreamId stream, std::unique_ptr<pimCmd> cmd)
+{
+  std::vector<PimObjId> readIds;
+  std::vector<PimObjId> writeIds;
+  // probe the command under the API that enqueued it when it runs
+  static const unsigned s_streamExecProbeId = pimProbeMgr::registerProbe("streamExec");
+  unsigned probeId = pimProbeMgr::getRootProbeId();
+  if (probeId == pimProbeMgr::s_invalidProbeId) {
+    probeId = s_streamExecProbeId;
+  }
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto it = m_streams.find(stream);
+  if (it == m_streams.end()) {
+    std::printf("PIM-Error: Invalid PIM stream ID %d\n", stream);
+    return false;
+  }
+  bool isBarrier = !getRootAccess(*cmd, readIds, writeIds);
+  uint64_t seq = m_nextSeq++;
+  it->second.m_lastSeq = seq;
+  m_tasks.push_back({ seq, stream, std::move(cmd), isBarrier, std::move(readIds), std::move(writeIds), probeId });
+  m_taskCond.notify_one();
+  return true;
+}
+
+//! @brief  Wait for pending commands that conflict with a command to be executed synchronously
+void
+pimStreamMgr::waitForCmd(const pimCmd& cmd)
+{
+  if (isExecutorThread()) {
+    return;
+  }
+  std::vector<PimObjId> readIds;
+  std::vector<PimObjId> writeIds;
+  std::unique_lock<std::mutex> lock(m_mutex);
+  if (m_tasks.empty()) {
+    return;
+  }
+  bool isBarrier = !getRootAccess(cmd, readIds, writeIds);
+  uint64_t seq = 0;
+  for (const auto& task : m_tasks) {
+    if (isBarrier || task.m_isBarrier || hasConflict(task.m_readIds, task.m_writeIds, readIds, writeIds)) {
+      seq = task.m_seq;
+    }
+  }
+  waitUntil(lock, seq);
+}
+
+//! @brief  Wait for pending commands that access an object, e.g., before deleting it
+void
+pimStreamMgr::waitForObj(PimObjId objId)
+{
+  if (isExecutorThread()) {
+    return;
+  }
+  std::unique_lock<std::mutex> lock(m_mutex);
+  auto it = m_rootIds.find(objId);
+  std::vector<PimObjId> writeIds = { it == m_rootIds.end() ? objId : it->second };
+  uint64_t seq = 0;
+  for (const auto& task : m_tasks) {
+    if (task.m_isBarrier || hasConflict(task.m_readIds, task.m_writeIds, {}, writeIds)) {
+      seq = task.m_seq;
+    }
+  }
+  waitUntil(lock, seq);
+}
+
+//! @brief  Track an object reference, so that it is treated as its root object in dependency checks
+void
+pimStreamMgr::addRef(PimObjId refId, PimObjId rootId)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto it = m_rootIds.find(rootId);
+  m_rootIds[refId] = (it == m_rootIds.end() ? rootId : it->second);
+}
+
+//! @brief  Stop tracking a deleted object
+void
+pimStreamMgr::removeObj(PimObjId objId)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_rootIds.erase(objId);
+  m_msObjReady.erase(objId);
+}
+
+//! @brief  Get object access sets of a command with references mapped to root objects
+//!         Return false if the command does not report its object access sets
+bool
+pimStreamMgr::getRootAccess(const pimCmd& cmd, std::vector<PimObjId>& readIds, std::vector<PimObjId>& writeIds) const
+{
+  if (!cmd.getObjAccess(readIds, writeIds)) {
+    return false;
+  }
+  for (auto* ids : { &readIds, &writeIds }) {
+    for (PimObjId& objId : *ids) {
+      auto it = m_rootIds.find(objId);
+      if (it != m_rootIds.end()) {
+        objId = it->second;
+      }
+    }
+  }
+  return true;
+}
+
+//! @brief  Check read-after-write, write-after-read and write-after-write conflicts
+bool
+pimStreamMgr::hasConflict(const std::vector<PimObjId>& readIds1, const std::vector<PimObjId>& writeIds1,
+                          const std::vector<PimObjId>& readIds2, const std::vector<PimObjId>& writeIds2)
+{
+  auto intersects = [](const std::vector<PimObjId>& ids1, const std::vector<PimObjId>& ids2) {
+    for (PimObjId objId : ids1) {
+      if (std::find(ids2.begin(), ids2.end(), objId) != ids2.end()) {
+        return true;
+      }
+    }
+    return false;
+  };
+  return intersects(writeIds1, readIds2) || intersects(writeIds1, writeIds2) || intersects(readIds1, writeIds2);
+}
+
+//! @brief  Wait until all tasks up to a sequence number complete
+void
+pimStreamMgr::waitUntil(std::unique_lock<std::mutex>& lock, uint64_t seq)
+{
+  m_doneCond.wait(lock, [this, seq]() { return m_completedSeq >= seq; });
+}
+
+//! @brief  Place a completed task on the modeled timeline. Return the runtime it adds to the timeline
+double
+pimStreamMgr::scheduleModeled(const streamTask& task, double msRuntime)
+{
+  PimCmdEnum cmdType = task.m_cmd->getCmdType();
+  bool isCopy = (cmdType == PimCmdEnum::COPY_H2D || cmdType == PimCmdEnum::COPY_D2H);
+  bool isOverlapped = m_device->getPerfEnergyModel()->isCopyComputeOverlapSupported();
+  double& msEngineFree = (isCopy && isOverlapped) ? m_msCopyEngineFree : m_msComputeEngineFree;
+
+  double msStart = msEngineFree;
+  if (task.m_isBarrier) {
+    msStart = std::max({ msStart, m_msCopyEngineFree, m_msComputeEngineFree });
+  } else {
+    for (auto* ids : { &task.m_readIds, &task.m_writeIds }) {
+      for (PimObjId objId : *ids) {
+        auto it = m_msObjReady.find(objId);
+        if (it != m_msObjReady.end()) {
+          msStart = std::max(msStart, it->second);
+        }
+      }
+    }
+  }
+  double msEnd = msStart + msRuntime;
+  msEngineFree = msEnd;
+  if (task.m_isBarrier) {
+    m_msCopyEngineFree = m_msComputeEngineFree = msEnd;
+  } else {
+    for (auto* ids : { &task.m_readIds, &task.m_writeIds }) {
+      for (PimObjId objId : *ids) {
+        m_msObjReady[objId] = msEnd;
+      }
+    }
+  }
+  double msAdded = std::max(0.0, msEnd - m_msModeledEnd);
+  m_msModeledEnd = std::max(m_msModeledEnd, msEnd);
+  return msAdded;
+}
+
+//! @brief  Stream executor thread: run enqueued commands in order
+void
+pimStreamMgr::executorThread()
+{
+  m_executorId.store(std::this_thread::get_id(), std::memory_order_release);
+  pimStatsMgr* statsMgr = pimSim::get()->getStatsMgr();
+  while (true) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_taskCond.wait(lock, [this]() { return m_terminate || !m_tasks.empty(); });
+    if (m_tasks.empty()) {
+      break;
+    }
+    // the task stays in queue while running, so that it is visible to dependency checks
+    pimCmd* cmd = m_tasks.front().m_cmd.get();
+    PimStreamId stream = m_tasks.front().m_stream;
+    uint64_t seq = m_tasks.front().m_seq;
+    unsigned probeId = m_tasks.front().m_probeId;
+    lock.unlock();
+
+    bool ok = false;
+    double msRuntime = 0.0;
+    {
+      PIM_PROBE_SCOPE_ID(probeId);
+      std::lock_guard<std::recursive_mutex> execLock(pimSim::get()->getExecMutex());
+      statsMgr->asyncScopeStart();
+      ok = cmd->execute();
+      msRuntime = statsMgr->asyncScopeEnd();
+    }
+
+    lock.lock();
+    statsMgr->recordAsyncRuntime(scheduleModeled(m_tasks.front(), msRuntime));
+    if (!ok) {
+      std::printf("PIM-Error: Asynchronous PIM command %s failed in stream %d\n", cmd->getName().c_str(), stream);
+      auto it = m_streams.find(stream);
+      if (it != m_streams.end()) {
+        it->second.m_hasError = true;
+      }
+    }
+    m_tasks.pop_front();
+    m_completedSeq = seq;
+    m_doneCond.notify_all();
+  }
+}
@@ -0,0 +1,106 @@
+// File: pimStream.h
+// PIMeval Simulator - Asynchronous Command Streams
+
+#ifndef LAVA_PIM_STREAM_H
+#define LAVA_PIM_STREAM_H
+
+#include "libpimeval.h"      // for PimStreamId, PimEventId, PimObjId
+#include "pimCmd.h"          // for pimCmd
+#include <memory>            // for unique_ptr
+#include <vector>            // for vector
+#include <deque>             // for deque
+#include <unordered_map>     // for unordered_map
+#include <thread>            // for thread
+#include <mutex>             // for mutex
+#include <atomic>            // for atomic
+#include <condition_variable>
+
+class pimDevice;
+
+
+//! @class  pimStreamMgr
+//! @brief  Asynchronous command streams of a PIM device
+//! - Scope: an asynchronous host API plus modeled overlap. Simulation of PIM commands is not
+//!   parallelized across streams, since all commands share the simulated device, the stats and the
+//!   thread pool under the exec mutex. Only host code overlaps with simulation
+//! - While a host thread has a current stream, commands issued by it are enqueued and return immediately
+//! - Enqueued commands of all streams run in enqueue order on a single executor thread, one at a time,
+//!   and each command still runs its elements on the thread pool
+//! - Read/write object sets of pending commands are tracked per PimObjId, with references mapped to
+//!   their root objects. Synchronous commands and object deletion only wait for pending commands that
+//!   access the same objects. Commands without known object sets are ordered against everything
+//! - Overlap between streams is modeled only: modeled runtime of stream commands follows a timeline
+//!   with a copy engine and a compute engine. A command starts after the objects it accesses are
+//!   ready. Host-device transfers overlap with computation if the perf energy model allows it
+class pimStreamMgr
+{
+public:
+  pimStreamMgr(pimDevice* device);
+  ~pimStreamMgr();
+
+  PimStreamId createStream();
+  bool destroyStream(PimStreamId stream);
+  bool setCurrentStream(PimStreamId stream);
+  PimStreamId getCurrentStream() const;
+  bool syncStream(PimStreamId stream);
+  void syncAll();
+  PimEventId recordEvent(PimStreamId stream);
+  bool waitEvent(PimEventId event);
+
+  bool enqueue(PimStreamId stream, std::unique_ptr<pimCmd> cmd);
+  void waitForCmd(const pimCmd& cmd);
+  void waitForObj(PimObjId objId);
+  void addRef(PimObjId refId, PimObjId rootId);
+  void removeObj(PimObjId objId);
+
+private:
+  //! @brief  An enqueued command with its root object access sets
+  struct streamTask
+  {
+    uint64_t m_seq;
+    PimStreamId m_stream;
+    std::unique_ptr<pimCmd> m_cmd;
+    bool m_isBarrier;
+    std::vector<PimObjId> m_readIds;
+    std::vector<PimObjId> m_writeIds;
+    unsigned m_probeId;  // root probe of the enqueuing thread, i.e., the API
+  };
+  //! @brief  Per-stream state
+  struct streamInfo
+  {
+    uint64_t m_lastSeq = 0;
+    bool m_hasError = false;
+  };
+
+  bool getRootAccess(const pimCmd& cmd, std::vector<PimObjId>& readIds, std::vector<PimObjId>& writeIds) const;
+  static bool hasConflict(const std::vector<PimObjId>& readIds1, const std::vector<PimObjId>& writeIds1,
+                          const std::vector<PimObjId>& readIds2, const std::vector<PimObjId>& writeIds2);
+  void waitUntil(std::unique_lock<std::mutex>& lock, uint64_t seq);
+  double scheduleModeled(const streamTask& task, double msRuntime);
+  void eraseEvents(PimStreamId stream, uint64_t seq);
+  bool isExecutorThread() const { return std::this_thread::get_id() == m_executorId.load(std::memory_order_acquire); }
+  void executorThread();
+
+  pimDevice* m_device;
+  uint64_t m_generation;  // distinguishes current streams of this manager from stale ones of another
+  mutable std::mutex m_mutex;
+  std::condition_variable m_taskCond;
+  std::condition_variable m_doneCond;
+  std::deque<streamTask> m_tasks;  // pending tasks in enqueue order, front is running
+  std::unordered_map<PimStreamId, streamInfo> m_streams;
+  std::unordered_map<PimEventId, std::pair<PimStreamId, uint64_t>> m_events;  // stream and sequence number of pending events
+  std::unordered_map<PimObjId, PimObjId> m_rootIds;  // object references to root objects
+  PimStreamId m_nextStreamId = 0;
+  PimEventId m_nextEventId = 0;
+  uint64_t m_nextSeq = 1;
+  uint64_t m_completedSeq = 0;
+  double m_msCopyEngineFree = 0.0;  // modeled timeline of stream commands
+  double m_msComputeEngineFree = 0.0;
+  double m_msModeledEnd = 0.0;
+  std::unordered_map<PimObjId, double> m_msObjReady;
+  bool m_terminate = false;
+  std::thread m_executor;
+  std::atomic<std::thread::id> m_executorId;  // set by the executor thread when it starts
+};
+
+#endif
@@ -0,0 +1,718 @@
+// File: pimTrace.cpp
+// PIMeval Simulator - API Trace Capture and Replay
+
+#include "pimTrace.h"
+#include "pimSim.h"          // for pimSim
+#include "pimCmd.h"          // for PimCmdEnum
+#include "pimUtils.h"        // for getNumBitsOfDataType
+#include <cstring>           // for memcmp
+#include <algorithm>         // for max
+
+// Trace segment that APIs of current thread are recorded into, if any
+static thread_local pimTraceWriter::segment* s_currentSegment = nullptr;
+
+//! @brief  pimTraceWriter ctor. Open the trace file and write the header
+pimTraceWriter::pimTraceWriter(const std::string& fileName)
+{
+  m_file = std::fopen(fileName.c_str(), "wb");
+  if (!m_file) {
+    std::printf("PIM-Error: Cannot open trace file %s\n", fileName.c_str());
+    return;
+  }
+  m_buffer.reserve(s_flushThreshold + 1024);
+  m_buffer.insert(m_buffer.end(), s_magic, s_magic + sizeof(s_magic));
+  m_buffer.push_back(s_version);
+  std::printf("PIM-Info: Recording API trace to %s\n", fileName.c_str());
+}
+
+//! @brief  pimTraceWriter dtor
+pimTraceWriter::~pimTraceWriter()
+{
+  if (m_file) {
+    for (const auto& seg : m_segments) {
+      m_buffer.insert(m_buffer.end(), seg.m_buffer.begin(), seg.m_buffer.end());
+    }
+    m_segments.clear();
+    flushLocked();
+    std::fclose(m_file);
+  }
+}
+
+//! @brief  Record an API call
+void
+pimTraceWriter::record(pimTraceOp op, const std::vector<uint64_t>& args)
+{
+  if (!m_file) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (s_currentSegment) {
+    writeRecord(s_currentSegment->m_buffer, op, args);
+    return;
+  }
+  if (m_segments.empty()) {
+    writeRecord(m_buffer, op, args);
+    if (m_buffer.size() >= s_flushThreshold) {
+      flushLocked();
+    }
+    return;
+  }
+  // wait behind open segments to keep trace order
+  if (m_segments.back().m_isOpen) {
+    m_segments.emplace_back();
+    m_segments.back().m_isOpen = false;
+  }
+  writeRecord(m_segments.back().m_buffer, op, args);
+}
+
+//! @brief  Reserve a segment at current position of the trace, starting with a record without arguments
+pimTraceWriter::segment*
+pimTraceWriter::openSegment(pimTraceOp op)
+{
+  if (!m_file) {
+    return nullptr;
+  }
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_segments.emplace_back();
+  writeRecord(m_segments.back().m_buffer, op, {});
+  return &m_segments.back();
+}
+
+//! @brief  End a segment with a record without arguments. Segments and records that no longer
+//!         wait behind an open segment are moved to the output buffer
+void
+pimTraceWriter::closeSegment(segment* seg, pimTraceOp op)
+{
+  if (!seg) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(m_mutex);
+  writeRecord(seg->m_buffer, op, {});
+  seg->m_isOpen = false;
+  while (!m_segments.empty() && !m_segments.front().m_isOpen) {
+    const std::vector<uint8_t>& buffer = m_segments.front().m_buffer;
+    m_buffer.insert(m_buffer.end(), buffer.begin(), buffer.end());
+    m_segments.pop_front();
+  }
+  if (m_buffer.size() >= s_flushThreshold) {
+    flushLocked();
+  }
+}
+
+//! @brief  Check if APIs of current thread are recorded into a segment
+bool
+pimTraceWriter::isInSegment()
+{
+  return s_currentSegment != nullptr;
+}
+
+//! @brief  Write buffered records to the trace file
+void
+pimTraceWriter::flush()
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  flushLocked();
+}
+
+//! @brief  Write buffered records to the trace file with mutex held
+void
+pimTraceWriter::flushLocked()
+{
+  if (m_file && !m_buffer.empty()) {
+    std::fwrite(m_buffer.data(), 1, m_buffer.size(), m_file);
+    std::fflush(m_file);
+  }
+  m_buffer.clear();
+}
+
+//! @brief  Append a record
+void
+pimTraceWriter::writeRecord(std::vector<uint8_t>& buffer, pimTraceOp op, const std::vector<uint64_t>& args)
+{
+  buffer.push_back(static_cast<uint8_t>(op));
+  writeVarint(buffer, args.size());
+  for (uint64_t arg : args) {
+    writeVarint(buffer, arg);
+  }
+}
+
+//! @brief  Append a LEB128 varint
+void
+pimTraceWriter::writeVarint(std::vector<uint8_t>& buffer, uint64_t val)
+{
+  while (val >= 0x80) {
+    buffer.push_back(static_cast<uint8_t>(val | 0x80));
+    val >>= 7;
+  }
+  buffer.push_back(static_cast<uint8_t>(val));
+}
+
+//! @brief  scopedSegment ctor
+pimTraceWriter::scopedSegment::scopedSegment(segment* seg)
+  : m_prevSegment(s_currentSegment)
+{
+  if (seg) {
+    s_currentSegment = seg;
+  }
+}
+
+//! @brief  scopedSegment dtor
+pimTraceWriter::scopedSegment::~scopedSegment()
+{
+  s_currentSegment = m_prevSegment;
+}
+
+//! @brief  Replay all records of a trace file
+//!         Stop only on an unreadable or truncated trace. A record that fails to replay is counted,
+//!         e.g., an API that also failed when recorded, or that does not fit current configurations
+bool
+pimTraceReplayer::replay()
+{
+  std::FILE* file = std::fopen(m_traceFile.c_str(), "rb");
+  if (!file) {
+    std::printf("PIM-Error: Cannot open trace file %s\n", m_traceFile.c_str());
+    return false;
+  }
+  bool ok = readHeader(file);
+  traceRecord rec;
+  while (ok) {
+    int op = std::fgetc(file);
+    if (op == EOF) {
+      break;
+    }
+    if (!readRecord(file, op, rec)) {
+      std::printf("PIM-Error: Truncated trace file %s\n", m_traceFile.c_str());
+      ok = false;
+      break;
+    }
+    m_numRecords++;
+    bool isReplayed = true;
+    if (rec.m_op == pimTraceOp::FUSE_BEGIN) {
+      m_isInFuse = true;
+      m_fuseRecords.clear();
+    } else if (rec.m_op == pimTraceOp::FUSE_END) {
+      m_isInFuse = false;
+      PimProg prog;
+      for (const auto& fuseRec : m_fuseRecords) {
+        prog.m_apis.push_back([this, fuseRec]() { return execute(fuseRec) ? PIM_OK : PIM_ERROR; });
+      }
+      isReplayed = pimSim::get()->pimFuse(prog);
+      // APIs of the program map trace IDs while they run, so wait for them when enqueued to a stream
+      if (m_currentStream != -1) {
+        isReplayed = pimSim::get()->pimStreamSync(m_currentStream) && isReplayed;
+      }
+    } else if (m_isInFuse) {
+      m_fuseRecords.push_back(rec);
+    } else {
+      isReplayed = execute(rec);
+    }
+    if (!isReplayed) {
+      m_numFailedRecords++;
+      std::printf("PIM-Warning: Failed to replay trace record %llu. Continue with next record\n", (unsigned long long)m_numRecords);
+    }
+  }
+  std::fclose(file);
+  return ok;
+}
+
+//! @brief  Read and check trace file header
+bool
+pimTraceReplayer::readHeader(std::FILE* file)
+{
+  char magic[sizeof(pimTraceWriter::s_magic)];
+  int version = 0;
+  if (std::fread(magic, 1, sizeof(magic), file) != sizeof(magic) ||
+      std::memcmp(magic, pimTraceWriter::s_magic, sizeof(magic)) != 0 ||
+      (version = std::fgetc(file)) != pimTraceWriter::s_version) {
+    std::printf("PIM-Error: Invalid or unsupported trace file %s\n", m_traceFile.c_str());
+    return false;
+  }
+  return true;
+}
+
+//! @brief  Read a LEB128 varint
+bool
+pimTraceReplayer::readVarint(std::FILE* file, uint64_t& val)
+{
+  val = 0;
+  for (unsigned shift = 0; shift < 64; shift += 7) {
+    int byte = std::fgetc(file);
+    if (byte == EOF) {
+      return false;
+    }
+    val |= static_cast<uint64_t>(byte & 0x7f) << shift;
+    if (!(byte & 0x80)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+//! @brief  Read arguments of a record after its op byte. Return false on truncated record
+bool
+pimTraceReplayer::readRecord(std::FILE* file, int op, traceRecord& rec)
+{
+  uint64_t numArgs = 0;
+  if (!readVarint(file, numArgs)) {
+    return false;
+  }
+  rec.m_op = static_cast<pimTraceOp>(op);
+  rec.m_args.resize(numArgs);
+  for (uint64_t& arg : rec.m_args) {
+    if (!readVarint(file, arg)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+//! @brief  Check number of arguments of a record
+bool
+pimTraceReplayer::checkNumArgs(const traceRecord& rec, size_t numArgs) const
+{
+  if (rec.m_args.size() < numArgs) {
+    std::printf("PIM-Error: Trace record of op %u has %zu arguments, expecting %zu\n",
+                static_cast<unsigned>(rec.m_op), rec.m_args.size(), numArgs);
+    return false;
+  }
+  return true;
+}
+
+//! @brief  Map an object ID of the trace to the object created during replay
+PimObjId
+pimTraceReplayer::mapObj(uint64_t traceId) const
+{
+  auto it = m_objIds.find(static_cast<PimObjId>(traceId));
+  return it == m_objIds.end() ? -1 : it->second;
+}
+
+//! @brief  Track an object created during replay
+void
+pimTraceReplayer::addObj(uint64_t traceId, PimObjId objId, uint64_t numElements, PimDataType dataType)
+{
+  if (objId == -1) {
+    return;
+  }
+  m_objIds[static_cast<PimObjId>(traceId)] = objId;
+  m_objShapes[objId] = { numElements, dataType };
+}
+
+//! @brief  Get number of bytes of a host buffer for an object
+//!         No host data is moved in analysis mode, so a placeholder of one word is enough
+uint64_t
+pimTraceReplayer::getNumHostBytes(uint64_t numElements, PimDataType dataType) const
+{
+  if (pimSim::get()->isAnalysisMode()) {
+    return sizeof(uint64_t);
+  }
+  unsigned bits = pimUtils::getNumBitsOfDataType(dataType, PimBitWidth::HOST);
+  return numElements * ((bits + 7) / 8);
+}
+
+//! @brief  Get number of bytes of a host buffer spanned by a strided copy range of an object
+uint64_t
+pimTraceReplayer::getNumStridedHostBytes(PimObjId objId, uint64_t idxBegin, uint64_t idxEnd,
+                                         uint64_t numElementsPerRow, uint64_t rowPitch, uint64_t elemStride) const
+{
+  auto shape = m_objShapes.find(objId);
+  if (pimSim::get()->isAnalysisMode() || shape == m_objShapes.end() || numElementsPerRow == 0) {
+    return sizeof(uint64_t);
+  }
+  uint64_t numElements = (idxEnd == 0 ? shape->second.first : idxEnd - idxBegin);
+  uint64_t bytesPerElement = getNumHostBytes(1, shape->second.second);
+  if (numElements == 0) {
+    return sizeof(uint64_t);
+  }
+  elemStride = elemStride ? elemStride : bytesPerElement;
+  rowPitch = rowPitch ? rowPitch : numElementsPerRow * elemStride;
+  uint64_t numBytes = ((numElements - 1) / numElementsPerRow) * rowPitch +
+                      (std::min(numElementsPerRow, numElements) - 1) * elemStride + bytesPerElement;
+  return std::max<uint64_t>(numBytes, sizeof(uint64_t));
+}
+
+//! @brief  Get a host buffer large enough for all elements of an object
+void*
+pimTraceReplayer::getHostBuffer(PimObjId objId)
+{
+  auto it = m_hostBuffers.find(objId);
+  if (it != m_hostBuffers.end()) {
+    return it->second.data();
+  }
+  auto shape = m_objShapes.find(objId);
+  if (shape != m_objShapes.end()) {
+    uint64_t numBytes = getNumHostBytes(shape->second.first, shape->second.second);
+    m_scratch.resize(std::max<uint64_t>(m_scratch.size(), numBytes));
+  }
+  m_scratch.resize(std::max<size_t>(m_scratch.size(), sizeof(uint64_t)));
+  return m_scratch.data();
+}
+
+//! @brief  Execute a trace record
+bool
+pimTraceReplayer::execute(const traceRecord& rec)
+{
+  pimSim* sim = pimSim::get();
+  const auto& args = rec.m_args;
+  switch (rec.m_op) {
+    case pimTraceOp::CREATE_DEVICE:
+    {
+      if (!checkNumArgs(rec, 1)) { return false; }
+      m_objIds.clear();
+      m_objShapes.clear();
+      m_hostBuffers.clear();
+      m_streamIds.clear();
+      m_eventIds.clear();
+      m_currentStream = -1;
+      // An empty config file path derives configurations from environment variables
+      return sim->createDeviceFromConfig(static_cast<PimDeviceEnum>(args[0]), m_configFile.c_str());
+    }
+    case pimTraceOp::DELETE_DEVICE: return sim->deleteDevice();
+    case pimTraceOp::START_TIMER: sim->startKernelTimer(); return true;
+    case pimTraceOp::END_TIMER: sim->endKernelTimer(); return true;
+    case pimTraceOp::SHOW_STATS: sim->showStats(); return true;
+    case pimTraceOp::RESET_STATS: sim->resetStats(); return true;
+    case pimTraceOp::ALLOC:
+    case pimTraceOp::ALLOC_FROM_HOST_BUFFER:
+    {
+      if (!checkNumArgs(rec, 4)) { return false; }
+      PimAllocEnum allocType = static_cast<PimAllocEnum>(args[0]);
+      PimDataType dataType = static_cast<PimDataType>(args[2]);
+      PimObjId objId = -1;
+      if (rec.m_op == pimTraceOp::ALLOC) {
+        objId = sim->pimAlloc(allocType, args[1], dataType);
+      } else {
+        std::vector<uint8_t> buffer(getNumHostBytes(args[1], dataType));
+        objId = sim->pimAllocFromHostBuffer(allocType, args[1], dataType, buffer.data());
+        if (objId != -1) {
+          m_hostBuffers[objId] = std::move(buffer);
+        }
+      }
+      addObj(args[3], objId, args[1], dataType);
+      return objId != -1 || static_cast<PimObjId>(args[3]) == -1;
+    }
+    case pimTraceOp::ALLOC_ASSOCIATED:
+    {
+      if (!checkNumArgs(rec, 3)) { return false; }
+      PimObjId assocId = mapObj(args[0]);
+      PimDataType dataType = static_cast<PimDataType>(args[1]);
+      PimObjId objId = sim->pimAllocAssociated(assocId, dataType);
+      auto shape = m_objShapes.find(assocId);
+      addObj(args[2], objId, shape == m_objShapes.end() ? 0 : shape->second.first, dataType);
+      return objId != -1 || static_cast<PimObjId>(args[2]) == -1;
+    }
+    case pimTraceOp::ALLOC_BUFFER:
+    {
+      if (!checkNumArgs(rec, 3)) { return false; }
+      PimDataType dataType = static_cast<PimDataType>(args[1]);
+      PimObjId objId = sim->pimAllocBuffer(static_cast<uint32_t>(args[0]), dataType);
+      addObj(args[2], objId, args[0], dataType);
+      return objId != -1 || static_cast<PimObjId>(args[2]) == -1;
+    }
+    case pimTraceOp::FREE:
+    {
+      if (!checkNumArgs(rec, 1)) { return false; }
+      PimObjId objId = mapObj(args[0]);
+      m_objIds.erase(static_cast<PimObjId>(args[0]));
+      m_objShapes.erase(objId);
+      bool ok = sim->pimFree(objId);
+      m_hostBuffers.erase(objId);
+      return ok;
+    }
+    case pimTraceOp::CREATE_RANGED_REF:
+    {
+      if (!checkNumArgs(rec, 4)) { return false; }
+      PimObjId refId = mapObj(args[0]);
+      PimObjId objId = sim->pimCreateRangedRef(refId, args[1], args[2]);
+      auto shape = m_objShapes.find(refId);
+      if (shape != m_objShapes.end()) {
+        addObj(args[3], objId, args[2] - args[1], shape->second.second);
+      }
+      return objId != -1 || static_cast<PimObjId>(args[3]) == -1;
+    }
+    case pimTraceOp::CREATE_DUAL_CONTACT_REF:
+    {
+      if (!checkNumArgs(rec, 2)) { return false; }
+      PimObjId refId = mapObj(args[0]);
+      PimObjId objId = sim->pimCreateDualContactRef(refId);
+      auto shape = m_objShapes.find(refId);
+      if (shape != m_objShapes.end()) {
+        addObj(args[1], objId, shape->second.first, shape->second.second);
+      }
+      return objId != -1 || static_cast<PimObjId>(args[1]) == -1;
+    }
+    case pimTraceOp::REGISTER_HOST_BUFFER:
+    {
+      if (!checkNumArgs(rec, 1)) { return false; }
+      PimObjId objId = mapObj(args[0]);
+      auto shape = m_objShapes.find(objId);
+      if (shape == m_objShapes.end()) { return false; }
+      std::vector<uint8_t>& buffer = m_hostBuffers[objId];
+      buffer.resize(getNumHostBytes(shape->second.first, shape->second.second));
+      return sim->pimRegisterHostBuffer(objId, buffer.data());
+    }
+    case pimTraceOp::CMD:
+      return executeCmd(rec);
+    case pimTraceOp::STREAM_CREATE:
+    {
+      if (!checkNumArgs(rec, 1)) { return false; }
+      PimStreamId stream = sim->pimStreamCreate();
+      m_streamIds[static_cast<PimStreamId>(args[0])] = stream;
+      return stream != -1;
+    }
+    case pimTraceOp::STREAM_DESTROY:
+    case pimTraceOp::SET_STREAM:
+    case pimTraceOp::STREAM_SYNC:
+    case pimTraceOp::EVENT_RECORD:
+    {
+      if (!checkNumArgs(rec, 1)) { return false; }
+      PimStreamId traceStream = static_cast<PimStreamId>(args[0]);
+      auto it = m_streamIds.find(traceStream);
+      PimStreamId stream = (it == m_streamIds.end() ? -1 : it->second);
+      if (rec.m_op == pimTraceOp::STREAM_DESTROY) {
+        m_streamIds.erase(traceStream);
+        if (m_currentStream == stream) {
+          m_currentStream = -1;
+        }
+        return sim->pimStreamDestroy(stream);
+      }
+      if (rec.m_op == pimTraceOp::SET_STREAM) {
+        bool ok = sim->pimSetStream(stream);
+        if (ok) {
+          m_currentStream = stream;
+        }
+        return ok;
+      }
+      if (rec.m_op == pimTraceOp::STREAM_SYNC) {
+        return sim->pimStreamSync(stream);
+      }
+      if (!checkNumArgs(rec, 2)) { return false; }
+      PimEventId event = sim->pimEventRecord(stream);
+      m_eventIds[static_cast<PimEventId>(args[1])] = event;
+      return event != -1;
+    }
+    case pimTraceOp::EVENT_WAIT:
+    {
+      if (!checkNumArgs(rec, 1)) { return false; }
+      auto it = m_eventIds.find(static_cast<PimEventId>(args[0]));
+      return sim->pimEventWait(it == m_eventIds.end() ? -1 : it->second);
+    }
+    case pimTraceOp::COPY_BATCH:
+    {
+      if (!checkNumArgs(rec, 2)) { return false; }
+      PimCmdEnum cmdType = static_cast<PimCmdEnum>(args[0]);
+      uint64_t numDescs = args[1];
+      if (!checkNumArgs(rec, 2 + 3 * numDescs)) { return false; }
+      std::vector<PimCopyDesc> descs(numDescs);
+      for (uint64_t i = 0; i < numDescs; ++i) {
+        descs[i].obj = mapObj(args[2 + 3 * i]);
+        descs[i].idxBegin = args[3 + 3 * i];
+        descs[i].idxEnd = args[4 + 3 * i];
+      }
+      // Transfers of a batch run in parallel, so each one needs its own host buffer when bytes are moved
+      std::vector<std::vector<uint8_t>> buffers;
+      if (sim->isAnalysisMode()) {
+        for (const PimCopyDesc& desc : descs) {
+          getHostBuffer(desc.obj);  // size the scratch buffer before taking pointers
+        }
+      } else {
+        buffers.resize(numDescs);
+      }
+      for (uint64_t i = 0; i < numDescs; ++i) {
+        if (buffers.empty()) {
+          descs[i].hostPtr = getHostBuffer(descs[i].obj);
+          continue;
+        }
+        auto shape = m_objShapes.find(descs[i].obj);
+        uint64_t numBytes = shape == m_objShapes.end() ? 0 : getNumHostBytes(shape->second.first, shape->second.second);
+        buffers[i].resize(std::max<uint64_t>(numBytes, sizeof(uint64_t)));
+        descs[i].hostPtr = buffers[i].data();
+      }
+      return cmdType == PimCmdEnum::COPY_H2D ? sim->pimCopyMainToDeviceBatch(descs.data(), numDescs)
+                                             : sim->pimCopyDeviceToMainBatch(descs.data(), numDescs);
+    }
+    default:
+      std::printf("PIM-Error: Unknown trace record op %u\n", static_cast<unsigned>(rec.m_op));
+  }
+  return false;
+}
+
+//! @brief  Execute a PIM command record
+bool
+pimTraceReplayer::executeCmd(const traceRecord& rec)
+{
+  if (!checkNumArgs(rec, 1)) { return false; }
+  pimSim* sim = pimSim::get();
+  PimCmdEnum cmdType = static_cast<PimCmdEnum>(rec.m_args[0]);
+  std::vector<uint64_t> args(rec.m_args.begin() + 1, rec.m_args.end());
+  auto obj = [&](size_t i) { return mapObj(args[i]); };
+
+  switch (cmdType) {
+    case PimCmdEnum::COPY_H2D:
+    case PimCmdEnum::COPY_D2H:
+    {
+      // copyType, objId, idxBegin, idxEnd. Copy type of -1 means default copy
+      // Strided copies are followed by numElementsPerRow, rowPitch, elemStride
+      if (args.size() < 4) { break; }
+      PimObjId objId = obj(1);
+      if (args.size() >= 7) {
+        std::vector<uint8_t> stridedBuffer(getNumStridedHostBytes(objId, args[2], args[3], args[4], args[5], args[6]));
+        if (cmdType == PimCmdEnum::COPY_H2D) {
+          return sim->pimCopyMainToDevice2D(stridedBuffer.data(), objId, args[4], args[5], args[6], args[2], args[3]);
+        }
+        return sim->pimCopyDeviceToMain2D(objId, stridedBuffer.data(), args[4], args[5], args[6], args[2], args[3]);
+      }
+      void* hostBuffer = getHostBuffer(objId);
+      bool hasCopyType = (static_cast<int64_t>(args[0]) != -1);
+      PimCopyEnum copyType = static_cast<PimCopyEnum>(args[0]);
+      if (cmdType == PimCmdEnum::COPY_H2D) {
+        return hasCopyType ? sim->pimCopyMainToDeviceWithType(copyType, hostBuffer, objId, args[2], args[3])
+                           : sim->pimCopyMainToDevice(hostBuffer, objId, args[2], args[3]);
+      }
+      return hasCopyType ? sim->pimCopyDeviceToMainWithType(copyType, objId, hostBuffer, args[2], args[3])
+                         : sim->pimCopyDeviceToMain(objId, hostBuffer, args[2], args[3]);
+    }
+    case PimCmdEnum::COPY_D2D:
+      if (args.size() < 4) { break; }
+      return sim->pimCopyDeviceToDevice(obj(0), obj(1), args[2], args[3]);
+    case PimCmdEnum::REDSUM:
+    case PimCmdEnum::REDMIN:
+    case PimCmdEnum::REDMAX:
+    {
+      if (args.size() < 3) { break; }
+      void* result = getHostBuffer(-1);
+      if (cmdType == PimCmdEnum::REDSUM) { return sim->pimRedSum(obj(0), result, args[1], args[2]); }
+      if (cmdType == PimCmdEnum::REDMIN) { return sim->pimRedMin(obj(0), result, args[1], args[2]); }
+      return sim->pimRedMax(obj(0), result, args[1], args[2]);
+    }
+    case PimCmdEnum::MAC:
+      if (args.size() < 2) { break; }
+      return sim->pimMAC(obj(0), obj(1), getHostBuffer(-1));
+    case PimCmdEnum::AES_SBOX:
+    case PimCmdEnum::AES_INVERSE_SBOX:
+    {
+      if (args.size() < 2) { break; }
+      std::vector<uint8_t> lut(args.begin() + 2, args.end());
+      return cmdType == PimCmdEnum::AES_SBOX ? sim->pimAesSbox(obj(0), obj(1), lut)
+                                             : sim->pimAesInverseSbox(obj(0), obj(1), lut);
+    }
+    case PimCmdEnum::BROADCAST:
+      if (args.size() < 2) { break; }
+      return sim->pimBroadcast<uint64_t>(obj(0), args[1]);
+    case PimCmdEnum::ROTATE_ELEM_R:
+    case PimCmdEnum::ROTATE_ELEM_L:
+    case PimCmdEnum::SHIFT_ELEM_R:
+    case PimCmdEnum::SHIFT_ELEM_L:
+      if (args.size() < 1) { break; }
+      switch (cmdType) {
+        case PimCmdEnum::ROTATE_ELEM_R: return sim->pimRotateElementsRight(obj(0));
+        case PimCmdEnum::ROTATE_ELEM_L: return sim->pimRotateElementsLeft(obj(0));
+        case PimCmdEnum::SHIFT_ELEM_R: return sim->pimShiftElementsRight(obj(0));
+        default: return sim->pimShiftElementsLeft(obj(0));
+      }
+    case PimCmdEnum::COPY_O2O:
+    case PimCmdEnum::CONVERT_TYPE:
+    case PimCmdEnum::ABS:
+    case PimCmdEnum::NOT:
+    case PimCmdEnum::POPCOUNT:
+      if (args.size() < 2) { break; }
+      switch (cmdType) {
+        case PimCmdEnum::COPY_O2O: return sim->pimCopyObjectToObject(obj(0), obj(1));
+        case PimCmdEnum::CONVERT_TYPE: return sim->pimConvertType(obj(0), obj(1));
+        case PimCmdEnum::ABS: return sim->pimAbs(obj(0), obj(1));
+        case PimCmdEnum::NOT: return sim->pimNot(obj(0), obj(1));
+        default: return sim->pimPopCount(obj(0), obj(1));
+      }
+    case PimCmdEnum::MUL_SCALAR:
+    case PimCmdEnum::DIV_SCALAR:
+    case PimCmdEnum::AND_SCALAR:
+    case PimCmdEnum::OR_SCALAR:
+    case PimCmdEnum::XOR_SCALAR:
+    case PimCmdEnum::XNOR_SCALAR:
+    case PimCmdEnum::GT_SCALAR:
+    case PimCmdEnum::LT_SCALAR:
+    case PimCmdEnum::EQ_SCALAR:
+    case PimCmdEnum::NE_SCALAR:
+    case PimCmdEnum::MIN_SCALAR:
+    case PimCmdEnum::MAX_SCALAR:
+    case PimCmdEnum::BIT_SLICE_EXTRACT:
+    case PimCmdEnum::BIT_SLICE_INSERT:
+    case PimCmdEnum::SHIFT_BITS_R:
+    case PimCmdEnum::SHIFT_BITS_L:
+    {
+      if (args.size() < 3) { break; }
+      PimObjId src = obj(0);
+      PimObjId dest = obj(1);
+      uint64_t scalar = args[2];
+      switch (cmdType) {
+        case PimCmdEnum::MUL_SCALAR: return sim->pimMul(src, dest, scalar);
+        case PimCmdEnum::DIV_SCALAR: return sim->pimDiv(src, dest, scalar);
+        case PimCmdEnum::AND_SCALAR: return sim->pimAnd(src, dest, scalar);
+        case PimCmdEnum::OR_SCALAR: return sim->pimOr(src, dest, scalar);
+        case PimCmdEnum::XOR_SCALAR: return sim->pimXor(src, dest, scalar);
+        case PimCmdEnum::XNOR_SCALAR: return sim->pimXnor(src, dest, scalar);
+        case PimCmdEnum::GT_SCALAR: return sim->pimGT(src, dest, scalar);
+        case PimCmdEnum::LT_SCALAR: return sim->pimLT(src, dest, scalar);
+        case PimCmdEnum::EQ_SCALAR: return sim->pimEQ(src, dest, scalar);
+        case PimCmdEnum::NE_SCALAR: return sim->pimNE(src, dest, scalar);
+        case PimCmdEnum::MIN_SCALAR: return sim->pimMin(src, dest, scalar);
+        case PimCmdEnum::MAX_SCALAR: return sim->pimMax(src, dest, scalar);
+        case PimCmdEnum::BIT_SLICE_EXTRACT: return sim->pimBitSliceExtract(src, dest, static_cast<unsigned>(scalar));
+        case PimCmdEnum::BIT_SLICE_INSERT: return sim->pimBitSliceInsert(src, dest, static_cast<unsigned>(scalar));
+        case PimCmdEnum::SHIFT_BITS_R: return sim->pimShiftBitsRight(src, dest, static_cast<unsigned>(scalar));
+        default: return sim->pimShiftBitsLeft(src, dest, static_cast<unsigned>(scalar));
+      }
+    }
+    case PimCmdEnum::DIV:
+    case PimCmdEnum::MUL:
+    case PimCmdEnum::AND:
+    case PimCmdEnum::OR:
+    case PimCmdEnum::XOR:
+    case PimCmdEnum::XNOR:
+    case PimCmdEnum::GT:
+    case PimCmdEnum::LT:
+    case PimCmdEnum::EQ:
+    case PimCmdEnum::NE:
+    case PimCmdEnum::MIN:
+    case PimCmdEnum::MAX:
+    {
+      if (args.size() < 3) { break; }
+      PimObjId src1 = obj(0);
+      PimObjId src2 = obj(1);
+      PimObjId dest = obj(2);
+      switch (cmdType) {
+        case PimCmdEnum::DIV: return sim->pimDiv(src1, src2, dest);
+        case PimCmdEnum::MUL: return sim->pimMul(src1, src2, dest);
+        case PimCmdEnum::AND: return sim->pimAnd(src1, src2, dest);
+        case PimCmdEnum::OR: return sim->pimOr(src1, src2, dest);
+        case PimCmdEnum::XOR: return sim->pimXor(src1, src2, dest);
+        case PimCmdEnum::XNOR: return sim->pimXnor(src1, src2, dest);
+        case PimCmdEnum::GT: return sim->pimGT(src1, src2, dest);
+        case PimCmdEnum::LT: return sim->pimLT(src1, src2, dest);
+        case PimCmdEnum::EQ: return sim->pimEQ(src1, src2, dest);
+        case PimCmdEnum::NE: return sim->pimNE(src1, src2, dest);
+        case PimCmdEnum::MIN: return sim->pimMin(src1, src2, dest);
+        default: return sim->pimMax(src1, src2, dest);
+      }
+    }
+    case PimCmdEnum::SCALED_ADD:
+      if (args.size() < 4) { break; }
+      return sim->pimScaledAdd(obj(0), obj(1), obj(2), args[3]);
+    case PimCmdEnum::COND_COPY:
+      if (args.size() < 3) { break; }
+      return sim->pimCondCopy(obj(0), obj(1), obj(2));
+    case PimCmdEnum::COND_BROADCAST:
+      if (args.size() < 3) { break; }
+      return sim->pimCondBroadcast(obj(0), args[1], obj(2));
+    case PimCmdEnum::COND_SELECT:
+      if (args.size() < 4) { break; }
+      return sim->pimCondSelect(obj(0), obj(1), obj(2), obj(3));
+    case PimCmdEnum::COND_SELECT_SCALAR:
+      if (args.size() < 4) { break; }
+      return sim->pimCondSelectScalar(obj(0), obj(1), args[2], obj(3));
+    default:
+      std::printf("PIM-Error: Unsupported PIM command %s in trace\n", pimCmd::getName(cmdType, "").c_str());
+      return false;
+  }
+  std::printf("PIM-Error: Trace record of PIM command %s has too few arguments\n", pimCmd::getName(cmdType, "").c_str());
+  return false;
+}
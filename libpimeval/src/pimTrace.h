@@ -0,0 +1,152 @@
+// File: pimTrace.h
+// PIMeval Simulator - API Trace Capture and Replay
+
+#ifndef LAVA_PIM_TRACE_H
+#define LAVA_PIM_TRACE_H
+
+#include "libpimeval.h"      // for PimObjId, PimStreamId, PimEventId
+#include <cstdint>           // for uint8_t, uint64_t
+#include <cstdio>            // for FILE
+#include <string>            // for string
+#include <vector>            // for vector
+#include <list>              // for list
+#include <unordered_map>     // for unordered_map
+#include <mutex>             // for mutex
+
+
+//! @enum   pimTraceOp
+//! @brief  Trace record types. Values are part of the trace format, append only
+enum class pimTraceOp : uint8_t
+{
+  CREATE_DEVICE = 0,       // deviceType
+  DELETE_DEVICE,
+  START_TIMER,
+  END_TIMER,
+  SHOW_STATS,
+  RESET_STATS,
+  ALLOC,                   // allocType, numElements, dataType, objId
+  ALLOC_ASSOCIATED,        // assocId, dataType, objId
+  ALLOC_BUFFER,            // numElements, dataType, objId
+  ALLOC_FROM_HOST_BUFFER,  // allocType, numElements, dataType, objId
+  FREE,                    // objId
+  CREATE_RANGED_REF,       // refId, idxBegin, idxEnd, objId
+  CREATE_DUAL_CONTACT_REF, // refId, objId
+  REGISTER_HOST_BUFFER,    // objId
+  CMD,                     // PimCmdEnum, operand ids and scalars of the API
+  FUSE_BEGIN,
+  FUSE_END,
+  STREAM_CREATE,           // streamId
+  STREAM_DESTROY,          // streamId
+  SET_STREAM,              // streamId
+  STREAM_SYNC,             // streamId
+  EVENT_RECORD,            // streamId, eventId
+  EVENT_WAIT,              // eventId
+  COPY_BATCH,              // PimCmdEnum, numDescs, then objId, idxBegin, idxEnd of each transfer
+};
+
+
+//! @class  pimTraceWriter
+//! @brief  Record API calls that reach pimSim into a compact binary trace file
+//! Trace format: "PIMTRACE" magic, a version byte, then records of
+//! - op (1 byte), number of arguments (varint), arguments (LEB128 varints of uint64_t bits)
+//! Host pointers are not recorded. Replay provides scratch host buffers.
+class pimTraceWriter
+{
+public:
+  pimTraceWriter(const std::string& fileName);
+  ~pimTraceWriter();
+
+  bool isOpen() const { return m_file != nullptr; }
+  void record(pimTraceOp op, const std::vector<uint64_t>& args);
+  void flush();
+
+  //! @brief  Records reserved at a position of the trace and filled later, e.g., APIs of a fused
+  //!         program recorded while it runs, possibly on a stream executor thread
+  struct segment
+  {
+    std::vector<uint8_t> m_buffer;
+    bool m_isOpen = true;
+  };
+  segment* openSegment(pimTraceOp op);
+  void closeSegment(segment* seg, pimTraceOp op);
+  static bool isInSegment();
+
+  //! @class  scopedSegment
+  //! @brief  Record APIs of current thread into a segment within a scope. No effect for nullptr
+  class scopedSegment
+  {
+  public:
+    scopedSegment(segment* seg);
+    ~scopedSegment();
+  private:
+    segment* m_prevSegment;
+  };
+
+  inline static const char s_magic[8] = { 'P', 'I', 'M', 'T', 'R', 'A', 'C', 'E' };
+  static constexpr uint8_t s_version = 1;
+
+private:
+  static void writeRecord(std::vector<uint8_t>& buffer, pimTraceOp op, const std::vector<uint64_t>& args);
+  static void writeVarint(std::vector<uint8_t>& buffer, uint64_t val);
+  void flushLocked();
+
+  std::FILE* m_file = nullptr;
+  std::vector<uint8_t> m_buffer;
+  std::list<segment> m_segments;  // segments and records after the first open segment, in trace order
+  std::mutex m_mutex;
+  static constexpr size_t s_flushThreshold = 1 << 20;
+};
+
+
+//! @class  pimTraceReplayer
+//! @brief  Re-execute a binary trace against current simulator configurations
+//! Object, stream and event IDs of the trace are mapped to IDs created during replay
+class pimTraceReplayer
+{
+public:
+  pimTraceReplayer(const std::string& traceFile, const std::string& configFile)
+    : m_traceFile(traceFile), m_configFile(configFile) {}
+  ~pimTraceReplayer() {}
+
+  bool replay();
+  uint64_t getNumRecords() const { return m_numRecords; }
+  uint64_t getNumFailedRecords() const { return m_numFailedRecords; }
+
+private:
+  //! @brief  A decoded trace record
+  struct traceRecord
+  {
+    pimTraceOp m_op;
+    std::vector<uint64_t> m_args;
+  };
+
+  bool readHeader(std::FILE* file);
+  static bool readVarint(std::FILE* file, uint64_t& val);
+  static bool readRecord(std::FILE* file, int op, traceRecord& rec);
+  bool execute(const traceRecord& rec);
+  bool executeCmd(const traceRecord& rec);
+  bool checkNumArgs(const traceRecord& rec, size_t numArgs) const;
+
+  PimObjId mapObj(uint64_t traceId) const;
+  void addObj(uint64_t traceId, PimObjId objId, uint64_t numElements, PimDataType dataType);
+  void* getHostBuffer(PimObjId objId);
+  uint64_t getNumHostBytes(uint64_t numElements, PimDataType dataType) const;
+  uint64_t getNumStridedHostBytes(PimObjId objId, uint64_t idxBegin, uint64_t idxEnd,
+                                  uint64_t numElementsPerRow, uint64_t rowPitch, uint64_t elemStride) const;
+
+  std::string m_traceFile;
+  std::string m_configFile;
+  uint64_t m_numRecords = 0;
+  uint64_t m_numFailedRecords = 0;
+  std::vector<traceRecord> m_fuseRecords;  // records of a fused program being read
+  bool m_isInFuse = false;
+  std::unordered_map<PimObjId, PimObjId> m_objIds;  // trace ID to replay ID
+  std::unordered_map<PimObjId, std::pair<uint64_t, PimDataType>> m_objShapes;
+  std::unordered_map<PimObjId, std::vector<uint8_t>> m_hostBuffers;  // backing store of host buffer objects
+  std::unordered_map<PimStreamId, PimStreamId> m_streamIds;
+  PimStreamId m_currentStream = -1;  // replay stream set by the last SET_STREAM
+  std::unordered_map<PimEventId, PimEventId> m_eventIds;
+  std::vector<uint8_t> m_scratch;
+};
+
+#endif
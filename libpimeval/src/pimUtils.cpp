@@ -88,6 +88,7 @@ pimUtils::pimDataTypeEnumToStr(PimDataType dataType)
   case PIM_FP16: return "fp16";
   case PIM_BF16: return "bf16";
   case PIM_FP8: return "fp8";
+  case PIM_DATA_TYPE_MAX: break;
   }
   return "Unknown";
 }
@@ -171,14 +172,87 @@ pimUtils::getDeviceDataLayout(PimDeviceEnum deviceType)
   return PimDataLayout::UNKNOWN;
 }
 
+//! @brief  Detect the highest SIMD ISA level supported by the host CPU
+PimSimdIsa
+pimUtils::detectSimdIsa()
+{
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw") &&
+      __builtin_cpu_supports("avx512dq") && __builtin_cpu_supports("avx512vl")) {
+    return PimSimdIsa::AVX512;
+  }
+  if (__builtin_cpu_supports("avx2")) {
+    return PimSimdIsa::AVX2;
+  }
+#endif
+  return PimSimdIsa::SCALAR;
+}
+
+//! @brief  Convert PimSimdIsa to string
+std::string
+pimUtils::pimSimdIsaToStr(PimSimdIsa isa)
+{
+  switch (isa) {
+    case PimSimdIsa::SCALAR: return "scalar";
+    case PimSimdIsa::AVX2: return "avx2";
+    case PimSimdIsa::AVX512: return "avx512";
+  }
+  return "Unknown";
+}
+
+//! @brief  Convert string to PimSimdIsa. Return SCALAR for unknown strings
+PimSimdIsa
+pimUtils::strToPimSimdIsa(const std::string& isaStr)
+{
+  if (isaStr == "avx512") {
+    return PimSimdIsa::AVX512;
+  } else if (isaStr == "avx2") {
+    return PimSimdIsa::AVX2;
+  }
+  return PimSimdIsa::SCALAR;
+}
+
+//! @brief  Convert PimHugePageMode to string
+std::string
+pimUtils::pimHugePageModeToStr(PimHugePageMode mode)
+{
+  switch (mode) {
+    case PimHugePageMode::NONE: return "none";
+    case PimHugePageMode::THP: return "thp";
+    case PimHugePageMode::HUGETLB: return "hugetlb";
+  }
+  return "Unknown";
+}
+
+//! @brief  Convert string to PimHugePageMode. Return NONE for unknown strings
+PimHugePageMode
+pimUtils::strToPimHugePageMode(const std::string& modeStr)
+{
+  if (modeStr == "thp") {
+    return PimHugePageMode::THP;
+  } else if (modeStr == "hugetlb") {
+    return PimHugePageMode::HUGETLB;
+  }
+  return PimHugePageMode::NONE;
+}
+
 //! @brief  Thread pool ctor
 pimUtils::threadPool::threadPool(size_t numThreads)
-  : m_terminate(false),
-    m_workersRemaining(0)
+  : m_deques(std::max<size_t>(numThreads, 1)),
+    m_terminate(false),
+    m_jobGen(0),
+    m_isJobOpen(false),
+    m_func(nullptr),
+    m_idxBegin(0),
+    m_idxEnd(0),
+    m_grainSize(1),
+    m_chunksRemaining(0),
+    m_numActiveWorkers(0)
 {
-  // reserve one thread for main program
+  // reserve one thread for main program, which participates as thread 0
   for (size_t i = 1; i < numThreads; ++i) {
-    m_threads.emplace_back([this] { workerThread(); });
+    m_threads.emplace_back([this, i] { workerThread(i); });
   }
   std::printf("PIM-Info: Created thread pool with %lu threads.\n", m_threads.size());
 }
@@ -198,45 +272,136 @@ pimUtils::threadPool::~threadPool()
   }
 }
 
-//! @brief  Entry to process workers in MT
+//! @brief  Run func(chunkBegin, chunkEnd) over [idxBegin, idxEnd) in chunks of grainSize in MT.
+//!         Return after all chunks are done
 void
-pimUtils::threadPool::doWork(const std::vector<pimUtils::threadWorker*>& workers)
+pimUtils::threadPool::parallelFor(uint64_t idxBegin, uint64_t idxEnd, uint64_t grainSize, const rangeFunc& func)
 {
+  if (idxBegin >= idxEnd) {
+    return;
+  }
+  grainSize = std::max<uint64_t>(grainSize, 1);
+  uint64_t numChunks = (idxEnd - idxBegin + grainSize - 1) / grainSize;
+  assert(numChunks <= 0xFFFFFFFFULL);
+  if (m_threads.empty() || numChunks == 1) {
+    func(idxBegin, idxEnd);
+    return;
+  }
+
+  // distribute contiguous blocks of chunks to per-thread deques
+  uint64_t numDeques = m_deques.size();
+  for (uint64_t tid = 0; tid < numDeques; ++tid) {
+    uint64_t chunkBegin = numChunks * tid / numDeques;
+    uint64_t chunkEnd = numChunks * (tid + 1) / numDeques;
+    m_deques[tid].m_range.store(packRange(chunkBegin, chunkEnd), std::memory_order_relaxed);
+  }
+  m_func = &func;
+  m_idxBegin = idxBegin;
+  m_idxEnd = idxEnd;
+  m_grainSize = grainSize;
+  m_chunksRemaining.store(numChunks, std::memory_order_relaxed);
   {
     std::unique_lock<std::mutex> lock(m_mutex);
-    for (auto& worker : workers) {
-      m_workers.push(worker);
-    }
-    m_workersRemaining = workers.size();
+    ++m_jobGen;
+    m_isJobOpen = true;
   }
   m_cond.notify_all();
 
-  // Wait for all workers to be done
-  std::unique_lock<std::mutex> lock(m_mutex);
-  m_cond.wait(lock, [this] { return m_workersRemaining == 0; });
+  runChunks(0);
+
+  // wait for chunks stolen by other threads, then retire the job once no thread is still in it
+  while (m_chunksRemaining.load(std::memory_order_acquire) > 0) {
+    std::this_thread::yield();
+  }
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_isJobOpen = false;
+  }
+  while (m_numActiveWorkers.load(std::memory_order_acquire) > 0) {
+    std::this_thread::yield();
+  }
+  m_func = nullptr;
+}
+
+//! @brief  Pop a chunk from the front of own deque
+bool
+pimUtils::threadPool::popFront(unsigned tid, uint64_t& chunkIdx)
+{
+  std::atomic<uint64_t>& range = m_deques[tid].m_range;
+  uint64_t r = range.load(std::memory_order_relaxed);
+  while (true) {
+    uint64_t begin = r & 0xFFFFFFFFULL;
+    uint64_t end = r >> 32;
+    if (begin >= end) {
+      return false;
+    }
+    if (range.compare_exchange_weak(r, packRange(begin + 1, end), std::memory_order_acq_rel)) {
+      chunkIdx = begin;
+      return true;
+    }
+  }
 }
 
-//! @brief  Worker thread that process workers
+//! @brief  Steal a chunk from the back of other deques
+bool
+pimUtils::threadPool::stealBack(unsigned tid, uint64_t& chunkIdx)
+{
+  unsigned numDeques = m_deques.size();
+  for (unsigned i = 1; i < numDeques; ++i) {
+    std::atomic<uint64_t>& range = m_deques[(tid + i) % numDeques].m_range;
+    uint64_t r = range.load(std::memory_order_relaxed);
+    while (true) {
+      uint64_t begin = r & 0xFFFFFFFFULL;
+      uint64_t end = r >> 32;
+      if (begin >= end) {
+        break;
+      }
+      if (range.compare_exchange_weak(r, packRange(begin, end - 1), std::memory_order_acq_rel)) {
+        chunkIdx = end - 1;
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+//! @brief  Process chunks of current job until all deques are empty
 void
-pimUtils::threadPool::workerThread()
+pimUtils::threadPool::runChunks(unsigned tid)
 {
+  uint64_t chunkIdx = 0;
+  uint64_t numDone = 0;
+  while (popFront(tid, chunkIdx) || stealBack(tid, chunkIdx)) {
+    uint64_t chunkBegin = m_idxBegin + chunkIdx * m_grainSize;
+    uint64_t chunkEnd = std::min(chunkBegin + m_grainSize, m_idxEnd);
+    (*m_func)(chunkBegin, chunkEnd);
+    ++numDone;
+  }
+  if (numDone > 0) {
+    m_chunksRemaining.fetch_sub(numDone, std::memory_order_acq_rel);
+  }
+}
+
+//! @brief  Worker thread that joins each job to process chunks
+void
+pimUtils::threadPool::workerThread(unsigned tid)
+{
+  uint64_t lastJobGen = 0;
   while (true) {
-    threadWorker* worker;
     {
       std::unique_lock<std::mutex> lock(m_mutex);
-      m_cond.wait(lock, [this] { return m_terminate || !m_workers.empty(); });
-      if (m_terminate && m_workers.empty()) {
+      m_cond.wait(lock, [this, lastJobGen] { return m_terminate || m_jobGen != lastJobGen; });
+      if (m_terminate) {
         return;
       }
-      worker = m_workers.front();
-      m_workers.pop();
-    }
-    worker->execute();
-    {
-      std::unique_lock<std::mutex> lock(m_mutex);
-      --m_workersRemaining;
+      lastJobGen = m_jobGen;
+      if (!m_isJobOpen) {
+        continue;
+      }
+      m_numActiveWorkers.fetch_add(1, std::memory_order_relaxed);
     }
-    m_cond.notify_all();
+    runChunks(tid);
+    m_numActiveWorkers.fetch_sub(1, std::memory_order_release);
   }
 }
 
@@ -6,12 +6,12 @@
 
 #include "libpimeval.h"
 #include <string>
-#include <queue>
 #include <vector>
 #include <thread>
 #include <atomic>
 #include <mutex>
 #include <condition_variable>
+#include <functional>
 #include <algorithm>
 #include <cctype>
 #include <locale>
@@ -19,6 +19,8 @@
 #include <type_traits>
 #include <cstring>
 #include <cstdint>
+#include <cstddef>
+#include <new>
 
 
 //! @enum   PimBitWidth
@@ -41,6 +43,24 @@ enum class PimDataLayout
   HYBRID,       // hybrid data layout
 };
 
+//! @enum   PimSimdIsa
+//! @brief  SIMD instruction set levels for runtime CPU dispatch of functional kernels
+enum class PimSimdIsa
+{
+  SCALAR = 0,  // portable scalar code
+  AVX2,        // x86 AVX2
+  AVX512,      // x86 AVX-512 F/BW/DQ/VL
+};
+
+//! @enum   PimHugePageMode
+//! @brief  Huge page backing of pooled host buffers of PIM object data
+enum class PimHugePageMode
+{
+  NONE = 0,  // regular pages
+  THP,       // transparent huge pages with madvise
+  HUGETLB,   // reserved huge pages with MAP_HUGETLB, fall back to regular pages
+};
+
 namespace pimUtils
 {
   std::string pimStatusEnumToStr(PimStatus status);
@@ -55,6 +75,11 @@ namespace pimUtils
   bool isFP(PimDataType dataType);
   std::string pimProtocolEnumToStr(PimDeviceProtocolEnum protocol);
   PimDataLayout getDeviceDataLayout(PimDeviceEnum deviceType);
+  PimSimdIsa detectSimdIsa();
+  std::string pimSimdIsaToStr(PimSimdIsa isa);
+  PimSimdIsa strToPimSimdIsa(const std::string& isaStr);
+  std::string pimHugePageModeToStr(PimHugePageMode mode);
+  PimHugePageMode strToPimHugePageMode(const std::string& modeStr);
 
   // Convert raw bits into sign-extended bits based on PIM data type.
   // Input: Raw bits represented as uint64_t
@@ -92,6 +117,19 @@ namespace pimUtils
     return signExtBits;
   }
 
+  // Transpose a 64x64 bit matrix in place, i.e., bit j of word i is swapped with bit i of word j.
+  // Use recursive block swapping with 6 passes of word-level operations.
+  inline void transposeBits64x64(uint64_t* block) {
+    uint64_t mask = 0x00000000FFFFFFFFULL;
+    for (unsigned j = 32; j != 0; j >>= 1, mask ^= (mask << j)) {
+      for (unsigned k = 0; k < 64; k = ((k | j) + 1) & ~j) {
+        uint64_t t = ((block[k] >> j) ^ block[k | j]) & mask;
+        block[k] ^= (t << j);
+        block[k | j] ^= t;
+      }
+    }
+  }
+
   // Service APIs for file system, config files, env vars
   std::string& ltrim(std::string& s);
   std::string& rtrim(std::string& s);
@@ -119,31 +157,68 @@ namespace pimUtils
       {"PIM_DEVICE_AQUABOLT", PIM_DEVICE_AQUABOLT}
   };
 
-  //! @class  threadWorker
-  //! @brief  Thread worker base class
-  class threadWorker {
+  //! @class  alignedAllocator
+  //! @brief  STL allocator that aligns storage to a given boundary, e.g., cache lines
+  template <typename T, std::size_t Alignment>
+  class alignedAllocator {
   public:
-    threadWorker() {}
-    virtual ~threadWorker() {}
-    virtual void execute() = 0;
+    using value_type = T;
+    template <typename U> struct rebind { using other = alignedAllocator<U, Alignment>; };
+    alignedAllocator() noexcept {}
+    template <typename U> alignedAllocator(const alignedAllocator<U, Alignment>&) noexcept {}
+    T* allocate(std::size_t n) { return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(Alignment))); }
+    void deallocate(T* p, std::size_t) noexcept { ::operator delete(p, std::align_val_t(Alignment)); }
+    template <typename U> bool operator==(const alignedAllocator<U, Alignment>&) const noexcept { return true; }
+    template <typename U> bool operator!=(const alignedAllocator<U, Alignment>&) const noexcept { return false; }
+  };
+
+  //! @struct cacheLinePadded
+  //! @brief  A value padded to a whole cache line, e.g., partial results written by different threads
+  template <typename T>
+  struct alignas(64) cacheLinePadded {
+    T m_val;
   };
 
   //! @class  threadPool
-  //! @brief  Thread pool that runs multiple workers in threads
+  //! @brief  Work-stealing thread pool that runs an index range in chunks of a grain size
+  //! - Chunks are split into contiguous blocks, one per-thread deque per participant, with the
+  //!   caller thread participating as well
+  //! - A participant pops chunks from the front of its own deque, then steals from the back of
+  //!   other deques. Each deque is a packed [begin, end) chunk range updated with CAS, so that no
+  //!   per-task allocation or lock is needed
+  //! - Sleeping threads are woken once per job. Completion is tracked with atomic counters
   class threadPool {
   public:
+    typedef std::function<void(uint64_t, uint64_t)> rangeFunc;
+
     threadPool(size_t numThreads);
     ~threadPool();
-    void doWork(const std::vector<pimUtils::threadWorker*>& workers);
+    void parallelFor(uint64_t idxBegin, uint64_t idxEnd, uint64_t grainSize, const rangeFunc& func);
   private:
-    void workerThread();
+    //! @brief  Per-thread chunk deque, padded to avoid false sharing
+    struct alignas(64) chunkDeque {
+      std::atomic<uint64_t> m_range{0};  // chunk index begin in low 32 bits, end in high 32 bits
+    };
+    static uint64_t packRange(uint64_t begin, uint64_t end) { return (end << 32) | begin; }
+    bool popFront(unsigned tid, uint64_t& chunkIdx);
+    bool stealBack(unsigned tid, uint64_t& chunkIdx);
+    void runChunks(unsigned tid);
+    void workerThread(unsigned tid);
 
     std::vector<std::thread> m_threads;
-    std::queue<threadWorker*> m_workers;
+    std::vector<chunkDeque> m_deques;
     std::mutex m_mutex;
     std::condition_variable m_cond;
     bool m_terminate;
-    std::atomic<size_t> m_workersRemaining;
+    // current job
+    uint64_t m_jobGen;
+    bool m_isJobOpen;
+    const rangeFunc* m_func;
+    uint64_t m_idxBegin;
+    uint64_t m_idxEnd;
+    uint64_t m_grainSize;
+    std::atomic<uint64_t> m_chunksRemaining;
+    std::atomic<unsigned> m_numActiveWorkers;
   };
 
 }
@@ -0,0 +1,164 @@
+// File: testFusedPerf.cpp
+// PIMeval Simulator - Test performance and energy of fused PIM APIs
+//
+// A fused sweep saves row re-activations and write-backs of its member APIs on aquabolt,
+// but never costs less than its costliest member:
+//   testFusedPerf <aquabolt-sim-config-file>
+
+#include "libpimeval.h"
+#include "pimSim.h"
+#include "pimStats.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <vector>
+
+//! @brief  Run PIM APIs and get total performance and energy of their PIM commands
+static bool
+runAndGetCost(const std::function<PimStatus()>& run, pimeval::perfEnergy& cost)
+{
+  pimResetStats();
+  if (run() != PIM_OK) {
+    return false;
+  }
+  cost = pimSim::get()->getStatsMgr()->getTotalCmdPerfEnergy();
+  return true;
+}
+
+//! @brief  Check if two values are equal within relative tolerance
+static bool
+isClose(double a, double b)
+{
+  return std::fabs(a - b) <= 1e-9 * std::max(std::fabs(a), std::fabs(b));
+}
+
+//! @brief  Check that a fused program costs at least as much as each member API run alone
+static bool
+testFusedNotLessThanMembers(const std::string& name, const std::vector<std::function<PimStatus()>>& apis)
+{
+  PimProg prog;
+  prog.m_apis = apis;
+  pimeval::perfEnergy fused;
+  if (!runAndGetCost([&]() { return pimFuse(prog); }, fused)) {
+    std::printf("FAIL: %s: cannot run fused program\n", name.c_str());
+    return false;
+  }
+  bool ok = true;
+  for (size_t i = 0; i < apis.size(); ++i) {
+    pimeval::perfEnergy member;
+    if (!runAndGetCost(apis[i], member)) {
+      std::printf("FAIL: %s: cannot run member %zu\n", name.c_str(), i);
+      return false;
+    }
+    if (fused.m_msRuntime < member.m_msRuntime || fused.m_mjEnergy < member.m_mjEnergy) {
+      std::printf("FAIL: %s: fused %f ms %f mJ is less than member %zu %f ms %f mJ\n", name.c_str(),
+                  fused.m_msRuntime, fused.m_mjEnergy, i, member.m_msRuntime, member.m_mjEnergy);
+      ok = false;
+    }
+  }
+  if (ok) {
+    std::printf("PASS: %s: fused %f ms %f mJ\n", name.c_str(), fused.m_msRuntime, fused.m_mjEnergy);
+  }
+  return ok;
+}
+
+//! @brief  Check exact credits of fusing c = a * b and c = c * b on aquabolt
+//! A standalone mul reads two vectors and writes one, i.e., msRead = 2 * rowAccess + gdl and
+//! msWrite = rowAccess + gdl. In the fused sweep, the second mul finds b and c in GRF, saving two
+//! row accesses, and the first mul skips its write-back of c, saving msWrite. Background power of
+//! all chips is saved for the saved time.
+static bool
+testFusedMulCredits(PimObjId a, PimObjId b, PimObjId c)
+{
+  const std::string name = "mul+mul credits";
+  pimeval::perfEnergy mul;
+  pimeval::perfEnergy fused;
+  PimProg prog;
+  prog.add(pimMul, a, b, c);
+  prog.add(pimMul, c, b, c);
+  if (!runAndGetCost([&]() { return pimMul(a, b, c); }, mul) ||
+      !runAndGetCost([&]() { return pimFuse(prog); }, fused)) {
+    std::printf("FAIL: %s: cannot run APIs\n", name.c_str());
+    return false;
+  }
+
+  pimSim* sim = pimSim::get();
+  const pimParamsDram& params = sim->getParamsDram();
+  double tActPre = (params.getNsRowActivate() + params.getNsRowPrecharge()) / 1e6;  // ms
+  double tGDL = params.getNsTCCD_L() / 1e6;
+  double eActPre = (params.getPjActivate() + params.getPjPrecharge()) / 1e9;  // mJ
+  double eW = params.getPjWrite() / 1e9;
+  double pBackground = params.getMwIDD3N() / 1000.0 * params.getNumChipsPerRank() * sim->getNumRanks();
+  unsigned numCores = sim->getNumCores();
+  unsigned numBankPerChip = numCores / params.getNumChipsPerRank();
+
+  double msRowAccess = mul.m_msRead - mul.m_msWrite;
+  double msWriteBack = mul.m_msWrite;
+  double numActPre = msRowAccess / tActPre;
+  double numGDLItr = (msWriteBack - msRowAccess) / tGDL;
+  double mjRowAccess = eActPre * numActPre * numCores;
+  double mjWriteBack = mjRowAccess + eW * numGDLItr * numBankPerChip * sim->getNumRanks();
+  double msSaved = 2 * msRowAccess + msWriteBack;
+  double mjSaved = 2 * mjRowAccess + mjWriteBack + pBackground * msSaved;
+
+  double msExpected = 2 * mul.m_msRuntime - msSaved;
+  double mjExpected = 2 * mul.m_mjEnergy - mjSaved;
+  if (msSaved <= 0.0 || !isClose(fused.m_msRuntime, msExpected) || !isClose(fused.m_mjEnergy, mjExpected)) {
+    std::printf("FAIL: %s: fused %.9f ms %.9f mJ, expecting %.9f ms %.9f mJ\n", name.c_str(),
+                fused.m_msRuntime, fused.m_mjEnergy, msExpected, mjExpected);
+    return false;
+  }
+  std::printf("PASS: %s: fused %f ms %f mJ, saved %f ms %f mJ\n", name.c_str(),
+              fused.m_msRuntime, fused.m_mjEnergy, msSaved, mjSaved);
+  return true;
+}
+
+int
+main(int argc, char* argv[])
+{
+  if (argc != 2) {
+    std::fprintf(stderr, "Usage: testFusedPerf <aquabolt-sim-config-file>\n");
+    return 1;
+  }
+  if (pimCreateDeviceFromConfig(PIM_DEVICE_AQUABOLT, argv[1]) != PIM_OK) {
+    return 1;
+  }
+  const uint64_t numElements = 1 << 20;
+  PimObjId a = pimAlloc(PIM_ALLOC_AUTO, numElements, PIM_INT32);
+  PimObjId b = pimAllocAssociated(a, PIM_INT32);
+  PimObjId c = pimAllocAssociated(a, PIM_INT32);
+  PimObjId d = pimAllocAssociated(a, PIM_INT32);
+  PimObjId m = pimAllocAssociated(a, PIM_BOOL);
+  if (a == -1 || b == -1 || c == -1 || d == -1 || m == -1) {
+    return 1;
+  }
+
+  bool ok = true;
+  ok &= testFusedMulCredits(a, b, c);
+  // all members modeled by aquabolt
+  ok &= testFusedNotLessThanMembers("mul+mul", {
+    [=]() { return pimMul(a, b, c); },
+    [=]() { return pimMul(c, b, c); },
+  });
+  ok &= testFusedNotLessThanMembers("scaled_add+mul", {
+    [=]() { return pimScaledAdd(a, b, c, 3); },
+    [=]() { return pimMul(c, a, d); },
+  });
+  // members not modeled by aquabolt
+  ok &= testFusedNotLessThanMembers("scaled_add+gt+cond_select", {
+    [=]() { return pimScaledAdd(a, b, c, 3); },
+    [=]() { return pimGT(c, b, m); },
+    [=]() { return pimCondSelect(m, c, a, c); },
+  });
+
+  pimFree(a);
+  pimFree(b);
+  pimFree(c);
+  pimFree(d);
+  pimFree(m);
+  pimDeleteDevice();
+  std::printf("%s\n", ok ? "All tests passed" : "Some tests failed");
+  return ok ? 0 : 1;
+}
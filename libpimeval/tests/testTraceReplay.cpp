@@ -0,0 +1,105 @@
+// File: testTraceReplay.cpp
+// PIMeval Simulator - Test API trace record and replay round trip with fused programs
+//
+// A child process records a trace of fused programs that allocate, compute, reduce, copy and free,
+// run synchronously and on a stream. The trace is then replayed, expecting every record to replay:
+//   testTraceReplay <sim-config-file>
+
+#include "libpimeval.h"
+#include "pimTrace.h"
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// Number of records expected in the trace of recordWorkload
+static const uint64_t s_numRecords = 25;
+
+//! @brief  Run fused programs with API trace recording on. Return process exit code
+static int
+recordWorkload(const char* configFile, const std::string& traceFile)
+{
+  setenv("PIMEVAL_TRACE_FILE", traceFile.c_str(), 1);
+  if (pimCreateDeviceFromConfig(PIM_DEVICE_AQUABOLT, configFile) != PIM_OK) {   // CREATE_DEVICE
+    return 1;
+  }
+  const uint64_t numElements = 4096;
+  std::vector<int> hostA(numElements, 2);
+  std::vector<int> hostB(numElements, 3);
+  std::vector<int> hostC(numElements);
+  PimObjId a = pimAlloc(PIM_ALLOC_AUTO, numElements, PIM_INT32);                 // ALLOC
+  PimObjId b = pimAllocAssociated(a, PIM_INT32);                                  // ALLOC_ASSOCIATED
+  bool ok = a != -1 && b != -1;
+  ok = ok && pimCopyHostToDevice(hostA.data(), a) == PIM_OK;                      // CMD
+  ok = ok && pimCopyHostToDevice(hostB.data(), b) == PIM_OK;                      // CMD
+
+  // each API of a fused program runs and is recorded once
+  PimObjId t = -1;
+  int64_t sum = 0;
+  PimProg prog;
+  prog.m_apis = {
+    [&]() { t = pimAllocAssociated(a, PIM_INT32); return t == -1 ? PIM_ERROR : PIM_OK; },  // ALLOC_ASSOCIATED
+    [&]() { return pimMul(a, b, t); },                                            // CMD
+    [&]() { return pimMul(t, b, t); },                                            // CMD
+    [&]() { return pimRedSum(t, static_cast<void*>(&sum)); },                     // CMD
+    [&]() { return pimCopyDeviceToHost(t, hostC.data()); },                       // CMD
+    [&]() { return pimFree(t); },                                                 // FREE
+  };
+  ok = ok && pimFuse(prog) == PIM_OK;                                             // FUSE_BEGIN, FUSE_END
+  ok = ok && sum == static_cast<int64_t>(2 * 3 * 3 * numElements) && hostC[0] == 2 * 3 * 3;
+
+  // records of a fused program on a stream are kept at the position of its pimFuse call
+  PimStreamId stream = pimStreamCreate();                                         // STREAM_CREATE
+  ok = ok && stream != -1 && pimSetStream(stream) == PIM_OK;                      // SET_STREAM
+  PimProg streamProg;
+  streamProg.add(pimMul, a, b, a);                                                // CMD
+  streamProg.add(pimMul, a, b, a);                                                // CMD
+  ok = ok && pimFuse(streamProg) == PIM_OK;                                       // FUSE_BEGIN, FUSE_END
+  ok = ok && pimSetStream(-1) == PIM_OK;                                          // SET_STREAM
+  ok = ok && pimFree(a) == PIM_OK;                                                // FREE
+  ok = ok && pimStreamSync(stream) == PIM_OK;                                     // STREAM_SYNC
+  ok = ok && pimStreamDestroy(stream) == PIM_OK;                                  // STREAM_DESTROY
+  ok = ok && pimFree(b) == PIM_OK;                                                // FREE
+  pimDeleteDevice();                                                              // DELETE_DEVICE
+  return ok ? 0 : 1;
+}
+
+int
+main(int argc, char* argv[])
+{
+  if (argc != 2) {
+    std::fprintf(stderr, "Usage: testTraceReplay <sim-config-file>\n");
+    return 1;
+  }
+  std::string traceFile = "testTraceReplay." + std::to_string(getpid()) + ".trace";
+
+  // record in a child process, as the trace writer lives as long as the simulator
+  std::fflush(stdout);
+  pid_t pid = fork();
+  if (pid == 0) {
+    std::exit(recordWorkload(argv[1], traceFile));
+  }
+  int status = 0;
+  bool ok = pid > 0 && waitpid(pid, &status, 0) == pid && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+  if (!ok) {
+    std::printf("FAIL: cannot record trace\n");
+  }
+
+  if (ok) {
+    pimTraceReplayer replayer(traceFile, argv[1]);
+    ok = replayer.replay();
+    if (!ok || replayer.getNumRecords() != s_numRecords || replayer.getNumFailedRecords() != 0) {
+      std::printf("FAIL: replayed %llu records with %llu failed, expecting %llu records\n",
+                  (unsigned long long)replayer.getNumRecords(),
+                  (unsigned long long)replayer.getNumFailedRecords(), (unsigned long long)s_numRecords);
+      ok = false;
+    } else {
+      std::printf("PASS: replayed %llu records of fused programs\n", (unsigned long long)s_numRecords);
+    }
+  }
+  std::remove(traceFile.c_str());
+  std::printf("%s\n", ok ? "All tests passed" : "Some tests failed");
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,64 @@
+// File: pimreplay.cpp
+// PIMeval Simulator - Replay a binary API trace in analysis mode
+//
+// Record a trace by running a PIM application with PIMEVAL_TRACE_FILE=<trace-file>,
+// then evaluate it against any simulator config without rerunning the application:
+//   pimreplay -c <sim-config-file> <trace-file>
+
+#include "pimTrace.h"
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <string>
+#include <unistd.h>
+
+//! @brief  Show usage
+static void
+usage()
+{
+  std::fprintf(stderr,
+      "Usage: pimreplay [-c <sim-config-file>] [-f] <trace-file>\n"
+      "  -c  PIMeval simulator config file. Default: from environment variables\n"
+      "  -f  Run functional simulation instead of analysis mode\n");
+}
+
+int
+main(int argc, char* argv[])
+{
+  std::string configFile;
+  bool isFunctional = false;
+  int opt;
+  while ((opt = getopt(argc, argv, "c:fh")) != -1) {
+    switch (opt) {
+      case 'c': configFile = optarg; break;
+      case 'f': isFunctional = true; break;
+      default: usage(); return 1;
+    }
+  }
+  if (optind != argc - 1) {
+    usage();
+    return 1;
+  }
+  std::string traceFile = argv[optind];
+
+  // Host data is not recorded in the trace, so functional results are meaningless by default
+  if (!isFunctional) {
+    setenv("PIMEVAL_ANALYSIS_MODE", "1", 1);
+  }
+  // Do not record the replay itself
+  unsetenv("PIMEVAL_TRACE_FILE");
+
+  pimTraceReplayer replayer(traceFile, configFile);
+  bool ok = false;
+  try {
+    ok = replayer.replay();
+  } catch (const std::exception& e) {
+    // e.g., simulator configs from environment variables do not fit the device type of the trace
+    std::printf("PIM-Error: Aborted replaying trace file %s: %s\n", traceFile.c_str(), e.what());
+    return 1;
+  }
+  std::printf("PIM-Info: Replayed %llu trace records from %s, %llu failed\n",
+              (unsigned long long)replayer.getNumRecords(), traceFile.c_str(),
+              (unsigned long long)replayer.getNumFailedRecords());
+  return ok ? 0 : 1;
+}